@@ -2,6 +2,7 @@
 
 #include "Oscillator.h"
 #include "ADSREnvelope.h"
+#include "EventSplitter.h"
 #include <vector>
 
 static constexpr int kNumDrums = 4;
@@ -52,7 +53,6 @@ public:
   };
   
   DrumSynthDSP()
-//  : mMidiQueue(IMidiMsg::QueueSize(DEFAULT_BLOCK_SIZE, DEFAULT_SAMPLE_RATE))
   {
     for(int d=0;d<kNumDrums;d++)
     {
@@ -62,64 +62,28 @@ public:
   
   void Reset(double sampleRate, int blockSize)
   {
-    mMidiQueue.Resize(blockSize);
-//    mMidiQueue.Resize(IMidiMsg::QueueSize(blockSize, sampleRate));
+    mEventSplitter.Resize(blockSize, 0, kNumDrums * 2);
   }
   
   void ProcessBlock(sample** outputs, int nFrames)
   {
-    for(int s=0;s<nFrames;s++)
-    {
-      while (!mMidiQueue.Empty())
-      {
-        IMidiMsg& msg = mMidiQueue.Peek();
-        if (msg.mOffset > s) break;
-        
-        if(msg.StatusMsg() == IMidiMsg::kNoteOn && msg.Velocity())
-        {
-          int pitchClass = msg.NoteNumber() % 12;
-          
-          if(pitchClass < kNumDrums)
-          mDrums[pitchClass].Trigger(msg.Velocity() / 127.f);
-        }
-        
-        mMidiQueue.Remove();
-      }
-
-      if(mMultiOut)
-      {
-        int channel=0;
-        for(int d=0;d<kNumDrums;d++)
-        {
-          outputs[channel][s] = 0.;
-
-          if(mDrums[d].IsActive())
-            outputs[channel][s] = mDrums[d].Process();
-          
-          outputs[channel + 1][s] = outputs[channel][s];
+    // the drums are processed in spans between the notes, rather than checking for notes every sample
+    mEventSplitter.ProcessBlock(nullptr, outputs, nFrames,
+                                [&](sample**, sample** subOutputs, int subFrames) { ProcessDrums(subOutputs, subFrames); },
+                                [&](const IMidiMsg& msg) {
+                                  if(msg.StatusMsg() == IMidiMsg::kNoteOn && msg.Velocity())
+                                  {
+                                    int pitchClass = msg.NoteNumber() % 12;
 
-          channel += 2;
-        }
-      }
-      else
-      {
-        outputs[0][s] = 0.;
-        
-        for(int d=0;d<kNumDrums;d++)
-        {
-          if(mDrums[d].IsActive())
-            outputs[0][s] += mDrums[d].Process();
-        }
-        
-        outputs[1][s] = outputs[0][s];
-      }
-    }
-    mMidiQueue.Flush(nFrames);
+                                    if(pitchClass < kNumDrums)
+                                      mDrums[pitchClass].Trigger(msg.Velocity() / 127.f);
+                                  }
+                                });
   }
   
   void ProcessMidiMsg(const IMidiMsg& msg)
   {
-    mMidiQueue.Add(msg);
+    mEventSplitter.AddMidiMsg(msg);
   }
   
   void SetMultiOut(bool multiOut)
@@ -128,8 +92,39 @@ public:
   }
   
 private:
+  void ProcessDrums(sample** outputs, int nFrames)
+  {
+    if(mMultiOut)
+    {
+      for(int d=0;d<kNumDrums;d++)
+      {
+        sample* pOutput = outputs[d * 2];
+
+        for(int s=0;s<nFrames;s++)
+          pOutput[s] = mDrums[d].IsActive() ? mDrums[d].Process() : 0.;
+
+        memcpy(outputs[(d * 2) + 1], pOutput, nFrames * sizeof(sample));
+      }
+    }
+    else
+    {
+      memset(outputs[0], 0, nFrames * sizeof(sample));
+
+      for(int d=0;d<kNumDrums;d++)
+      {
+        for(int s=0;s<nFrames;s++)
+        {
+          if(mDrums[d].IsActive())
+            outputs[0][s] += mDrums[d].Process();
+        }
+      }
+
+      memcpy(outputs[1], outputs[0], nFrames * sizeof(sample));
+    }
+  }
+
   bool mMultiOut = false;
   std::vector<DrumVoice> mDrums;
-  IMidiQueue mMidiQueue;
+  EventSplitter<sample> mEventSplitter {DEFAULT_BLOCK_SIZE, 0, kNumDrums * 2};
 };
 
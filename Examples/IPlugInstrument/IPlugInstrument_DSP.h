@@ -1,6 +1,6 @@
 #pragma once
 
-#include "MidiSynth.h"
+#include "TypedMidiSynth.h"
 #include "Oscillator.h"
 #include "ADSREnvelope.h"
 #include "Smoothers.h"
@@ -21,7 +21,7 @@ class IPlugInstrumentDSP
 {
 public:
 #pragma mark - Voice
-  class Voice : public SynthVoice
+  class Voice final : public SynthVoice
   {
   public:
     Voice()
@@ -115,13 +115,8 @@ public:
 public:
 #pragma mark -
   IPlugInstrumentDSP(int nVoices)
+  : mSynth(nVoices, VoiceAllocator::kPolyModePoly, MidiSynth::kDefaultBlockSize) // creates nVoices voices in Zone 0.
   {
-    for (auto i = 0; i < nVoices; i++)
-    {
-      // add a voice to Zone 0.
-      mSynth.AddVoice(new Voice(), 0);
-    }
-
     // some MidiSynth API examples:
     // mSynth.SetKeyToPitchFn([](int k){return (k - 69.)/24.;}); // quarter-tone scale
     // mSynth.SetNoteGlideTime(0.5); // portamento
@@ -135,15 +130,28 @@ public:
       memset(outputs[i], 0, nFrames * sizeof(T));
     }
     
-    mParamSmoother.ProcessBlock(mParamsToSmooth, mModulations.GetList(), nFrames);
+    mParamSmoother.ProcessBlock(mModulations.GetList(), nFrames);
     mLFO.ProcessBlock(mModulations.GetList()[kModLFO], nFrames, qnPos, transportIsRunning, tempo);
     mSynth.ProcessBlock(mModulations.GetList(), outputs, 0, nOutputs, nFrames);
     
-    for(int s=0; s < nFrames;s++)
+    if (mParamSmoother.IsSmoothing(kModGainSmoother))
+    {
+      for(int s=0; s < nFrames;s++)
+      {
+        T smoothedGain = mModulations.GetList()[kModGainSmoother][s];
+        outputs[0][s] *= smoothedGain;
+        outputs[1][s] *= smoothedGain;
+      }
+    }
+    else
     {
-      T smoothedGain = mModulations.GetList()[kModGainSmoother][s];
-      outputs[0][s] *= smoothedGain;
-      outputs[1][s] *= smoothedGain;
+      const T gain = mParamSmoother.GetValue(kModGainSmoother);
+
+      for(int s=0; s < nFrames;s++)
+      {
+        outputs[0][s] *= gain;
+        outputs[1][s] *= gain;
+      }
     }
   }
 
@@ -152,6 +160,7 @@ public:
     mSynth.SetSampleRateAndBlockSize(sampleRate, blockSize);
     mSynth.Reset();
     mLFO.SetSampleRate(sampleRate);
+    mParamSmoother.SetSampleRate(sampleRate);
     mModulationsData.Resize(blockSize * kNumModulations);
     mModulations.Empty();
     
@@ -175,18 +184,18 @@ public:
         mSynth.SetNoteGlideTime(value / 1000.);
         break;
       case kParamGain:
-        mParamsToSmooth[kModGainSmoother] = (T) value / 100.;
+        mParamSmoother.SetTarget(kModGainSmoother, (T) value / 100.);
         break;
       case kParamSustain:
-        mParamsToSmooth[kModSustainSmoother] = (T) value / 100.;
+        mParamSmoother.SetTarget(kModSustainSmoother, (T) value / 100.);
         break;
       case kParamAttack:
       case kParamDecay:
       case kParamRelease:
       {
         EEnvStage stage = static_cast<EEnvStage>(EEnvStage::kAttack + (paramIdx - kParamAttack));
-        mSynth.ForEachVoice([stage, value](SynthVoice& voice) {
-          dynamic_cast<IPlugInstrumentDSP::Voice&>(voice).mAMPEnv.SetStageTime(stage, value);
+        mSynth.ForEachTypedVoice([stage, value](Voice& voice) {
+          voice.mAMPEnv.SetStageTime(stage, value);
         });
         break;
       }
@@ -211,10 +220,9 @@ public:
   }
   
 public:
-  MidiSynth mSynth { VoiceAllocator::kPolyModePoly, MidiSynth::kDefaultBlockSize };
+  TypedMidiSynth<Voice> mSynth;
   WDL_TypedBuf<T> mModulationsData; // Sample data for global modulations (e.g. smoothed sustain)
   WDL_PtrList<T> mModulations; // Ptrlist for global modulations
-  LogParamSmooth<T, kNumModulations> mParamSmoother;
-  sample mParamsToSmooth[kNumModulations];
+  SmootherBank<T> mParamSmoother {kModLFO}; // smooths the modulations before kModLFO
   LFO<T> mLFO;
 };
@@ -1,5 +1,69 @@
 // FROM DELEGATE
 
+// the delegate sends the messages from each idle tick as one base64 encoded batch, which is decoded here and dispatched to the functions below.
+// the batch is a version byte followed by records of a type byte and little-endian fields, see IPlugWebViewBridge.h
+function IPlugBridge(payload) {
+  var str = window.atob(payload);
+  var bytes = new Uint8Array(str.length);
+
+  for (var i = 0; i < str.length; i++)
+    bytes[i] = str.charCodeAt(i);
+
+  var view = new DataView(bytes.buffer);
+
+  if (bytes.length < 1 || view.getUint8(0) != 1) {
+    console.log("IPlugBridge: unknown version");
+    return;
+  }
+
+  var pos = 1;
+
+  // a record that runs past the end means the payload was cut short, so stop rather than read outside it
+  function fits(size) {
+    if (size >= 0 && pos + size <= bytes.length)
+      return true;
+
+    console.log("IPlugBridge: truncated record");
+    return false;
+  }
+
+  while (pos < bytes.length) {
+    var type = view.getUint8(pos++);
+
+    switch (type) {
+      case 1: // param value
+        if (!fits(12)) return;
+        SPVFD(view.getInt32(pos, true), view.getFloat64(pos + 4, true));
+        pos += 12;
+        break;
+      case 2: // control value
+        if (!fits(8)) return;
+        SCVFD(view.getInt32(pos, true), view.getFloat32(pos + 4, true));
+        pos += 8;
+        break;
+      case 3: { // control message
+        if (!fits(12)) return;
+        var dataSize = view.getInt32(pos + 8, true);
+        if (!fits(12 + dataSize)) return;
+        SCMFD(view.getInt32(pos, true), view.getInt32(pos + 4, true), dataSize, new DataView(bytes.buffer, pos + 12, dataSize));
+        pos += 12 + dataSize;
+        break;
+      }
+      case 4: { // arbitrary message
+        if (!fits(8)) return;
+        var dataSize = view.getInt32(pos + 4, true);
+        if (!fits(8 + dataSize)) return;
+        SAMFD(view.getInt32(pos, true), dataSize, new DataView(bytes.buffer, pos + 8, dataSize));
+        pos += 8 + dataSize;
+        break;
+      }
+      default:
+        console.log("IPlugBridge: unknown record type " + type);
+        return;
+    }
+  }
+}
+
 function SPVFD(paramIdx, val) {
 //  console.log("paramIdx: " + paramIdx + " value:" + val);
   OnParamChange(paramIdx, val);
@@ -10,14 +74,14 @@ function SCVFD(ctrlTag, val) {
 //  console.log("SCVFD ctrlTag: " + ctrlTag + " value:" + val);
 }
 
+// msg is a DataView of the message's data
 function SCMFD(ctrlTag, msgTag, dataSize, msg) {
-//  var decodedData = window.atob(msg);
-  console.log("SCMFD ctrlTag: " + ctrlTag + " msgTag:" + msgTag + "msg:" + msg);
+  console.log("SCMFD ctrlTag: " + ctrlTag + " msgTag:" + msgTag + " dataSize:" + dataSize);
 }
 
+// msg is a DataView of the message's data
 function SAMFD(msgTag, dataSize, msg) {
-  //  var decodedData = window.atob(msg);
-  console.log("SAMFD msgTag:" + msgTag + " msg:" + msg);
+  console.log("SAMFD msgTag:" + msgTag + " dataSize:" + dataSize);
 }
 
 function SMMFD(statusByte, dataByte1, dataByte2) {
@@ -29,6 +93,7 @@ function SSMFD(offset, size, msg) {
 }
 
 // FROM UI
+// data is base64 encoded, e.g. with window.btoa()
 function SAMFUI(msgTag, ctrlTag = -1, dataSize = 0, data = 0) {
   var message = {
     "msg": "SAMFUI",
@@ -52,6 +117,7 @@ function SMMFUI(statusByte, dataByte1, dataByte2) {
   IPlugSendMsg(message);
 }
 
+// data is base64 encoded, e.g. with window.btoa()
 function SSMFUI(dataSize = 0, data = 0) {
   var message = {
     "msg": "SSMFUI",
@@ -0,0 +1,102 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+#pragma once
+
+/**
+ * @file
+ * @ingroup SpecialControls
+ * @copydoc IDSPLoadControl
+ */
+
+#include "IControl.h"
+#include "IPlugDSPLoadMeter.h"
+
+BEGIN_IPLUG_NAMESPACE
+BEGIN_IGRAPHICS_NAMESPACE
+
+/** Displays the statistics and histogram of a DSPLoadMeter, e.g. the plug-in's IPlugProcessor::GetDSPLoadMeter(), which needs IPlugProcessor::SetDSPLoadMetering(true). Click to reset the statistics.
+ * The meter is read directly, so this only works when the UI and the processor are in the same process (not in distributed VST3 or web builds)
+ * @ingroup SpecialControls */
+class IDSPLoadControl : public IControl
+                      , public IVectorBase
+{
+public:
+  IDSPLoadControl(const IRECT& bounds, const DSPLoadMeter& meter, const char* label = "DSP Load", const IVStyle& style = DEFAULT_STYLE)
+  : IControl(bounds)
+  , IVectorBase(style)
+  , mMeter(meter)
+  {
+    AttachIControl(this, label);
+    mIgnoreMouse = false;
+  }
+
+  void OnMouseDown(float x, float y, const IMouseMod& mod) override
+  {
+    mMeter.Reset();
+  }
+
+  bool IsDirty() override
+  {
+    // only redraw when the audio thread has measured some more blocks
+    return mMeter.GetStats().mNBlocks != mStats.mNBlocks || IControl::IsDirty();
+  }
+
+  void Draw(IGraphics& g) override
+  {
+    mStats = mMeter.GetStats();
+    const int64_t total = mMeter.GetHistogram(mCounts);
+
+    g.FillRect(GetColor(kBG), mRECT);
+
+    const IRECT textRect = mRECT.GetPadded(-2.f).FracRectVertical(0.3f, true);
+    const IRECT histRect = mRECT.GetPadded(-2.f).FracRectVertical(0.7f);
+
+    if (total > 0)
+    {
+      // bins to 100% on the left, overruns on the right, with heights scaled to the most common load
+      uint32_t maxCount = 1;
+
+      for (auto i = 0; i < DSPLoadMeter::kNumBins; i++)
+        maxCount = std::max(maxCount, mCounts[i]);
+
+      const float binWidth = histRect.W() / DSPLoadMeter::kNumBins;
+
+      for (auto i = 0; i < DSPLoadMeter::kNumBins; i++)
+      {
+        if (mCounts[i] == 0)
+          continue;
+
+        const float h = histRect.H() * static_cast<float>(mCounts[i]) / maxCount;
+        const IRECT bar(histRect.L + i * binWidth, histRect.B - h, histRect.L + (i + 1) * binWidth, histRect.B);
+        g.FillRect(i * DSPLoadMeter::kBinWidth >= 1. ? COLOR_RED : GetColor(kFG), bar);
+      }
+    }
+
+    const float deadlineX = histRect.L + histRect.W() * static_cast<float>(1. / (DSPLoadMeter::kNumBins * DSPLoadMeter::kBinWidth));
+    g.DrawVerticalLine(GetColor(kFR), deadlineX, histRect.T, histRect.B);
+
+    WDL_String str;
+    str.SetFormatted(128, "%s  mean %.1f%%  p99 %.0f%%  max %.1f%%  overruns %lld", mLabelStr.Get(),
+                     mStats.mMean * 100., mStats.mP99 * 100., mStats.mMax * 100., static_cast<long long>(mStats.mNOverruns));
+    g.DrawText(mStyle.labelText, str.Get(), textRect);
+
+    if (mStyle.drawFrame)
+      g.DrawRect(GetColor(kFR), mRECT, nullptr, mStyle.frameThickness);
+  }
+
+private:
+  const DSPLoadMeter& mMeter;
+  DSPLoadStats mStats;
+  uint32_t mCounts[DSPLoadMeter::kNumBins] = {};
+};
+
+END_IGRAPHICS_NAMESPACE
+END_IPLUG_NAMESPACE
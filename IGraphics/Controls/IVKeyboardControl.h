@@ -108,7 +108,7 @@ public:
       TriggerMidiMsgFromKeyPress(mLastTouchedKey, (int) (mLastVelocity * 127.f));
     }
 
-    SetDirty(true);
+    SetKeyDirty(mLastTouchedKey, true);
   }
 
   void OnMouseUp(float x, float y, const IMouseMod& mod) override
@@ -121,8 +121,6 @@ public:
       mLastTouchedKey = -1;
       mMouseOverKey = -1;
       mLastVelocity = 0.;
-
-      SetDirty(false);
     }
   }
 
@@ -156,8 +154,7 @@ public:
       SetKeyIsPressed(prevKey, false);
     }
 
-    SetDirty(true);
-
+    SetKeyDirty(mLastTouchedKey, true);
   }
 
   void OnMouseOver(float x, float y, const IMouseMod& mod) override
@@ -201,8 +198,6 @@ public:
         break;
       default: break;
     }
-
-    SetDirty(false);
   }
 
   void DrawKey(IGraphics& g, const IRECT& bounds, const IColor& color)
@@ -375,13 +370,34 @@ public:
   void SetKeyIsPressed(int key, bool pressed)
   {
     mPressedKeys.Get()[key] = pressed;
-    SetDirty(false);
+    SetKeyDirty(key);
   }
   
   void SetKeyHighlight(int key)
   {
+    SetKeyDirty(mHighlight);
     mHighlight = key;
-    SetDirty(false);
+    SetKeyDirty(key);
+  }
+
+  /** Mark one key dirty, so that only it and its neighbours (which its shadow or a black key may overlap) are redrawn.
+   * The whole keyboard is marked dirty if the key is out of range, or if the note and velocity are shown, as they are drawn over the keys
+   * @param key The key index, from 0 at the lowest note
+   * @param triggerAction As for SetDirty() */
+  void SetKeyDirty(int key, bool triggerAction = false)
+  {
+    if (key < 0 || key >= NKeys() || mShowNoteAndVel)
+    {
+      SetDirty(triggerAction);
+      return;
+    }
+
+    const float kL = *GetKeyXPos(key);
+    IRECT bounds(kL - mWKWidth, mRECT.T, kL + 2.f * mWKWidth, mRECT.B);
+#ifdef _DEBUG
+    bounds = bounds.Union(IRECT(mRECT.L + 20, mRECT.B - 20, mRECT.L + 160, mRECT.B)); // the debug text in Draw()
+#endif
+    SetDirtyRECT(bounds.GetPadded(mFrameThickness), triggerAction);
   }
 
   void ClearNotesFromMidi()
@@ -85,6 +85,7 @@ public:
   {
     bounds.Constrain(x, y);
     int nVals = NVals();
+    const int prevMouseOverTrack = mMouseOverTrack;
 
     double value = 0.;
     int sliderTest = -1;
@@ -144,11 +145,23 @@ public:
     if(!GetStepped())
        value = std::round(value / mGrain) * mGrain;
     
+    // the sliders that changed, and the one that had the mouse over it
+    int loDirty = kNoValIdx;
+    int hiDirty = kNoValIdx;
+
     if (sliderTest > -1)
     {
       SetValue(Clip(value, 0., 1.), sliderTest);
       OnNewValue(sliderTest, GetValue(sliderTest));
 
+      loDirty = hiDirty = sliderTest;
+
+      if (prevMouseOverTrack > -1)
+      {
+        loDirty = std::min(loDirty, prevMouseOverTrack);
+        hiDirty = std::max(hiDirty, prevMouseOverTrack);
+      }
+
       mSliderHit = sliderTest;
       mMouseOverTrack = mSliderHit;
       
@@ -175,6 +188,9 @@ public:
             SetValue(iplug::Lerp(GetValue(lowBounds), GetValue(highBounds), frac), i);
             OnNewValue(i, GetValue(i));
           }
+
+          loDirty = std::min(loDirty, lowBounds);
+          hiDirty = std::max(hiDirty, highBounds);
         }
       }
       mPrevSliderHit = mSliderHit;
@@ -184,7 +200,7 @@ public:
       mSliderHit = -1;
     }
 
-    SetDirty(true); // will send all param vals to delegate
+    SetTracksDirty(loDirty, hiDirty, true); // will send all param vals to delegate
   }
 
   void OnMouseDown(float x, float y, const IMouseMod& mod) override
@@ -207,7 +223,7 @@ public:
           {
             SetValue(0., ch);
             OnNewValue(ch, 0.);
-            SetDirty(true);
+            SetTracksDirty(ch, ch, true);
             return;
           }
         }
@@ -225,6 +241,33 @@ public:
     SnapToMouse(x, y, mDirection, mWidgetBounds);
   }
 
+  void OnMouseOver(float x, float y, const IMouseMod& mod) override
+  {
+    const int prevMouseOverTrack = mMouseOverTrack;
+    mMouseOverTrack = GetValIdxForPos(x, y);
+
+    if (mMouseOverTrack != prevMouseOverTrack)
+      SetTracksDirty(prevMouseOverTrack, mMouseOverTrack, false);
+  }
+
+  void OnMouseOut() override
+  {
+    if (mMouseOverTrack > -1)
+      SetTracksDirty(mMouseOverTrack, mMouseOverTrack, false);
+
+    mMouseOverTrack = -1;
+  }
+
+  void SetValueFromDelegate(double value, int valIdx) override
+  {
+    // only redraw the slider that changed, e.g. when a host plays back automation of one parameter
+    if (!GetUI()->ControlIsCaptured(this) && GetValue(valIdx) != value)
+    {
+      SetValue(value, valIdx);
+      SetTracksDirty(valIdx, valIdx, false);
+    }
+  }
+
   void OnMsgFromDelegate(int msgTag, int dataSize, const void* pData) override
   {
     if (!IsDisabled() && msgTag == kMsgTagSetHighlight && dataSize == sizeof(int))
@@ -61,14 +61,24 @@ public:
 
     float xPerData = r.W() / (float) MAXBUF;
 
+    // skip the segments outside the region being drawn, when only part of the trace has changed
+    int first = 0;
+    int last = MAXBUF - 1;
+
+    while (first < last && g.IsClippedOut(IRECT(r.L + first * xPerData, r.T, r.L + (first + 1) * xPerData, r.B), mTrackSize))
+      first++;
+
+    while (last > first && g.IsClippedOut(IRECT(r.L + (last - 1) * xPerData, r.T, r.L + last * xPerData, r.B), mTrackSize))
+      last--;
+
     for (int c = 0; c < mBuf.nChans; c++)
     {
-      float xHi = 0.f;
-      float yHi = mBuf.vals[c][0] * maxY;
+      float xHi = ((float) first * xPerData);
+      float yHi = mBuf.vals[c][first] * maxY;
       yHi = Clip(yHi, -maxY, maxY);
 
       g.PathMoveTo(r.L + xHi, r.MH() - yHi);
-      for (int s = 1; s < MAXBUF; s++)
+      for (int s = first + 1; s <= last; s++)
       {
         xHi = ((float) s * xPerData);
         yHi = mBuf.vals[c][s] * maxY;
@@ -92,14 +102,49 @@ public:
     {
       IByteStream stream(pData, dataSize);
 
+      const auto prevBuf = mBuf;
       int pos = 0;
       pos = stream.Get(&mBuf, pos);
 
-      SetDirty(false);
+      const IRECT changed = GetChangedRECT(prevBuf);
+
+      if (!changed.Empty())
+        SetDirtyRECT(changed);
     }
   }
 
 private:
+  /** @return The part of the widget where the trace has changed since prevBuf, so that a partly static trace (e.g. a quiet signal) doesn't redraw the whole scope. Empty if nothing changed */
+  IRECT GetChangedRECT(const ISenderData<MAXNC, std::array<float, MAXBUF>>& prevBuf) const
+  {
+    if (prevBuf.nChans != mBuf.nChans)
+      return mRECT;
+
+    int first = MAXBUF;
+    int last = -1;
+
+    for (int c = 0; c < mBuf.nChans; c++)
+    {
+      for (int s = 0; s < MAXBUF; s++)
+      {
+        if (prevBuf.vals[c][s] != mBuf.vals[c][s])
+        {
+          first = std::min(first, s);
+          last = std::max(last, s);
+        }
+      }
+    }
+
+    if (last < 0)
+      return IRECT();
+
+    // the segments either side of a changed point move too
+    const IRECT r = mWidgetBounds.GetPadded(-mPadding);
+    const float xPerData = r.W() / (float) MAXBUF;
+    const float pad = mTrackSize + mStyle.frameThickness + 1.f;
+    return IRECT(r.L + (first - 1) * xPerData - pad, mWidgetBounds.T, r.L + (last + 1) * xPerData + pad, mWidgetBounds.B).Intersect(mWidgetBounds.GetPadded(mStyle.frameThickness));
+  }
+
   ISenderData<MAXNC, std::array<float, MAXBUF>> mBuf;
   float mPadding = 2.f;
 };
@@ -9,7 +9,13 @@
 */
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "IGraphicsAGG.h"
 
@@ -156,9 +162,9 @@ static void GradientRasterizeAdapt(Rasterizer& rasterizer, EPatternExtend extend
   }
 }
 
-void IGraphicsAGG::Rasterizer::Rasterize(const IPattern& pattern, agg::comp_op_e op, float opacity, EFillRule rule)
+void IGraphicsAGG::Rasterizer::Rasterize(const IPattern& pattern, agg::comp_op_e op, float opacity, EFillRule rule, const agg::trans_affine& transform)
 {
-  mRasterizer.filling_rule(rule == EFillRule::Winding ? agg::fill_non_zero : agg::fill_even_odd );
+  SetFillRule(rule == EFillRule::Winding ? agg::fill_non_zero : agg::fill_even_odd);
   
   switch (pattern.mType)
   {
@@ -175,7 +181,7 @@ void IGraphicsAGG::Rasterizer::Rasterize(const IPattern& pattern, agg::comp_op_e
       agg::gradient_lut<agg::color_interpolator<agg::rgba8>, 512> colors;
       
       // Scaling
-      gradientMTX = (agg::trans_affine() / mGraphics.mTransform) * gradientMTX * agg::trans_affine_scaling(512.0);
+      gradientMTX = (agg::trans_affine() / transform) * gradientMTX * agg::trans_affine_scaling(512.0);
       
       // Make gradient lut
       colors.remove_all();
@@ -199,6 +205,352 @@ void IGraphicsAGG::Rasterizer::Rasterize(const IPattern& pattern, agg::comp_op_e
   }
 }
 
+#pragma mark - Tile rendering
+
+/** The commands recorded for the main pixel map in a frame, and the threads that rasterize them in bands */
+class IGraphicsAGG::TileRecorder
+{
+public:
+  struct Vertex
+  {
+    double x;
+    double y;
+    unsigned cmd;
+  };
+
+  struct Command
+  {
+    enum class EType { Solid, Pattern, Bitmap, BlendFrom };
+
+    EType mType = EType::Solid;
+    int mVertexStart = 0;
+    int mVertexEnd = 0;
+    agg::rect_d mBounds; // device pixels, so bands the command doesn't touch can be skipped
+    agg::rect_d mClip; // device pixels
+    agg::comp_op_e mOp = agg::comp_op_src_over;
+    agg::filling_rule_e mFillRule = agg::fill_non_zero;
+    agg::rgba8 mColor;
+    IPattern mPattern = IPattern(COLOR_BLACK);
+    EFillRule mPatternFillRule = EFillRule::Winding;
+    float mOpacity = 1.f;
+    agg::trans_affine mTransform; // the graphics transform for patterns, the source matrix for bitmaps
+    agg::rendering_buffer mSource; // not owned, only bitmaps that live longer than the frame are recorded
+    bool mPreMultiplied = false;
+    agg::cover_type mCover = 255;
+    agg::rect_i mSourceRect;
+    int mX = 0;
+    int mY = 0;
+  };
+
+  /** An AGG vertex source that replays a recorded path */
+  class PathSource
+  {
+  public:
+    PathSource(const Vertex* pVertices, int nVertices) : mVertices(pVertices), mNVertices(nVertices) {}
+
+    void rewind(unsigned pathID) { mIdx = 0; }
+
+    unsigned vertex(double* x, double* y)
+    {
+      if (mIdx >= mNVertices)
+        return agg::path_cmd_stop;
+
+      const Vertex& v = mVertices[mIdx++];
+      *x = v.x;
+      *y = v.y;
+      return v.cmd;
+    }
+
+  private:
+    const Vertex* mVertices;
+    int mNVertices;
+    int mIdx = 0;
+  };
+
+  TileRecorder(IGraphicsAGG& graphics, int nThreads, int bandHeight)
+  : mBandHeight(std::max(bandHeight, 1))
+  {
+    for (auto i = 0; i < nThreads; i++)
+      mRasterizers.push_back(std::make_unique<Rasterizer>(graphics));
+
+    mStats.mNThreads = nThreads;
+
+    // the drawing thread rasterizes bands too, as worker 0
+    for (auto i = 1; i < nThreads; i++)
+      mThreads.emplace_back(&TileRecorder::ThreadProc, this, i);
+  }
+
+  ~TileRecorder()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mQuit = true;
+    }
+
+    mStartCV.notify_all();
+
+    for (auto& thread : mThreads)
+      thread.join();
+  }
+
+  TileRecorder(const TileRecorder&) = delete;
+  TileRecorder& operator=(const TileRecorder&) = delete;
+
+  template <typename VertexSourceType>
+  Command& Add(VertexSourceType& path, const agg::rect_d& clip, agg::filling_rule_e fillRule)
+  {
+    Command& command = AddCommand(clip, fillRule);
+    command.mVertexStart = static_cast<int>(mVertices.size());
+
+    double x, y;
+    unsigned cmd;
+    path.rewind(0);
+
+    while (!agg::is_stop(cmd = path.vertex(&x, &y)))
+    {
+      mVertices.push_back({x, y, cmd});
+
+      if (agg::is_vertex(cmd))
+      {
+        command.mBounds.x1 = std::min(command.mBounds.x1, x);
+        command.mBounds.y1 = std::min(command.mBounds.y1, y);
+        command.mBounds.x2 = std::max(command.mBounds.x2, x);
+        command.mBounds.y2 = std::max(command.mBounds.y2, y);
+      }
+    }
+
+    command.mVertexEnd = static_cast<int>(mVertices.size());
+    return command;
+  }
+
+  Command& AddBlendFrom(const IRECT& bounds, agg::filling_rule_e fillRule)
+  {
+    Command& command = AddCommand(agg::rect_d(bounds.L, bounds.T, bounds.R, bounds.B), fillRule);
+    command.mType = Command::EType::BlendFrom;
+    command.mBounds = command.mClip;
+    return command;
+  }
+
+  /** Rasterize the recorded commands into a buffer, and clear them */
+  void Flush(agg::rendering_buffer& output)
+  {
+    if (mCommands.empty())
+      return;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    mOutput = &output;
+    mNBands = (static_cast<int>(output.height()) + mBandHeight - 1) / mBandHeight;
+    mNextBand.store(0);
+
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mNBusy = static_cast<int>(mThreads.size());
+      mGeneration++;
+    }
+
+    mStartCV.notify_all();
+    RasterizeBands(0);
+
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mDoneCV.wait(lock, [this]() { return mNBusy == 0; });
+    }
+
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    {
+      std::lock_guard<std::mutex> lock(mStatsMutex);
+      mStats.mNBands = mNBands;
+      mStats.mNCommands += static_cast<int>(mCommands.size());
+      mStats.mNFlushes++;
+      mStats.mRasterizeMs += ms;
+    }
+
+    Clear();
+  }
+
+  /** Discard the recorded commands, e.g. when the pixel map is resized */
+  void Clear()
+  {
+    mCommands.clear();
+    mVertices.clear();
+  }
+
+  /** Start a new frame's statistics */
+  void ResetStats()
+  {
+    std::lock_guard<std::mutex> lock(mStatsMutex);
+    const int nThreads = mStats.mNThreads;
+    mStats = TileStats();
+    mStats.mNThreads = nThreads;
+  }
+
+  TileStats GetStats() const
+  {
+    std::lock_guard<std::mutex> lock(mStatsMutex);
+    return mStats;
+  }
+
+private:
+  Command& AddCommand(const agg::rect_d& clip, agg::filling_rule_e fillRule)
+  {
+    mCommands.emplace_back();
+    Command& command = mCommands.back();
+    command.mClip = clip;
+    command.mFillRule = fillRule;
+    command.mBounds = agg::rect_d(1e30, 1e30, -1e30, -1e30);
+    return command;
+  }
+
+  void ThreadProc(int worker)
+  {
+    uint64_t generation = 0;
+
+    while (true)
+    {
+      {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mStartCV.wait(lock, [&]() { return mQuit || mGeneration != generation; });
+
+        if (mQuit)
+          return;
+
+        generation = mGeneration;
+      }
+
+      RasterizeBands(worker);
+
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mNBusy--;
+      }
+
+      mDoneCV.notify_one();
+    }
+  }
+
+  void RasterizeBands(int worker)
+  {
+    Rasterizer& rasterizer = *mRasterizers[worker];
+    rasterizer.SetOutput(*mOutput, false);
+
+    for (int band = mNextBand.fetch_add(1); band < mNBands; band = mNextBand.fetch_add(1))
+    {
+      const int y1 = band * mBandHeight;
+      const int y2 = std::min(y1 + mBandHeight, static_cast<int>(mOutput->height()));
+      rasterizer.SetOutputRows(y1, y2);
+
+      for (const Command& command : mCommands)
+        Rasterize(rasterizer, command, y1, y2);
+    }
+  }
+
+  void Rasterize(Rasterizer& rasterizer, const Command& command, int y1, int y2)
+  {
+    // N.B. bounds are inclusive of antialiased edges, so allow a pixel either side
+    if (command.mBounds.y2 + 1. < y1 || command.mBounds.y1 - 1. >= y2)
+      return;
+
+    if (command.mType == Command::EType::BlendFrom)
+    {
+      // the renderer's clip box limits this to the band
+      rasterizer.BlendFrom(const_cast<agg::rendering_buffer&>(command.mSource), command.mSourceRect, command.mX, command.mY, command.mOp, command.mCover, command.mPreMultiplied);
+      return;
+    }
+
+    const agg::rect_d clip(command.mClip.x1, std::max(command.mClip.y1, static_cast<double>(y1)), command.mClip.x2, std::min(command.mClip.y2, static_cast<double>(y2)));
+
+    if (clip.y1 >= clip.y2)
+      return;
+
+    PathSource path(mVertices.data() + command.mVertexStart, command.mVertexEnd - command.mVertexStart);
+    rasterizer.SetPath(path, clip);
+    rasterizer.SetFillRule(command.mFillRule);
+
+    switch (command.mType)
+    {
+      case Command::EType::Solid:
+        rasterizer.Rasterize(command.mColor, command.mOp);
+        break;
+      case Command::EType::Pattern:
+        rasterizer.Rasterize(command.mPattern, command.mOp, command.mOpacity, command.mPatternFillRule, command.mTransform);
+        break;
+      case Command::EType::Bitmap:
+      {
+        agg::trans_affine srcMtx = command.mTransform;
+        rasterizer.RasterizeBitmap(const_cast<agg::rendering_buffer&>(command.mSource), command.mPreMultiplied, srcMtx, command.mOp, command.mCover);
+        break;
+      }
+      case Command::EType::BlendFrom:
+        break;
+    }
+  }
+
+  std::vector<Command> mCommands;
+  std::vector<Vertex> mVertices;
+  std::vector<std::unique_ptr<Rasterizer>> mRasterizers; // one per thread
+  std::vector<std::thread> mThreads;
+  std::mutex mMutex;
+  std::condition_variable mStartCV;
+  std::condition_variable mDoneCV;
+  uint64_t mGeneration = 0;
+  int mNBusy = 0;
+  bool mQuit = false;
+  agg::rendering_buffer* mOutput = nullptr;
+  std::atomic<int> mNextBand{0};
+  int mNBands = 0;
+  const int mBandHeight;
+  mutable std::mutex mStatsMutex;
+  TileStats mStats;
+};
+
+template <typename VertexSourceType>
+void IGraphicsAGG::Rasterizer::Record(VertexSourceType& path, agg::rgba8 color, agg::comp_op_e op)
+{
+  TileRecorder::Command& command = mRecorder->Add(path, GetClip(), mFillRule);
+  command.mColor = color;
+  command.mOp = op;
+}
+
+template <typename VertexSourceType>
+void IGraphicsAGG::Rasterizer::Record(VertexSourceType& path, const agg::rendering_buffer& src, bool preMultiplied, const agg::trans_affine& srcMtx, agg::comp_op_e op, agg::cover_type cover)
+{
+  TileRecorder::Command& command = mRecorder->Add(path, GetClip(), mFillRule);
+  command.mType = TileRecorder::Command::EType::Bitmap;
+  command.mSource = src;
+  command.mPreMultiplied = preMultiplied;
+  command.mTransform = srcMtx;
+  command.mOp = op;
+  command.mCover = cover;
+}
+
+template <typename VertexSourceType>
+void IGraphicsAGG::Rasterizer::Record(VertexSourceType& path, const IPattern& pattern, agg::comp_op_e op, float opacity, EFillRule rule)
+{
+  TileRecorder::Command& command = mRecorder->Add(path, GetClip(), mFillRule);
+  command.mType = TileRecorder::Command::EType::Pattern;
+  command.mPattern = pattern;
+  command.mPatternFillRule = rule;
+  command.mOpacity = opacity;
+  command.mTransform = mGraphics.mTransform;
+  command.mOp = op;
+  // the fill rule is set by Rasterize(pattern), so later solid commands must see it too
+  SetFillRule(rule == EFillRule::Winding ? agg::fill_non_zero : agg::fill_even_odd);
+}
+
+void IGraphicsAGG::Rasterizer::RecordBlendFrom(const agg::rendering_buffer& renBuf, const IRECT& bounds, const agg::rect_i& r, int x, int y, agg::comp_op_e op, agg::cover_type cover, bool preMultiplied)
+{
+  TileRecorder::Command& command = mRecorder->AddBlendFrom(bounds, mFillRule);
+  command.mSource = renBuf;
+  command.mSourceRect = r;
+  command.mX = x;
+  command.mY = y;
+  command.mOp = op;
+  command.mCover = cover;
+  command.mPreMultiplied = preMultiplied;
+}
+
 #pragma mark -
 
 IGraphicsAGG::IGraphicsAGG(IGEditorDelegate& dlg, int w, int h, int fps, float scale)
@@ -217,12 +569,18 @@ IGraphicsAGG::IGraphicsAGG(IGEditorDelegate& dlg, int w, int h, int fps, float s
 
 IGraphicsAGG::~IGraphicsAGG()
 {
+  StopRenderThread();
+  mTileRecorder = nullptr;
+
   StaticStorage<IFontData>::Accessor storage(sFontCache);
   storage.Release();
 }
 
 void IGraphicsAGG::DrawResize()
 {
+  if (mTileRecorder)
+    mTileRecorder->Clear();
+
   mPixelMap.create(WindowWidth() * GetScreenScale(), WindowHeight() * GetScreenScale());
   UpdateLayer();
   mRasterizer.SetOutput(mRenBuf);
@@ -230,6 +588,46 @@ void IGraphicsAGG::DrawResize()
   mTransform = agg::trans_affine_scaling(GetBackingPixelScale(), GetBackingPixelScale());
 }
 
+void IGraphicsAGG::SetTileRendering(int nThreads, int bandHeight)
+{
+  WaitForRenderThread();
+  mRasterizer.SetRecorder(nullptr);
+  mTileRecorder = nullptr;
+
+  if (nThreads > 1)
+  {
+    mTileRecorder = std::make_unique<TileRecorder>(*this, nThreads, bandHeight);
+    mRasterizer.SetRecorder(mTileRecorder.get());
+  }
+}
+
+int IGraphicsAGG::GetTileRenderingThreads() const
+{
+  return mTileRecorder ? mTileRecorder->GetStats().mNThreads : 1;
+}
+
+IGraphicsAGG::TileStats IGraphicsAGG::GetTileStats() const
+{
+  return mTileRecorder ? mTileRecorder->GetStats() : TileStats();
+}
+
+void IGraphicsAGG::FlushDrawing()
+{
+  if (mTileRecorder)
+  {
+    agg::rendering_buffer renBuf(mPixelMap.buf(), mPixelMap.width(), mPixelMap.height(), mPixelMap.row_bytes());
+    mTileRecorder->Flush(renBuf);
+  }
+}
+
+void IGraphicsAGG::BeginFrame()
+{
+  if (mTileRecorder)
+    mTileRecorder->ResetStats();
+
+  IGraphicsPathBase::BeginFrame();
+}
+
 void IGraphicsAGG::UpdateLayer()
 {
   agg::pixel_map* pPixelMap = mLayers.empty() ? &mPixelMap : mLayers.top()->GetAPIBitmap()->GetBitmap();
@@ -281,6 +679,15 @@ void IGraphicsAGG::DrawBitmap(const IBitmap& bitmap, const IRECT& dest, int srcX
   agg::pixel_map* pSource = pAPIBitmap->GetBitmap();
   agg::rendering_buffer src(pSource->buf(), pSource->width(), pSource->height(), pSource->row_bytes());
 
+  // with tile rendering, layers (the only pre-multiplied bitmaps) can be freed before the end of the frame, so they are drawn immediately rather than recorded
+  const bool drawNow = preMultiplied && mTileRecorder && mLayers.empty();
+
+  if (drawNow)
+  {
+    FlushDrawing();
+    mRasterizer.SetRecorder(nullptr);
+  }
+
   agg::trans_affine srcMtx;
   srcMtx /= mTransform;
   srcMtx *= agg::trans_affine_translation(srcX - dest.L, srcY - dest.T);
@@ -301,17 +708,11 @@ void IGraphicsAGG::DrawBitmap(const IBitmap& bitmap, const IRECT& dest, int srcX
     agg::rounded_rect rect(dest.L, dest.T, dest.R, dest.B, 0);
     agg::conv_transform<agg::rounded_rect> tr(rect, mTransform);
       
-    if (preMultiplied)
-    {
-      PixfmtPreType fmtSrc(src);
-      mRasterizer.Rasterize(fmtSrc, tr, srcMtx, AGGBlendMode(pBlend), AGGCover(pBlend));
-    }
-    else
-    {
-      PixfmtType fmtSrc(src);
-      mRasterizer.Rasterize(fmtSrc, tr, srcMtx, AGGBlendMode(pBlend), AGGCover(pBlend));
-    }
+    mRasterizer.RasterizeBitmap(src, preMultiplied, tr, srcMtx, AGGBlendMode(pBlend), AGGCover(pBlend));
   }
+
+  if (drawNow)
+    mRasterizer.SetRecorder(mTileRecorder.get());
 }
 
 void IGraphicsAGG::PathArc(float cx, float cy, float r, float a1, float a2, EWinding winding)
@@ -453,6 +854,8 @@ void IGraphicsAGG::PathFill(const IPattern& pattern, const IFillOptions& options
 
 IColor IGraphicsAGG::GetPoint(int x, int y)
 {
+  FlushDrawing();
+
   agg::rgba8 point = mRasterizer.GetPixel(x, y);
   IColor color(point.a, point.r, point.g, point.b);
   return color;
@@ -547,7 +950,7 @@ void IGraphicsAGG::EndFrame()
   CGContextScaleCTM(pCGContext, 1.0, -1.0);
   mPixelMap.draw(pCGContext, GetScreenScale());
   CGContextRestoreGState(pCGContext);
-#else
+#elif defined OS_WIN
   PAINTSTRUCT ps;
   HWND hWnd = (HWND) GetWindow();
   HDC dc = BeginPaint(hWnd, &ps);
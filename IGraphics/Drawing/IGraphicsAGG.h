@@ -83,6 +83,8 @@ private:
   using FontEngineType = agg::font_engine_freetype_int32;
   using FontManagerType = agg::font_cache_manager<FontEngineType>;
 
+  class TileRecorder;
+
   class Rasterizer
   {
   public:
@@ -93,18 +95,36 @@ private:
       
     agg::rgba8 GetPixel(int x, int y) { return mRenBase.pixel(x, y); }
 
-    void SetOutput(agg::rendering_buffer& renBuf)
+    void SetOutput(agg::rendering_buffer& renBuf, bool clear = true)
     {
       mPixf = PixfmtType(renBuf);
       mRenBase = RenbaseType(mPixf);
       mPixfPre = PixfmtPreType(renBuf);
       mRenBasePre = RenbasePreType(mPixfPre);
-      mRenBase.clear(agg::rgba(1, 1, 1));
+      
+      if (clear)
+        mRenBase.clear(agg::rgba(1, 1, 1));
+    }
+    
+    /** Limit the output to a band of rows, for tile rendering */
+    void SetOutputRows(int y1, int y2)
+    {
+      mRenBase.clip_box(0, y1, mRenBase.width() - 1, y2 - 1);
+      mRenBasePre.clip_box(0, y1, mRenBasePre.width() - 1, y2 - 1);
     }
+    
+    /** When a recorder is set, draws into the main pixel map (rather than a layer) are recorded, to be rasterized later by IGraphicsAGG::FlushDrawing() */
+    void SetRecorder(TileRecorder* pRecorder) { mRecorder = pRecorder; }
 
     template <typename VertexSourceType>
     void Rasterize(VertexSourceType& path, agg::rgba8 color, agg::comp_op_e op)
     {
+      if (IsRecording())
+      {
+        Record(path, color, op);
+        return;
+      }
+
       SetPath(path);
       Rasterize(color, op);
     }
@@ -136,27 +156,30 @@ private:
     }
     
     template <typename VertexSourceType>
-    void Rasterize(PixfmtType& src, VertexSourceType& path, agg::trans_affine& srcMtx, agg::comp_op_e op, agg::cover_type cover)
-    {
-      SetPath(path);
-      Rasterize(src, srcMtx, op, cover);
-    }
-    
-    void Rasterize(PixfmtType& src, agg::trans_affine& srcMtx, agg::comp_op_e op, agg::cover_type cover)
-    {
-      RenderBitmap(src, mRenBase, srcMtx, op, cover);
-    }
-    
-    template <typename VertexSourceType>
-    void Rasterize(PixfmtPreType& src, VertexSourceType& path, agg::trans_affine& srcMtx, agg::comp_op_e op, agg::cover_type cover)
+    void RasterizeBitmap(agg::rendering_buffer& src, bool preMultiplied, VertexSourceType& path, agg::trans_affine& srcMtx, agg::comp_op_e op, agg::cover_type cover)
     {
+      if (IsRecording())
+      {
+        Record(path, src, preMultiplied, srcMtx, op, cover);
+        return;
+      }
+
       SetPath(path);
-      Rasterize(src, srcMtx, op, cover);
+      RasterizeBitmap(src, preMultiplied, srcMtx, op, cover);
     }
     
-    void Rasterize(PixfmtPreType& src, agg::trans_affine& srcMtx, agg::comp_op_e op, agg::cover_type cover)
+    void RasterizeBitmap(agg::rendering_buffer& src, bool preMultiplied, agg::trans_affine& srcMtx, agg::comp_op_e op, agg::cover_type cover)
     {
-      RenderBitmap(src, mRenBasePre, srcMtx, op, cover);
+      if (preMultiplied)
+      {
+        PixfmtPreType fmtSrc(src);
+        RenderBitmap(fmtSrc, mRenBasePre, srcMtx, op, cover);
+      }
+      else
+      {
+        PixfmtType fmtSrc(src);
+        RenderBitmap(fmtSrc, mRenBase, srcMtx, op, cover);
+      }
     }
     
     void BlendFrom(agg::rendering_buffer& renBuf, const IRECT& bounds, int srcX, int srcY, agg::comp_op_e op, agg::cover_type cover, bool preMultiplied)
@@ -166,6 +189,17 @@ private:
       int x = std::round(bounds.L) - srcX;
       int y = std::round(bounds.T) - srcY;
       
+      if (IsRecording())
+      {
+        RecordBlendFrom(renBuf, bounds, r, x, y, op, cover, preMultiplied);
+        return;
+      }
+
+      BlendFrom(renBuf, r, x, y, op, cover, preMultiplied);
+    }
+    
+    void BlendFrom(agg::rendering_buffer& renBuf, const agg::rect_i& r, int x, int y, agg::comp_op_e op, agg::cover_type cover, bool preMultiplied)
+    {
       if (preMultiplied)
       {
         mPixfPre.comp_op(op);
@@ -181,27 +215,63 @@ private:
     template <typename VertexSourceType>
     void Rasterize(VertexSourceType& path, const IPattern& pattern, agg::comp_op_e op, float opacity, EFillRule rule = EFillRule::Winding)
     {
+      if (IsRecording())
+      {
+        Record(path, pattern, op, opacity, rule);
+        return;
+      }
+
       SetPath(path);
       Rasterize(pattern, op, opacity, rule);
     }
     
-    void Rasterize(const IPattern& pattern, agg::comp_op_e op, float opacity, EFillRule rule = EFillRule::Winding);
+    void Rasterize(const IPattern& pattern, agg::comp_op_e op, float opacity, EFillRule rule = EFillRule::Winding)
+    {
+      Rasterize(pattern, op, opacity, rule, mGraphics.mTransform);
+    }
+
+    void Rasterize(const IPattern& pattern, agg::comp_op_e op, float opacity, EFillRule rule, const agg::trans_affine& transform);
 
     template <typename VertexSourceType>
     void SetPath(VertexSourceType& path)
     {
-      // Clip
-      IRECT clip = mGraphics.mClipRECT;
-      clip.Translate(mGraphics.XTranslate(), mGraphics.YTranslate());
-      clip.Scale(mGraphics.GetBackingPixelScale());
-      mRasterizer.clip_box(clip.L, clip.T, clip.R, clip.B);
-      
-      // Add path
+      SetPath(path, GetClip());
+    }
+
+    template <typename VertexSourceType>
+    void SetPath(VertexSourceType& path, const agg::rect_d& clip)
+    {
+      mRasterizer.clip_box(clip.x1, clip.y1, clip.x2, clip.y2);
       mRasterizer.reset();
       mRasterizer.add_path(path);
     }
+    
+    void SetFillRule(agg::filling_rule_e rule)
+    {
+      mFillRule = rule;
+      mRasterizer.filling_rule(rule);
+    }
 
   private:
+    /** @return The current clip in device pixels */
+    agg::rect_d GetClip() const
+    {
+      IRECT clip = mGraphics.mClipRECT;
+      clip.Translate(mGraphics.XTranslate(), mGraphics.YTranslate());
+      clip.Scale(mGraphics.GetBackingPixelScale());
+      return agg::rect_d(clip.L, clip.T, clip.R, clip.B);
+    }
+    
+    bool IsRecording() const { return mRecorder && mGraphics.mLayers.empty(); }
+
+    template <typename VertexSourceType>
+    void Record(VertexSourceType& path, agg::rgba8 color, agg::comp_op_e op);
+    template <typename VertexSourceType>
+    void Record(VertexSourceType& path, const agg::rendering_buffer& src, bool preMultiplied, const agg::trans_affine& srcMtx, agg::comp_op_e op, agg::cover_type cover);
+    template <typename VertexSourceType>
+    void Record(VertexSourceType& path, const IPattern& pattern, agg::comp_op_e op, float opacity, EFillRule rule);
+    void RecordBlendFrom(const agg::rendering_buffer& renBuf, const IRECT& bounds, const agg::rect_i& r, int x, int y, agg::comp_op_e op, agg::cover_type cover, bool preMultiplied);
+
     template <typename RendererType>
     void Render(RendererType& renderer, agg::comp_op_e op)
     {
@@ -229,11 +299,13 @@ private:
     }
 
     IGraphicsAGG& mGraphics;
+    TileRecorder* mRecorder = nullptr;
     RenbaseType mRenBase;
     PixfmtType mPixf;
     RenbasePreType mRenBasePre;
     PixfmtPreType mPixfPre;
     agg::rasterizer_scanline_aa<> mRasterizer;
+    agg::filling_rule_e mFillRule = agg::fill_non_zero;
   };
 public:
   IGraphicsAGG(IGEditorDelegate& dlg, int w, int h, int fps, float scale);
@@ -261,6 +333,31 @@ public:
   void UpdateLayer() override;
     
   void EndFrame() override;
+  bool SupportsRenderThread() const override { return true; }
+  void BeginFrame() override;
+  void FlushDrawing() override;
+
+  /** Timing and counts for the last frame drawn with tile rendering */
+  struct TileStats
+  {
+    int mNThreads = 1;
+    int mNBands = 0;
+    int mNCommands = 0; // draw commands recorded for the main pixel map
+    int mNFlushes = 0; // times the recorded commands were rasterized, more than one if something needed the pixels mid-frame
+    double mRasterizeMs = 0.; // time spent rasterizing the recorded commands
+  };
+
+  /** Rasterize the main pixel map in horizontal bands on several threads. Drawing into the main pixel map is recorded as a list of device space paths and paints,
+   * and the bands are rasterized in parallel (each with its own clip) when the frame is complete. Drawing into layers, and drawing layers, is still done immediately on the drawing thread
+   * @param nThreads The number of threads to rasterize with, including the drawing thread. 1 or less disables tile rendering
+   * @param bandHeight The height of the bands in pixels. Bands are handed out to the threads as they finish the previous one */
+  void SetTileRendering(int nThreads, int bandHeight = 64);
+
+  /** @return The number of threads used for tile rendering, 1 if it is disabled */
+  int GetTileRenderingThreads() const;
+
+  /** @return The timing of the last frame drawn with tile rendering */
+  TileStats GetTileStats() const;
   
   bool BitmapExtSupported(const char* ext) override;
 
@@ -305,6 +402,7 @@ private:
   agg::trans_affine mTransform;
   PixelMapType mPixelMap;
   Rasterizer mRasterizer;
+  std::unique_ptr<TileRecorder> mTileRecorder;
 
   //pipeline to process the vectors glyph paths(curves + contour)
   agg::conv_curve<FontManagerType::path_adaptor_type> mFontCurves;
@@ -188,6 +188,8 @@ IGraphicsLice::IGraphicsLice(IGEditorDelegate& dlg, int w, int h, int fps, float
 
 IGraphicsLice::~IGraphicsLice() 
 {
+  StopRenderThread();
+
   StaticStorage<LICE_IFont>::Accessor fontStorage(sFontCache);
   StaticStorage<FontInfo>::Accessor fontInfoStorage(sFontInfoCache);
   fontStorage.Release();
@@ -964,7 +966,7 @@ void IGraphicsLice::EndFrame()
     CGContextRestoreGState(pCGContext);
     CGImageRelease(img);
   }
-#else // OS_WIN
+#elif defined OS_WIN
   PAINTSTRUCT ps;
   HWND hWnd = (HWND) GetWindow();
   HDC dc = BeginPaint(hWnd, &ps);
@@ -82,6 +82,8 @@ public:
   void FillArc(const IColor& color, float cx, float cy, float r, float a1, float a2,  const IBlend* pBlend) override;
   void FillCircle(const IColor& color, float cx, float cy, float r, const IBlend* pBlend) override;
     
+  bool IsClippedOut(const IRECT& bounds, float pad) const override { return mLayers.empty() && !mClipRECT.Empty() && !mClipRECT.Intersects(bounds.GetPadded(pad + 1.f)); }
+
   IColor GetPoint(int x, int y) override;
   void* GetDrawContext() override { return mDrawBitmap.get(); }
 
@@ -111,6 +113,7 @@ protected:
   void DoDrawText(const IText& text, const char* str, const IRECT& bounds, const IBlend* pBlend) override;
 
   void EndFrame() override;
+  bool SupportsRenderThread() const override { return true; }
     
   float GetBackingPixelScale() const override { return (float) GetScreenScale(); };
 
@@ -442,6 +442,8 @@ void IGraphicsSkia::EndFrame()
     StretchDIBits(hdc, 0, 0, w, h, 0, 0, w, h, bmpInfo->bmiColors, bmpInfo, DIB_RGB_COLORS, SRCCOPY);
     ReleaseDC(hWnd, hdc);
     EndPaint(hWnd, &ps);
+  #elif defined IGRAPHICS_HEADLESS
+    // no window to present to, the frame stays in the raster surface, where GetPoint() reads it (IGraphicsHeadless also overrides EndFrame())
   #else
     #error NOT IMPLEMENTED
   #endif
@@ -520,7 +522,14 @@ void IGraphicsSkia::PathArc(float cx, float cy, float r, float a1, float a2, EWi
 
 IColor IGraphicsSkia::GetPoint(int x, int y)
 {
-  return COLOR_BLACK; //TODO:
+#ifdef IGRAPHICS_CPU
+  uint32_t pixel = 0;
+  const SkImageInfo info = SkImageInfo::Make(1, 1, kBGRA_8888_SkColorType, kUnpremul_SkAlphaType);
+
+  if (mSurface && mSurface->readPixels(info, &pixel, sizeof(pixel), x * GetScreenScale(), y * GetScreenScale()))
+    return IColor(SkColorGetA(pixel), SkColorGetR(pixel), SkColorGetG(pixel), SkColorGetB(pixel));
+#endif
+  return COLOR_BLACK; //TODO: GPU surfaces
 }
 
 bool IGraphicsSkia::LoadAPIFont(const char* fontID, const PlatformFontPtr& font)
@@ -1,4 +1,6 @@
 #include "IGraphicsFlexBox.h"
+#include "IGraphics.h"
+#include "IControl.h"
 
 using namespace iplug;
 using namespace igraphics;
@@ -17,6 +19,9 @@ IFlexBox::~IFlexBox()
 
 void IFlexBox::Init(const IRECT& r, YGFlexDirection direction, YGJustify justify, YGWrap wrap, float padding, float margin)
 {
+  // N.B. Yoga only marks the root dirty if one of these has actually changed
+  mOriginX = r.L;
+  mOriginY = r.T;
   YGNodeStyleSetWidth(mRootNodeRef, r.W());
   YGNodeStyleSetHeight(mRootNodeRef, r.H());
   YGNodeStyleSetFlexDirection(mRootNodeRef, direction);
@@ -31,9 +36,8 @@ void IFlexBox::CalcLayout(YGDirection direction)
   YGNodeCalculateLayout(mRootNodeRef, YGUndefined, YGUndefined, direction);
 }
 
-YGNodeRef IFlexBox::AddItem(float width, float height, YGAlign alignSelf, float grow, float shrink, float margin)
+YGNodeRef IFlexBox::AddItem(float width, float height, YGAlign alignSelf, float grow, float shrink, float margin, YGNodeRef parent)
 {
-  int index = mNodeCounter;
   YGNodeRef child = YGNodeNew();
   
   if(width == YGUndefined)
@@ -54,16 +58,70 @@ YGNodeRef IFlexBox::AddItem(float width, float height, YGAlign alignSelf, float
   YGNodeStyleSetMargin(child, YGEdgeAll, margin);
   YGNodeStyleSetFlexGrow(child, grow);
   YGNodeStyleSetFlexShrink(child, shrink);
-  YGNodeInsertChild(mRootNodeRef, child, index);
-  
-  mNodeCounter++;
+  AddItem(child, parent);
   
   return child;
 }
 
-void IFlexBox::AddItem(YGNodeRef child)
+void IFlexBox::AddItem(YGNodeRef child, YGNodeRef parent)
+{
+  if (parent)
+    YGNodeInsertChild(parent, child, YGNodeGetChildCount(parent));
+  else
+    YGNodeInsertChild(mRootNodeRef, child, mNodeCounter++);
+}
+
+YGNodeRef IFlexBox::AddContainer(YGFlexDirection direction, float grow, float padding, YGNodeRef parent)
+{
+  YGNodeRef container = AddItem(YGUndefined, YGUndefined, YGAlignStretch, grow, 1.f, 0.f, parent);
+  YGNodeStyleSetFlexDirection(container, direction);
+  YGNodeStyleSetPadding(container, YGEdgeAll, padding);
+  return container;
+}
+
+YGNodeRef IFlexBox::AddTextItem(IGraphics& g, const IText& text, const char* str, IControl* pControl, YGNodeRef parent)
+{
+  YGNodeRef item = AddItem(0.f, 0.f, YGAlignAuto, 0.f, 0.f, 0.f, parent);
+  UpdateTextItem(item, g, text, str);
+  BindControl(item, pControl);
+  return item;
+}
+
+void IFlexBox::UpdateTextItem(YGNodeRef item, IGraphics& g, const IText& text, const char* str)
 {
-  YGNodeInsertChild(mRootNodeRef, child, mNodeCounter++);
+  IRECT bounds;
+  g.MeasureText(text, str, bounds);
+  YGNodeStyleSetWidth(item, std::ceil(bounds.W()));
+  YGNodeStyleSetHeight(item, std::ceil(bounds.H()));
+}
+
+YGNodeRef IFlexBox::AddBitmapItem(const IBitmap& bitmap, IControl* pControl, YGNodeRef parent)
+{
+  YGNodeRef item = AddItem(static_cast<float>(bitmap.FW()), static_cast<float>(bitmap.FH()), YGAlignAuto, 0.f, 0.f, 0.f, parent);
+  BindControl(item, pControl);
+  return item;
+}
+
+void IFlexBox::BindControl(YGNodeRef item, IControl* pControl)
+{
+  if (pControl)
+    mBindings[item] = Binding{pControl, IRECT()};
+  else
+    mBindings.erase(item);
+}
+
+void IFlexBox::Clear()
+{
+  mBindings.clear();
+
+  while (YGNodeGetChildCount(mRootNodeRef))
+  {
+    YGNodeRef child = YGNodeGetChild(mRootNodeRef, 0);
+    YGNodeRemoveChild(mRootNodeRef, child);
+    YGNodeFreeRecursive(child);
+  }
+
+  mNodeCounter = 0;
 }
 
 IRECT IFlexBox::GetRootBounds() const
@@ -83,6 +141,59 @@ IRECT IFlexBox::GetItemBounds(int nodeIndex) const
                YGNodeLayoutGetTop(mRootNodeRef)  + YGNodeLayoutGetTop(child)  + YGNodeLayoutGetHeight(child));
 };
 
+IRECT IFlexBox::GetNodeBounds(YGNodeRef node) const
+{
+  float x = mOriginX;
+  float y = mOriginY;
+
+  for (YGNodeRef n = node; n; n = YGNodeGetParent(n))
+  {
+    x += YGNodeLayoutGetLeft(n);
+    y += YGNodeLayoutGetTop(n);
+  }
+
+  return IRECT(x, y, x + YGNodeLayoutGetWidth(node), y + YGNodeLayoutGetHeight(node));
+}
+
+int IFlexBox::ApplyLayout()
+{
+  if (mBindings.empty())
+    return 0;
+
+  return ApplyLayout(mRootNodeRef, mOriginX, mOriginY);
+}
+
+int IFlexBox::ApplyLayout(YGNodeRef node, float x, float y)
+{
+  // A node that wasn't laid out again can still have moved, if one of its ancestors did, so the whole tree is walked.
+  // That's only a few float additions per node, the expensive parts (Yoga's layout pass and the controls' OnResize()) are only done where something changed
+  x += YGNodeLayoutGetLeft(node);
+  y += YGNodeLayoutGetTop(node);
+  YGNodeSetHasNewLayout(node, false);
+
+  int nChanged = 0;
+  auto it = mBindings.find(node);
+
+  if (it != mBindings.end())
+  {
+    const IRECT bounds(x, y, x + YGNodeLayoutGetWidth(node), y + YGNodeLayoutGetHeight(node));
+
+    if (bounds != it->second.mBounds || bounds != it->second.mControl->GetRECT())
+    {
+      it->second.mBounds = bounds;
+      it->second.mControl->SetTargetAndDrawRECTs(bounds);
+      nChanged++;
+    }
+  }
+
+  const uint32_t nChildren = YGNodeGetChildCount(node);
+
+  for (uint32_t i = 0; i < nChildren; i++)
+    nChanged += ApplyLayout(YGNodeGetChild(node, i), x, y);
+
+  return nChanged;
+}
+
 // TODO: eventually build Yoga as a static library,
 // for now include Yoga .cpp files here
 #include "YGLayout.cpp"
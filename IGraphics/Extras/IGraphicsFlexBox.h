@@ -1,13 +1,21 @@
 #pragma once
 
+#include <unordered_map>
+
 #include "Yoga.h"
 #include "IGraphicsStructs.h"
 
 BEGIN_IPLUG_NAMESPACE
 BEGIN_IGRAPHICS_NAMESPACE
 
+class IGraphics;
+class IControl;
+
 /** IFlexBox is a basic C++ helper for Yoga https://yogalayout.com. 
- * For advanced use, probably best just to use Yoga directly */
+ * For advanced use, probably best just to use Yoga directly.
+ * For a responsive UI, keep one IFlexBox for the lifetime of the UI rather than building a new one in every LayoutUI(): bind the items to their controls with BindControl(),
+ * and on resize just call Init() with the new bounds, CalcLayout() and ApplyLayout(). Yoga only marks a node dirty when its style actually changes and caches the layout of clean subtrees,
+ * so only the parts of the tree whose constraints changed are laid out again, and ApplyLayout() only touches the controls whose bounds moved */
 class IFlexBox
 {
 public:
@@ -32,11 +40,47 @@ public:
    * @param shrink https://yogalayout.com/docs/flex
    * @param margin https://yogalayout.com/docs/margins-paddings-borders
    * @return YGNodeRef The newly added YGNodeRef for the item (owned by this class) */
-  YGNodeRef AddItem(float width, float height, YGAlign alignSelf = YGAlignAuto, float grow = 0.f, float shrink = 1.f, float margin = 0.f);
+  YGNodeRef AddItem(float width, float height, YGAlign alignSelf = YGAlignAuto, float grow = 0.f, float shrink = 1.f, float margin = 0.f, YGNodeRef parent = nullptr);
   
   /** Add a flex item manually
-   * @param item A new YGNodeRef to add (owndership transferred) */
-  void AddItem(YGNodeRef item);
+   * @param item A new YGNodeRef to add (owndership transferred)
+   * @param parent The node to add the item to, or nullptr for the root node */
+  void AddItem(YGNodeRef item, YGNodeRef parent = nullptr);
+
+  /** Add a nested flex container, that further items can be added to
+   * @param direction https://yogalayout.com/docs/flex-direction
+   * @param grow https://yogalayout.com/docs/flex
+   * @param padding https://yogalayout.com/docs/margins-paddings-borders
+   * @param parent The node to add the container to, or nullptr for the root node
+   * @return YGNodeRef The newly added container (owned by this class) */
+  YGNodeRef AddContainer(YGFlexDirection direction, float grow = 1.f, float padding = 0.f, YGNodeRef parent = nullptr);
+
+  /** Add a flex item sized to fit a string. The text is measured once here, so relayouts don't measure it again. Call it again (or UpdateTextItem()) if the string or font changes
+   * @param g The graphics context to measure the text with
+   * @param text The IText to measure with
+   * @param str The string
+   * @param pControl The control to bind to the item, or nullptr
+   * @param parent The node to add the item to, or nullptr for the root node
+   * @return YGNodeRef The newly added item (owned by this class) */
+  YGNodeRef AddTextItem(IGraphics& g, const IText& text, const char* str, IControl* pControl = nullptr, YGNodeRef parent = nullptr);
+
+  /** Re-measure the text of an item added with AddTextItem(). Only marks the item dirty if the size has changed */
+  void UpdateTextItem(YGNodeRef item, IGraphics& g, const IText& text, const char* str);
+
+  /** Add a flex item with the size of one frame of a bitmap, at 1x scale
+   * @param bitmap The bitmap
+   * @param pControl The control to bind to the item, or nullptr
+   * @param parent The node to add the item to, or nullptr for the root node
+   * @return YGNodeRef The newly added item (owned by this class) */
+  YGNodeRef AddBitmapItem(const IBitmap& bitmap, IControl* pControl = nullptr, YGNodeRef parent = nullptr);
+
+  /** Bind a control to an item, so that ApplyLayout() sets the control's bounds
+   * @param item The item
+   * @param pControl The control, or nullptr to unbind it. It must stay attached to the graphics context while it is bound */
+  void BindControl(YGNodeRef item, IControl* pControl);
+
+  /** Remove all the items and their control bindings, keeping the root node's style */
+  void Clear();
   
   /** Calculate the layout, call after add all items
    * @param direction https://yogalayout.com/docs/layout-direction */
@@ -47,8 +91,26 @@ public:
 
   /** Get the bounds for a particular flex item */
   IRECT GetItemBounds(int nodeIndex) const;
+
+  /** Get the bounds of any node in the tree, including the offset of the IRECT passed to Init() */
+  IRECT GetNodeBounds(YGNodeRef node) const;
+
+  /** Set the bounds of the bound controls from the last CalcLayout(). Controls whose bounds haven't changed since the last call are not touched
+   * @return The number of controls that were moved or resized */
+  int ApplyLayout();
   
 private:
+  int ApplyLayout(YGNodeRef node, float x, float y);
+
+  struct Binding
+  {
+    IControl* mControl = nullptr;
+    IRECT mBounds; // the bounds last applied to the control
+  };
+
+  std::unordered_map<YGNodeRef, Binding> mBindings;
+  float mOriginX = 0.f;
+  float mOriginY = 0.f;
   int mNodeCounter = 0;
   YGConfigRef mConfigRef;
   YGNodeRef mRootNodeRef;
@@ -114,7 +114,11 @@ int IControl::GetParamIdx(int valIdx) const
 void IControl::SetParamIdx(int paramIdx, int valIdx)
 {
   assert(valIdx > kNoValIdx && valIdx < NVals());
+  const int oldParamIdx = mVals.at(valIdx).idx;
   mVals.at(valIdx).idx = paramIdx;
+
+  if (mParamsLinked && oldParamIdx != paramIdx)
+    mGraphics->UpdateControlParamLink(this, valIdx, oldParamIdx, paramIdx);
 }
 
 const IParam* IControl::GetParam(int valIdx) const
@@ -151,6 +155,7 @@ void IControl::SetValue(double value, int valIdx)
 double IControl::GetValue(int valIdx) const
 {
   assert(valIdx > kNoValIdx && valIdx < NVals());
+
   return mVals[valIdx].value;
 }
 
@@ -201,6 +206,7 @@ void IControl::SetDirty(bool triggerAction, int valIdx)
   ForValIdx(valIdx, setValue);
   
   mDirty = true;
+  mDirtyRECT = IRECT();
   
   if (triggerAction)
   {
@@ -226,6 +232,19 @@ void IControl::Animate()
     mAnimationFunc(this);
 }
 
+void IControl::SetDirtyRECT(const IRECT& bounds, bool triggerAction, int valIdx)
+{
+  const bool wasDirty = mDirty;
+  const IRECT prevDirtyRECT = mDirtyRECT;
+
+  SetDirty(triggerAction, valIdx);
+
+  if (!wasDirty)
+    mDirtyRECT = bounds;
+  else if (!prevDirtyRECT.Empty())
+    mDirtyRECT = prevDirtyRECT.Union(bounds);
+}
+
 bool IControl::IsDirty()
 {
   if (GetAnimationFunction())
@@ -390,6 +390,17 @@ public:
    * NOTE: it is easy to forget that this method always sets the control dirty, the argument refers to whether a consecutive action should be performed */
   virtual void SetDirty(bool triggerAction = true, int valIdx = kNoValIdx);
 
+  /** Mark part of the control as dirty, e.g. the one slider of a multislider or the one key of a keyboard that changed, so that only that region is redrawn.
+   * Draw() is still called, but it is clipped to the region, and the drawing primitives skip anything that's outside it (see IGraphics::IsClippedOut()).
+   * Regions are merged into their bounding rectangle until the control is drawn. If the whole control is already dirty (e.g. SetDirty() was called since it was last drawn) it stays that way
+   * @param bounds The region to redraw
+   * @param triggerAction As for SetDirty()
+   * @param valIdx As for SetDirty() */
+  void SetDirtyRECT(const IRECT& bounds, bool triggerAction = false, int valIdx = kNoValIdx);
+
+  /** @return The region of the control that needs to be redrawn, the whole of mRECT unless SetDirtyRECT() has restricted it */
+  IRECT GetDirtyRECT() const { return (mDirty && !mDirtyRECT.Empty()) ? mDirtyRECT.Intersect(mRECT) : mRECT; }
+
   /* Set the control clean, i.e. Called by IGraphics draw loop after control has been drawn */
   virtual void SetClean() { mDirty = false; }
 
@@ -400,6 +411,14 @@ public:
    * @return \c true if the control is marked dirty. */
   virtual bool IsDirty();
 
+  /** Allow or prevent IGraphics caching this control's drawing in a layer, when the layer cache is enabled with IGraphics::EnableLayerCache().
+   * Controls that can draw something different without being marked dirty should not be cached
+   * @param cacheable \c true if the control can be cached */
+  void SetLayerCacheable(bool cacheable) { mLayerCacheable = cacheable; if (!cacheable) mCacheLayer = nullptr; }
+
+  /** @return \c true if the control can be cached by the IGraphics layer cache */
+  bool GetLayerCacheable() const { return mLayerCacheable; }
+
   /** Disable/enable right-clicking the control to prompt for user input /todo check this
    * @param disable \c true*/
   void DisablePrompt(bool disable) { mDisablePrompt = disable; }
@@ -531,6 +550,7 @@ protected:
   IBlend mBlend;
   int mTextEntryLength = DEFAULT_TEXT_ENTRY_LEN;
   bool mDirty = true;
+  IRECT mDirtyRECT; // empty if the whole control is dirty
   bool mHide = false;
   bool mDisabled = false;
   bool mDisablePrompt = true;
@@ -551,7 +571,15 @@ protected:
   void SetNVals(int nVals)
   {
     assert(nVals > 0);
+    const bool linked = mParamsLinked;
+
+    if (linked)
+      mGraphics->UnlinkControlParams(this);
+
     mVals.resize(nVals);
+
+    if (linked)
+      mGraphics->LinkControlParams(this);
   }
 
 #if defined VST3_API || defined VST3C_API
@@ -573,6 +601,12 @@ private:
   std::vector<ParamTuple> mVals { {kNoParameter, 0.} };
   std::unordered_map<EGestureType, IGestureFunc> mGestureFuncs;
   EGestureType mLastGesture = EGestureType::Unknown;
+  bool mParamsLinked = false; // true when the control is in the IGraphics control stack, and its values are in the parameter to control index
+  bool mLayerCacheable = true;
+  int mNCleanFrames = 0; // the number of frames since the control was last dirty, for the IGraphics layer cache
+  ILayerPtr mCacheLayer; // owned by the IGraphics layer cache
+
+  friend class IGraphics;
 };
 
 #pragma mark - Base Controls
@@ -1390,8 +1424,41 @@ public:
 
   void SetHighlightedTrack(int highlightIdx)
   {
+    if (highlightIdx != mHighlightedTrack)
+      SetTracksDirty(mHighlightedTrack, highlightIdx);
+
     mHighlightedTrack = highlightIdx;
-    SetDirty(false);
+  }
+
+  /** Mark the tracks from idx1 to idx2 dirty, so that only they are redrawn (see IControl::SetDirtyRECT()).
+   * An index of kNoValIdx is ignored, and if both are kNoValIdx the whole control is marked dirty
+   * @param idx1 The first track
+   * @param idx2 The last track, which can be before idx1
+   * @param triggerAction As for SetDirty() */
+  void SetTracksDirty(int idx1, int idx2, bool triggerAction = false)
+  {
+    const int nVals = NVals();
+    const bool valid1 = idx1 > kNoValIdx && idx1 < nVals;
+    const bool valid2 = idx2 > kNoValIdx && idx2 < nVals;
+
+    if (!valid1 && !valid2)
+    {
+      SetDirty(triggerAction);
+      return;
+    }
+
+    if (!valid1)
+      idx1 = idx2;
+    else if (!valid2)
+      idx2 = idx1;
+
+    SetDirtyRECT(GetTrackDirtyRECT(idx1).Union(GetTrackDirtyRECT(idx2)), triggerAction);
+  }
+
+  /** @return The region to redraw when a track changes: its bounds, padded for its frame */
+  IRECT GetTrackDirtyRECT(int trackIdx) const
+  {
+    return mTrackBounds.Get()[trackIdx].GetPadded(mStyle.frameThickness + 1.f);
   }
   
   void SetZeroValueStepHasBounds(bool val)
@@ -37,6 +37,8 @@ using VST3_API_BASE = iplug::IPlugVST3Controller;
 #include "ITextEntryControl.h"
 #include "IBubbleControl.h"
 
+#include <algorithm>
+
 using namespace iplug;
 using namespace igraphics;
 
@@ -61,6 +63,8 @@ IGraphics::IGraphics(IGEditorDelegate& dlg, int w, int h, int fps, float scale)
 
 IGraphics::~IGraphics()
 {
+  StopRenderThread();
+
 #ifdef IGRAPHICS_IMGUI
   mImGuiRenderer = nullptr;
 #endif
@@ -75,6 +79,7 @@ IGraphics::~IGraphics()
 
 void IGraphics::SetScreenScale(int scale)
 {
+  WaitForRenderThread();
   mScreenScale = scale;
   int windowWidth = WindowWidth() * GetPlatformWindowScale();
   int windowHeight = WindowHeight() * GetPlatformWindowScale();
@@ -87,6 +92,7 @@ void IGraphics::SetScreenScale(int scale)
 
 void IGraphics::Resize(int w, int h, float scale, bool needsPlatformResize)
 {
+  WaitForRenderThread();
   GetDelegate()->ConstrainEditorResize(w, h);
   
   scale = Clip(scale, mMinScale, mMaxScale);
@@ -107,6 +113,32 @@ void IGraphics::Resize(int w, int h, float scale, bool needsPlatformResize)
   int windowHeight = WindowHeight() * GetPlatformWindowScale();
     
   PlatformResize(GetDelegate()->EditorResizeFromUI(windowWidth, windowHeight, needsPlatformResize));
+
+  if (mResizingInProcess && mDeferLayoutDuringDragResize && mGUISizeMode == EUIResizerMode::Size)
+  {
+    const auto now = std::chrono::steady_clock::now();
+    const bool throttleElapsed = mDragResizeLayoutThrottleMs > 0 && now - mLastDragResizeLayoutTime >= std::chrono::milliseconds(mDragResizeLayoutThrottleMs);
+
+    if (!throttleElapsed)
+    {
+      // the controls keep their bounds until the layout is done, DrawDragResizePreview() stretches them to the new size
+      mDragResizeLayoutPending = true;
+      SetAllControlsDirty();
+      DrawResize();
+      return;
+    }
+  }
+
+  LayoutControlsForResize();
+}
+
+void IGraphics::LayoutControlsForResize()
+{
+  mDragResizeLayoutPending = false;
+  mDragResizePreview = nullptr;
+  mDragResizePreviewBounds = GetBounds();
+  mLastDragResizeLayoutTime = std::chrono::steady_clock::now();
+
   ForAllControls(&IControl::OnResize);
   SetAllControlsDirty();
   DrawResize();
@@ -120,15 +152,27 @@ void IGraphics::SetLayoutOnResize(bool layoutOnResize)
   mLayoutOnResize = layoutOnResize;
 }
 
+void IGraphics::SetDeferLayoutDuringDragResize(bool defer, int throttleMs)
+{
+  mDeferLayoutDuringDragResize = defer;
+  mDragResizeLayoutThrottleMs = throttleMs;
+}
+
 void IGraphics::RemoveControlWithTag(int ctrlTag)
 {
-  mControls.DeletePtr(GetControlWithTag(ctrlTag));
+  WaitForRenderThread();
+
+  IControl* pControl = GetControlWithTag(ctrlTag);
+  UnlinkControlParams(pControl);
+  mControls.DeletePtr(pControl);
   mCtrlTags.erase(ctrlTag);
   SetAllControlsDirty();
 }
 
 void IGraphics::RemoveControls(int fromIdx)
 {
+  WaitForRenderThread();
+
   int idx = NControls()-1;
   while (idx >= fromIdx)
   {
@@ -149,6 +193,7 @@ void IGraphics::RemoveControls(int fromIdx)
     if(pControl->GetTag() > kNoTag)
       mCtrlTags.erase(pControl->GetTag());
     
+    UnlinkControlParams(pControl);
     mControls.Delete(idx--, true);
   }
   
@@ -162,6 +207,8 @@ void IGraphics::RemoveControl(int idx)
 
 void IGraphics::RemoveControl(IControl* pControl)
 {
+  WaitForRenderThread();
+
   if(ControlIsCaptured(pControl))
     ReleaseMouseCapture();
   
@@ -177,6 +224,7 @@ void IGraphics::RemoveControl(IControl* pControl)
   if(pControl->GetTag() > kNoTag)
     mCtrlTags.erase(pControl->GetTag());
   
+  UnlinkControlParams(pControl);
   mControls.DeletePtr(pControl, true);
   
   SetAllControlsDirty();
@@ -184,6 +232,8 @@ void IGraphics::RemoveControl(IControl* pControl)
 
 void IGraphics::RemoveAllControls()
 {
+  WaitForRenderThread();
+
   ReleaseMouseCapture();
   ClearMouseOver();
 
@@ -199,6 +249,22 @@ void IGraphics::RemoveAllControls()
   mBubbleControls.Empty(true);
   
   mCtrlTags.clear();
+  mDeferredParamLinks.clear();
+
+  if (mParamLinksLoopDepth > 0)
+  {
+    // a ForControlWithParam() loop is still indexing the lists, blank them and leave EndParamLinksLoop() to empty them
+    for (auto& links : mParamLinks)
+    {
+      for (auto& link : links)
+        link.mControl = nullptr;
+    }
+
+    mParamLinksRemoved = true;
+  }
+  else
+    mParamLinks.clear();
+
   mControls.Empty(true);
 }
 
@@ -228,6 +294,8 @@ void IGraphics::SetControlBounds(int idx, const IRECT& r)
 
 void IGraphics::SetControlValueAfterTextEdit(const char* str)
 {
+  WaitForRenderThread();
+
   if (!mInTextEntry)
     return;
     
@@ -248,6 +316,8 @@ void IGraphics::SetControlValueAfterTextEdit(const char* str)
 
 void IGraphics::SetControlValueAfterPopupMenu(IPopupMenu* pMenu)
 {
+  WaitForRenderThread();
+
   if (!mInPopupMenu)
     return;
   
@@ -276,6 +346,7 @@ void IGraphics::AttachBackground(const char* fileName)
   IControl* pBG = new IBitmapControl(0, 0, LoadBitmap(fileName, 1, false), kNoParameter, EBlend::Default);
   pBG->SetDelegate(*GetDelegate());
   mControls.Insert(0, pBG);
+  LinkControlParams(pBG);
 }
 
 void IGraphics::AttachSVGBackground(const char* fileName)
@@ -283,6 +354,7 @@ void IGraphics::AttachSVGBackground(const char* fileName)
   IControl* pBG = new ISVGControl(GetBounds(), LoadSVG(fileName), true);
   pBG->SetDelegate(*GetDelegate());
   mControls.Insert(0, pBG);
+  LinkControlParams(pBG);
 }
 
 void IGraphics::AttachPanelBackground(const IPattern& color)
@@ -290,10 +362,13 @@ void IGraphics::AttachPanelBackground(const IPattern& color)
   IControl* pBG = new IPanelControl(GetBounds(), color);
   pBG->SetDelegate(*GetDelegate());
   mControls.Insert(0, pBG);
+  LinkControlParams(pBG);
 }
 
 IControl* IGraphics::AttachControl(IControl* pControl, int ctrlTag, const char* group)
 {
+  WaitForRenderThread();
+
   if(ctrlTag > kNoTag)
   {
     auto result = mCtrlTags.insert(std::make_pair(ctrlTag, pControl));
@@ -306,6 +381,7 @@ IControl* IGraphics::AttachControl(IControl* pControl, int ctrlTag, const char*
   pControl->SetDelegate(*GetDelegate());
   pControl->SetGroup(group);
   mControls.Add(pControl);
+  LinkControlParams(pControl);
     
   pControl->OnAttached();
   return pControl;
@@ -461,16 +537,152 @@ void IGraphics::DisableControl(int paramIdx, bool disable)
 
 void IGraphics::ForControlWithParam(int paramIdx, std::function<void(IControl& control)> func)
 {
-  for (auto c = 0; c < NControls(); c++)
+  if (paramIdx < 0 || paramIdx >= static_cast<int>(mParamLinks.size()))
+    return;
+
+  // func can attach, remove or re-link controls, so links are only blanked or queued until EndParamLinksLoop(), and the list is indexed rather than iterated
+  mParamLinksLoopDepth++;
+
+  const std::vector<ParamLink>& links = mParamLinks[paramIdx];
+  const size_t nLinks = links.size();
+
+  for (size_t i = 0; i < nLinks; i++)
   {
-    IControl* pControl = GetControl(c);
+    IControl* pControl = links[i].mControl;
+    bool visited = !pControl;
 
-    if (pControl->LinkedToParam(paramIdx) > kNoValIdx)
-    {
+    // a control with several values linked to the parameter should only be visited once, there are usually very few links so just look back
+    for (size_t j = 0; j < i && !visited; j++)
+      visited = links[j].mControl == pControl;
+
+    if (!visited)
       func(*pControl);
-      // Could be more than one, don't break until we check them all.
+
+    assert(links.size() == nLinks && "ForControlWithParam: the parameter links changed during the loop");
+  }
+
+  EndParamLinksLoop();
+}
+
+void IGraphics::ForControlValueWithParam(int paramIdx, std::function<void(IControl& control, int valIdx)> func)
+{
+  if (paramIdx < 0 || paramIdx >= static_cast<int>(mParamLinks.size()))
+    return;
+
+  mParamLinksLoopDepth++;
+
+  const std::vector<ParamLink>& links = mParamLinks[paramIdx];
+  const size_t nLinks = links.size();
+
+  for (size_t i = 0; i < nLinks; i++)
+  {
+    if (links[i].mControl)
+      func(*links[i].mControl, links[i].mValIdx);
+
+    assert(links.size() == nLinks && "ForControlValueWithParam: the parameter links changed during the loop");
+  }
+
+  EndParamLinksLoop();
+}
+
+void IGraphics::EndParamLinksLoop()
+{
+  assert(mParamLinksLoopDepth > 0);
+
+  if (--mParamLinksLoopDepth > 0)
+    return;
+
+  if (mParamLinksRemoved)
+  {
+    for (auto& links : mParamLinks)
+      links.erase(std::remove_if(links.begin(), links.end(), [](const ParamLink& link) { return !link.mControl; }), links.end());
+
+    mParamLinksRemoved = false;
+  }
+
+  for (const auto& deferred : mDeferredParamLinks)
+    AddParamLink(deferred.first, deferred.second.mControl, deferred.second.mValIdx);
+
+  mDeferredParamLinks.clear();
+}
+
+void IGraphics::AddParamLink(int paramIdx, IControl* pControl, int valIdx)
+{
+  if (mParamLinksLoopDepth > 0)
+  {
+    mDeferredParamLinks.push_back({paramIdx, {pControl, valIdx}});
+    return;
+  }
+
+  if (paramIdx >= static_cast<int>(mParamLinks.size()))
+    mParamLinks.resize(paramIdx + 1);
+
+  mParamLinks[paramIdx].push_back({pControl, valIdx});
+}
+
+void IGraphics::RemoveParamLinks(int paramIdx, IControl* pControl, int valIdx)
+{
+  auto matches = [pControl, valIdx](const ParamLink& link) { return link.mControl == pControl && (valIdx < 0 || link.mValIdx == valIdx); };
+
+  // a link queued during the running loop has not been added yet, so can just be dropped
+  mDeferredParamLinks.erase(std::remove_if(mDeferredParamLinks.begin(), mDeferredParamLinks.end(), [paramIdx, &matches](const std::pair<int, ParamLink>& deferred) {
+    return deferred.first == paramIdx && matches(deferred.second);
+  }), mDeferredParamLinks.end());
+
+  if (paramIdx <= kNoParameter || paramIdx >= static_cast<int>(mParamLinks.size()))
+    return;
+
+  std::vector<ParamLink>& links = mParamLinks[paramIdx];
+
+  if (mParamLinksLoopDepth > 0)
+  {
+    for (auto& link : links)
+    {
+      if (link.mControl && matches(link))
+      {
+        link.mControl = nullptr;
+        mParamLinksRemoved = true;
+      }
     }
   }
+  else
+    links.erase(std::remove_if(links.begin(), links.end(), matches), links.end());
+}
+
+void IGraphics::LinkControlParams(IControl* pControl)
+{
+  const int nVals = pControl->NVals();
+
+  for (auto v = 0; v < nVals; v++)
+  {
+    const int paramIdx = pControl->GetParamIdx(v);
+
+    if (paramIdx > kNoParameter)
+      AddParamLink(paramIdx, pControl, v);
+  }
+
+  pControl->mParamsLinked = true;
+}
+
+void IGraphics::UnlinkControlParams(IControl* pControl)
+{
+  if (!pControl || !pControl->mParamsLinked)
+    return;
+
+  const int nVals = pControl->NVals();
+
+  for (auto v = 0; v < nVals; v++)
+    RemoveParamLinks(pControl->GetParamIdx(v), pControl);
+
+  pControl->mParamsLinked = false;
+}
+
+void IGraphics::UpdateControlParamLink(IControl* pControl, int valIdx, int oldParamIdx, int newParamIdx)
+{
+  RemoveParamLinks(oldParamIdx, pControl, valIdx);
+
+  if (newParamIdx > kNoParameter)
+    AddParamLink(newParamIdx, pControl, valIdx);
 }
 
 void IGraphics::ForControlInGroup(const char* group, std::function<void(IControl& control)> func)
@@ -798,6 +1010,48 @@ void IGraphics::DrawData(const IColor& color, const IRECT& bounds, float* normYP
 
 bool IGraphics::IsDirty(IRECTList& rects)
 {
+  bool renderThreadNeedsPaint = false;
+  bool skipTick = false;
+
+  if (mRenderThread.joinable())
+  {
+    std::lock_guard<std::mutex> lock(mRenderMutex);
+
+    // the controls can't be animated or collected while they are being drawn, they stay dirty until a later tick
+    if (mRenderState == ERenderState::Rendering)
+    {
+      mRenderStats.mNTicksSkipped++;
+      return false;
+    }
+
+    if (mRenderState == ERenderState::Ready)
+    {
+      for (auto i = 0; i < mRenderRects.Size(); i++)
+        rects.Add(mRenderRects.Get(i));
+
+      renderThreadNeedsPaint = true;
+    }
+    else if (mRenderTicksToSkip > 0)
+    {
+      mRenderTicksToSkip--;
+      mRenderStats.mNTicksSkipped++;
+      skipTick = true;
+    }
+    else if (mPendingRenderRects.Size())
+    {
+      // regions that were collected while the frame rate was being reduced
+      renderThreadNeedsPaint = true;
+    }
+  }
+
+  // the render thread isn't drawing, so delegate messages that arrived while it was can reach the controls
+  SendQueuedDelegateMsgs();
+
+  if (skipTick)
+    return false;
+
+  const int nRenderedRects = rects.Size();
+
   if (mDisplayTickFunc)
     mDisplayTickFunc();
 
@@ -810,12 +1064,33 @@ bool IGraphics::IsDirty(IRECTList& rects)
     if (control.IsDirty())
     {
       // N.B padding outlines for single line outlines
-      rects.Add(control.GetRECT().GetPadded(0.75));
+      rects.Add(control.GetDirtyRECT().GetPadded(0.75));
       dirty = true;
     }
   };
     
-  ForAllControlsFunc(func);
+  if (mLayerCacheEnabled)
+  {
+    mLayerCacheStats = ILayerCacheStats();
+
+    ForAllControlsFunc([&](IControl& control) {
+      func(control);
+      UpdateLayerCache(control);
+    });
+  }
+  else
+    ForAllControlsFunc(func);
+
+  if (mRenderThread.joinable())
+  {
+    for (auto i = nRenderedRects; i < rects.Size(); i++)
+      mPendingRenderRects.Add(rects.Get(i));
+
+    if (renderThreadNeedsPaint && !rects.Size())
+      rects.Add(mPendingRenderRects.Bounds());
+
+    dirty |= renderThreadNeedsPaint;
+  }
 
 #ifdef USE_IDLE_CALLS
   if (dirty)
@@ -852,6 +1127,79 @@ void IGraphics::BeginFrame()
   }
 }
 
+void IGraphics::EnableLayerCache(bool enable, int staticFrames, size_t maxBytes)
+{
+  mLayerCacheEnabled = enable;
+  mLayerCacheStaticFrames = std::max(staticFrames, 1);
+  mLayerCacheMaxBytes = maxBytes;
+  mLayerCacheStats = ILayerCacheStats();
+
+  ForAllControlsFunc([](IControl& control) {
+    control.mNCleanFrames = 0;
+    control.mCacheLayer = nullptr;
+  });
+}
+
+void IGraphics::UpdateLayerCache(IControl& control)
+{
+  if (control.IsDirty())
+  {
+    control.mNCleanFrames = 0;
+
+    if (control.mCacheLayer)
+    {
+      control.mCacheLayer = nullptr;
+      mLayerCacheStats.mNInvalidated++;
+    }
+  }
+  else
+  {
+    if (control.mNCleanFrames < mLayerCacheStaticFrames)
+      control.mNCleanFrames++;
+
+    if (control.mCacheLayer)
+    {
+      const APIBitmap* pBitmap = control.mCacheLayer->GetAPIBitmap();
+      mLayerCacheStats.mNLayers++;
+      mLayerCacheStats.mBytes += static_cast<size_t>(pBitmap->GetWidth()) * pBitmap->GetHeight() * 4;
+    }
+  }
+}
+
+bool IGraphics::DrawCachedControl(IControl* pControl, const IRECT& controlBounds)
+{
+  if (!pControl->mLayerCacheable || pControl->mNCleanFrames < mLayerCacheStaticFrames || !mLayers.empty())
+    return false;
+
+  ILayerPtr& layer = pControl->mCacheLayer;
+
+  if (!CheckLayer(layer))
+  {
+    const float backingScale = GetBackingPixelScale();
+    const size_t bytes = static_cast<size_t>(std::ceil(controlBounds.W() * backingScale) * std::ceil(controlBounds.H() * backingScale)) * 4;
+
+    const bool isNew = !layer;
+
+    if (isNew && mLayerCacheStats.mBytes + bytes > mLayerCacheMaxBytes)
+      return false;
+
+    StartLayer(pControl, controlBounds, true);
+    pControl->Draw(*this);
+    layer = EndLayer();
+    mLayerCacheStats.mNCaptured++;
+
+    if (isNew)
+    {
+      mLayerCacheStats.mNLayers++;
+      mLayerCacheStats.mBytes += bytes;
+    }
+  }
+
+  DrawLayer(layer, nullptr);
+  mLayerCacheStats.mNHits++;
+  return true;
+}
+
 // Draw a control in a region if it needs to be drawn
 void IGraphics::DrawControl(IControl* pControl, const IRECT& bounds, float scale)
 {
@@ -865,7 +1213,15 @@ void IGraphics::DrawControl(IControl* pControl, const IRECT& bounds, float scale
       return;
     
     PrepareRegion(clipBounds);
-    pControl->Draw(*this);
+
+    if (!mLayerCacheEnabled)
+      pControl->Draw(*this);
+    else if (!DrawCachedControl(pControl, controlBounds))
+    {
+      pControl->Draw(*this);
+      mLayerCacheStats.mNMisses++;
+    }
+
 #ifdef AAX_API
     pControl->DrawPTHighlight(*this);
 #endif
@@ -902,12 +1258,27 @@ void IGraphics::Draw(IRECTList& rects)
 {
   if (!rects.Size())
     return;
-  
-  float scale = GetBackingPixelScale();
-    
+
+  if (mRenderThread.joinable())
+  {
+    DrawWithRenderThread();
+    return;
+  }
+
   BeginFrame();
-    
-  if (mStrict)
+  DrawRects(rects, GetBackingPixelScale());
+  EndFrame();
+}
+
+void IGraphics::DrawRects(IRECTList& rects, float scale)
+{
+  TRACE_DRAW_SCOPE;
+
+  if (mDragResizeLayoutPending)
+  {
+    DrawDragResizePreview(scale);
+  }
+  else if (mStrict)
   {
     IRECT r = rects.Bounds();
     r.PixelAlign(scale);
@@ -921,8 +1292,253 @@ void IGraphics::Draw(IRECTList& rects)
     for (auto i = 0; i < rects.Size(); i++)
       Draw(rects.Get(i), scale);
   }
-  
+
+  FlushDrawing();
+}
+
+bool IGraphics::EnableRenderThread(bool enable, int maxSkippedTicks)
+{
+  if (enable && !mRenderThread.joinable() && SupportsRenderThread())
+  {
+    mRenderState = ERenderState::Idle;
+    mRenderThreadQuit = false;
+    mMaxSkippedRenderTicks = std::max(maxSkippedTicks, 0);
+    mRenderTicksToSkip = 0;
+    mRenderStats = IRenderThreadStats();
+    mRenderThread = std::thread(&IGraphics::RenderThreadProc, this);
+  }
+  else if (!enable && mRenderThread.joinable())
+  {
+    {
+      std::lock_guard<std::mutex> lock(mRenderMutex);
+      mRenderThreadQuit = true;
+    }
+
+    mRenderCV.notify_all();
+    mRenderThread.join();
+    mRenderState = ERenderState::Idle;
+    mRenderRects.Clear();
+    mPendingRenderRects.Clear();
+    SendQueuedDelegateMsgs();
+    SetAllControlsDirty();
+  }
+
+  return mRenderThread.joinable();
+}
+
+IRenderThreadStats IGraphics::GetRenderThreadStats() const
+{
+  std::lock_guard<std::mutex> lock(mRenderMutex);
+  return mRenderStats;
+}
+
+ILayerCacheStats IGraphics::GetLayerCacheStats() const
+{
+  if (!mRenderThread.joinable())
+    return mLayerCacheStats;
+
+  std::lock_guard<std::mutex> lock(mRenderMutex);
+  return mRenderedLayerCacheStats;
+}
+
+bool IGraphics::RenderThreadIsDrawing() const
+{
+  if (!mRenderThread.joinable())
+    return false;
+
+  std::lock_guard<std::mutex> lock(mRenderMutex);
+  return mRenderState == ERenderState::Rendering;
+}
+
+bool IGraphics::QueueDelegateMsgs()
+{
+  // once one message is queued, the rest are queued behind it, so they reach the controls in order
+  return !mQueuedDelegateMsgs.empty() || RenderThreadIsDrawing();
+}
+
+void IGraphics::SendControlValueFromDelegate(int ctrlTag, double normalizedValue)
+{
+  // SetValueFromDelegate() marks the control dirty, which can change more than its value (e.g. the text of IVKnobControl's readout), so it waits for the frame like messages
+  if (QueueDelegateMsgs())
+  {
+    mQueuedDelegateMsgs.push_back({ QueuedDelegateMsg::EType::ControlValue, IMidiMsg(), ctrlTag, normalizedValue, 0, 0, 0 });
+    return;
+  }
+
+  IControl* pControl = GetControlWithTag(ctrlTag);
+
+  assert(pControl);
+
+  if (pControl)
+    pControl->SetValueFromDelegate(normalizedValue);
+}
+
+void IGraphics::SendParameterValueFromDelegate(int paramIdx, double normalizedValue)
+{
+  if (QueueDelegateMsgs())
+  {
+    mQueuedDelegateMsgs.push_back({ QueuedDelegateMsg::EType::ParameterValue, IMidiMsg(), paramIdx, normalizedValue, 0, 0, 0 });
+    return;
+  }
+
+  ForControlValueWithParam(paramIdx, [normalizedValue](IControl& control, int valIdx) {
+    control.SetValueFromDelegate(normalizedValue, valIdx);
+  });
+}
+
+void IGraphics::SendControlMsgFromDelegate(int ctrlTag, int msgTag, int dataSize, const void* pData)
+{
+  if (QueueDelegateMsgs())
+  {
+    const uint8_t* pBytes = reinterpret_cast<const uint8_t*>(pData);
+    mQueuedDelegateMsgs.push_back({ QueuedDelegateMsg::EType::ControlMsg, IMidiMsg(), ctrlTag, 0., msgTag, dataSize, mQueuedMsgData.size() });
+
+    if (dataSize > 0)
+      mQueuedMsgData.insert(mQueuedMsgData.end(), pBytes, pBytes + dataSize);
+
+    return;
+  }
+
+  IControl* pControl = GetControlWithTag(ctrlTag);
+
+  assert(pControl);
+
+  if (pControl)
+    pControl->OnMsgFromDelegate(msgTag, dataSize, pData);
+}
+
+void IGraphics::SendMidiMsgFromDelegate(const IMidiMsg& msg)
+{
+  if (QueueDelegateMsgs())
+  {
+    mQueuedDelegateMsgs.push_back({ QueuedDelegateMsg::EType::Midi, msg, kNoTag, 0., 0, 0, 0 });
+    return;
+  }
+
+  for (auto c = 0; c < NControls(); c++) // TODO: could keep a map
+  {
+    IControl* pControl = GetControl(c);
+
+    if (pControl->GetWantsMidi())
+      pControl->OnMidi(msg);
+  }
+}
+
+void IGraphics::SendQueuedDelegateMsgs()
+{
+  if (mQueuedDelegateMsgs.empty())
+    return;
+
+  // moved out first, so that the messages are sent rather than queued again
+  std::vector<QueuedDelegateMsg> msgs;
+  std::vector<uint8_t> data;
+  msgs.swap(mQueuedDelegateMsgs);
+  data.swap(mQueuedMsgData);
+
+  for (const QueuedDelegateMsg& msg : msgs)
+  {
+    switch (msg.mType)
+    {
+      case QueuedDelegateMsg::EType::ControlValue: SendControlValueFromDelegate(msg.mIdx, msg.mValue); break;
+      case QueuedDelegateMsg::EType::ParameterValue: SendParameterValueFromDelegate(msg.mIdx, msg.mValue); break;
+      case QueuedDelegateMsg::EType::ControlMsg: SendControlMsgFromDelegate(msg.mIdx, msg.mMsgTag, msg.mDataSize, msg.mDataSize > 0 ? data.data() + msg.mDataOffset : nullptr); break;
+      case QueuedDelegateMsg::EType::Midi: SendMidiMsgFromDelegate(msg.mMidiMsg); break;
+    }
+  }
+
+  // keep the storage for the next frame, unless a message handler queued more
+  if (mQueuedDelegateMsgs.empty())
+  {
+    msgs.clear();
+    data.clear();
+    msgs.swap(mQueuedDelegateMsgs);
+    data.swap(mQueuedMsgData);
+  }
+}
+
+void IGraphics::DoWaitForRenderThread()
+{
+  std::unique_lock<std::mutex> lock(mRenderMutex);
+
+  if (mRenderState == ERenderState::Rendering)
+  {
+    mRenderStats.mNWaits++;
+    mRenderCV.wait(lock, [this]() { return mRenderState != ERenderState::Rendering; });
+  }
+}
+
+void IGraphics::DrawWithRenderThread()
+{
+  // normally nothing is being drawn here, as IsDirty() doesn't ask for a paint while it is, but the platform can ask for one at any time (e.g. when the window is uncovered)
+  DoWaitForRenderThread();
+
+  // the back buffer is up to date, apart from the regions still waiting to be drawn, which will be blitted again when they are
   EndFrame();
+
+  std::lock_guard<std::mutex> lock(mRenderMutex);
+
+  if (mRenderState == ERenderState::Ready)
+  {
+    mRenderRects.Clear();
+    mRenderState = ERenderState::Idle;
+  }
+
+  if (mPendingRenderRects.Size() && mRenderTicksToSkip == 0)
+  {
+    BeginFrame();
+
+    for (auto i = 0; i < mPendingRenderRects.Size(); i++)
+      mRenderRects.Add(mPendingRenderRects.Get(i));
+
+    mPendingRenderRects.Clear();
+    mRenderState = ERenderState::Rendering;
+    mRenderCV.notify_all();
+  }
+}
+
+void IGraphics::RenderThreadProc()
+{
+  std::unique_lock<std::mutex> lock(mRenderMutex);
+
+  while (true)
+  {
+    mRenderCV.wait(lock, [this]() { return mRenderThreadQuit || mRenderState == ERenderState::Rendering; });
+
+    if (mRenderThreadQuit)
+      break;
+
+    // the main thread doesn't touch the drawing class, mRenderRects, mLayerCacheStats or the controls until the state changes
+    lock.unlock();
+    const auto start = std::chrono::steady_clock::now();
+    DrawRects(mRenderRects, GetBackingPixelScale());
+    const double renderMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    lock.lock();
+
+    // frame pacing: when a frame takes longer than a display tick, skip the ticks it overran by before starting the next one
+    mRenderTicksToSkip = std::min(static_cast<int>(renderMs * FPS() / 1000.), mMaxSkippedRenderTicks);
+    mRenderStats.mNFramesRendered++;
+    mRenderStats.mLastRenderMs = renderMs;
+    mRenderStats.mMeanRenderMs = mRenderStats.mNFramesRendered == 1 ? renderMs : (0.9 * mRenderStats.mMeanRenderMs) + (0.1 * renderMs);
+    mRenderedLayerCacheStats = mLayerCacheStats;
+    mRenderState = ERenderState::Ready;
+    mRenderCV.notify_all();
+  }
+}
+
+void IGraphics::DrawDragResizePreview(float scale)
+{
+  // the first frame of a deferred drag resize captures the controls, which are still laid out for the size the drag started at
+  if (!mDragResizePreview)
+  {
+    StartLayer(nullptr, mDragResizePreviewBounds);
+    Draw(mDragResizePreviewBounds, scale);
+    mDragResizePreview = EndLayer();
+  }
+
+  const IRECT bounds = GetBounds();
+  PrepareRegion(bounds);
+  DrawFittedLayer(mDragResizePreview, bounds, nullptr);
+  CompleteRegion(bounds);
 }
 
 void IGraphics::SetStrictDrawing(bool strict)
@@ -933,6 +1549,8 @@ void IGraphics::SetStrictDrawing(bool strict)
 
 void IGraphics::OnMouseDown(const std::vector<IMouseInfo>& points)
 {
+  WaitForRenderThread();
+
 //  Trace("IGraphics::OnMouseDown", __LINE__, "x:%0.2f, y:%0.2f, mod:LRSCA: %i%i%i%i%i", x, y, mod.L, mod.R, mod.S, mod.C, mod.A);
 
   bool singlePoint = points.size() == 1;
@@ -1034,6 +1652,8 @@ void IGraphics::OnMouseDown(const std::vector<IMouseInfo>& points)
 
 void IGraphics::OnMouseUp(const std::vector<IMouseInfo>& points)
 {
+  WaitForRenderThread();
+
 //  Trace("IGraphics::OnMouseUp", __LINE__, "x:%0.2f, y:%0.2f, mod:LRSCA: %i%i%i%i%i", x, y, mod.L, mod.R, mod.S, mod.C, mod.A);
   
   if (ControlIsCaptured())
@@ -1086,6 +1706,8 @@ void IGraphics::OnMouseUp(const std::vector<IMouseInfo>& points)
 
 void IGraphics::OnTouchCancelled(const std::vector<IMouseInfo>& points)
 {
+  WaitForRenderThread();
+
   if (ControlIsCaptured())
   {
     //work out which of mCapturedMap controls the cancel relates to
@@ -1111,6 +1733,8 @@ void IGraphics::OnTouchCancelled(const std::vector<IMouseInfo>& points)
 
 bool IGraphics::OnMouseOver(float x, float y, const IMouseMod& mod)
 {
+  WaitForRenderThread();
+
   Trace("IGraphics::OnMouseOver", __LINE__, "x:%0.2f, y:%0.2f, mod:LRSCA: %i%i%i%i%i",
         x, y, mod.L, mod.R, mod.S, mod.C, mod.A);
   
@@ -1138,6 +1762,8 @@ bool IGraphics::OnMouseOver(float x, float y, const IMouseMod& mod)
 
 void IGraphics::OnMouseOut()
 {
+  WaitForRenderThread();
+
   Trace("IGraphics::OnMouseOut", __LINE__, "");
 
   // Store the old cursor type so this gets restored when the mouse enters again
@@ -1148,6 +1774,8 @@ void IGraphics::OnMouseOut()
 
 void IGraphics::OnMouseDrag(const std::vector<IMouseInfo>& points)
 {
+  WaitForRenderThread();
+
   Trace("IGraphics::OnMouseDrag:", __LINE__, "x:%0.2f, y:%0.2f, dX:%0.2f, dY:%0.2f, mod:LRSCA: %i%i%i%i%i",
         points[0].x, points[0].y, points[0].dX, points[0].dY, points[0].ms.L, points[0].ms.R, points[0].ms.S, points[0].ms.C, points[0].ms.A);
 
@@ -1192,6 +1820,8 @@ void IGraphics::OnMouseDrag(const std::vector<IMouseInfo>& points)
 
 bool IGraphics::OnMouseDblClick(float x, float y, const IMouseMod& mod)
 {
+  WaitForRenderThread();
+
   Trace("IGraphics::OnMouseDblClick", __LINE__, "x:%0.2f, y:%0.2f, mod:LRSCA: %i%i%i%i%i",
         x, y, mod.L, mod.R, mod.S, mod.C, mod.A);
   
@@ -1228,6 +1858,8 @@ bool IGraphics::OnMouseDblClick(float x, float y, const IMouseMod& mod)
 
 void IGraphics::OnMouseWheel(float x, float y, const IMouseMod& mod, float d)
 {
+  WaitForRenderThread();
+
 #ifdef IGRAPHICS_IMGUI
     if(mImGuiRenderer)
     {
@@ -1243,6 +1875,8 @@ void IGraphics::OnMouseWheel(float x, float y, const IMouseMod& mod, float d)
 
 bool IGraphics::OnKeyDown(float x, float y, const IKeyPress& key)
 {
+  WaitForRenderThread();
+
   Trace("IGraphics::OnKeyDown", __LINE__, "x:%0.2f, y:%0.2f, key:%s",
         x, y, key.utf8);
 
@@ -1271,6 +1905,8 @@ bool IGraphics::OnKeyDown(float x, float y, const IKeyPress& key)
 
 bool IGraphics::OnKeyUp(float x, float y, const IKeyPress& key)
 {
+  WaitForRenderThread();
+
   Trace("IGraphics::OnKeyUp", __LINE__, "x:%0.2f, y:%0.2f, key:%s",
         x, y, key.utf8);
   
@@ -1299,6 +1935,8 @@ bool IGraphics::OnKeyUp(float x, float y, const IKeyPress& key)
 
 void IGraphics::OnDrop(const char* str, float x, float y)
 {
+  WaitForRenderThread();
+
   IControl* pControl = GetMouseControl(x, y, false);
   if (pControl) pControl->OnDrop(str);
 }
@@ -1487,6 +2125,10 @@ void IGraphics::PopupHostContextMenuForParam(int controlIdx, int paramIdx, float
 
 void IGraphics::OnGUIIdle()
 {
+  // like display ticks, idle ticks are skipped while a frame is being drawn, rather than waiting for it
+  if (RenderThreadIsDrawing())
+    return;
+
   TRACE
 
   ForAllControls(&IControl::OnGUIIdle);
@@ -1961,9 +2603,19 @@ void IGraphics::CreatePopupMenu(IControl& control, IPopupMenu& menu, const IRECT
   DoCreatePopupMenu(control, menu, bounds, valIdx, false);
 }
 
+void IGraphics::StartDragResize()
+{
+  mResizingInProcess = true;
+  mDragResizePreviewBounds = GetBounds();
+  mLastDragResizeLayoutTime = std::chrono::steady_clock::now();
+}
+
 void IGraphics::EndDragResize()
 {
   mResizingInProcess = false;
+
+  if (mDragResizeLayoutPending)
+    LayoutControlsForResize();
   
   if (GetResizerMode() == EUIResizerMode::Scale)
   {
@@ -2341,6 +2993,8 @@ bool IGraphics::RespondsToGesture(float x, float y)
 
 void IGraphics::OnGestureRecognized(const IGestureInfo& info)
 {
+  WaitForRenderThread();
+
   IControl* pControl = GetMouseControl(info.x, info.y, false, false);
 
   if(pControl && pControl->GetWantsGestures())
@@ -54,7 +54,12 @@
 #endif
 
 #include <stack>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <unordered_map>
 
@@ -98,9 +103,16 @@ public:
   /** Called after a platform view is destroyed, so that drawing classes can e.g. free any resources */
   virtual void OnViewDestroyed() {};
 
+  /** @return \c true if the drawing class can draw on a thread other than the main thread, see EnableRenderThread() */
+  virtual bool SupportsRenderThread() const { return false; }
+
   /** Called by some drawing API classes to finally blit the draw bitmap onto the screen or perform other cleanup after drawing */
   virtual void EndFrame() {};
 
+  /** Called when all the dirty regions of a frame have been drawn, before EndFrame(), for drawing classes that defer some of their drawing.
+   * With a render thread (see EnableRenderThread()) it is called on the render thread, while EndFrame() is called on the main thread */
+  virtual void FlushDrawing() {};
+
   /** Draw an SVG image to the graphics context
    * @param svg The SVG image to the graphics context
    * @param bounds The rectangular region to draw the image in
@@ -734,6 +746,13 @@ public:
   /** Clip the current path to a particular region
    * @param r The rectangular region to clip */
   virtual void PathClipRegion(const IRECT r = IRECT()) {}
+
+  /** Test whether something drawn within some bounds would be entirely clipped away, because it's outside the region that is being drawn (see IControl::SetDirtyRECT()).
+   * The drawing primitives use this to skip geometry before it is tessellated or rasterized, and controls can use it to skip drawing parts of themselves
+   * @param bounds The bounds of the drawing, in the current path transform
+   * @param pad Extra space around the bounds, e.g. for a stroke's thickness
+   * @return \c true if nothing within the bounds would be visible */
+  virtual bool IsClippedOut(const IRECT& bounds, float pad = 0.f) const { return false; }
   
 private:
   /** Prepare a particular area of the display for drawing, normally resulting in clipping of the region.
@@ -1011,6 +1030,12 @@ public:
   /* Enables layout on resize. This means IGEditorDelegate:LayoutUI() will be called when the GUI is resized */
   void SetLayoutOnResize(bool layoutOnResize);
 
+  /** Defer the per-control work of a resize (IControl::OnResize() and IGEditorDelegate::LayoutUI()) while the corner resizer is being dragged in EUIResizerMode::Size.
+   * In the meantime, the UI as it was when the drag started is drawn stretched to the new size, from a layer that is captured once. The layout is done when the drag ends.
+   * @param defer \c true to defer the layout
+   * @param throttleMs If greater than 0, the layout is also done during the drag, but no more than once every throttleMs milliseconds */
+  void SetDeferLayoutDuringDragResize(bool defer, int throttleMs = 0);
+
   /** Gets the width of the graphics context
    * @return A whole number representing the width of the graphics context in pixels on a 1:1 screen */
   int Width() const { return mWidth; }
@@ -1109,6 +1134,51 @@ public:
   /**@return \c true if showning the control bounds */
   bool ShowControlBoundsEnabled() const { return mShowControlBounds; }
   
+  /** Enable a retained-mode cache of the drawing of controls that haven't changed for a while. A control that hasn't been dirty for staticFrames frames is drawn once into a layer,
+   * and that layer is composited whenever a dirty region overlaps the control, rather than drawing the control again (e.g. a static panel under an animated meter).
+   * A control's layer is released when it is marked dirty, and redrawn when its bounds or the scale change. Use IControl::SetLayerCacheable() to exclude controls whose drawing can change without SetDirty()
+   * @param enable Set \c true to enable the cache
+   * @param staticFrames The number of frames a control has to be clean for before it is cached
+   * @param maxBytes No more layers are cached when the cached layers use this much memory */
+  void EnableLayerCache(bool enable, int staticFrames = 30, size_t maxBytes = 64 * 1024 * 1024);
+
+  /** @return \c true if the layer cache is enabled */
+  bool LayerCacheEnabled() const { return mLayerCacheEnabled; }
+
+  /** @return The layer cache statistics for the last frame */
+  ILayerCacheStats GetLayerCacheStats() const;
+
+  /** Rasterize frames on a background thread, so that drawing doesn't hold up the main thread, which is also the host's UI thread.
+   * Only for drawing backends that rasterize into an offscreen bitmap on the CPU (IGraphicsLice and IGraphicsAGG). The dirty regions are drawn into the back buffer on the render thread,
+   * and the main thread only blits finished frames. While a frame is being drawn, display and idle ticks are skipped, parameter and control values, control messages and MIDI from the delegate
+   * are queued until it is finished, and events wait for it to finish before they reach the controls. Code that changes controls from elsewhere on the main thread must call WaitForRenderThread() first.
+   * When frames take longer than the display tick, further ticks are skipped in proportion, reducing the frame rate rather than queuing frames
+   * @param enable Set \c true to start the render thread, \c false to stop it
+   * @param maxSkippedTicks The most display ticks to skip after each frame, when frames are slow
+   * @return \c true if the render thread is running */
+  bool EnableRenderThread(bool enable, int maxSkippedTicks = 4);
+
+  /** @return \c true if frames are drawn on a background thread */
+  bool RenderThreadEnabled() const { return mRenderThread.joinable(); }
+
+  /** Wait for the render thread to finish drawing, if it is. Call this before changing controls from the main thread, outside of IGraphics events and IGEditorDelegate messages */
+  void WaitForRenderThread() { if (mRenderThread.joinable()) DoWaitForRenderThread(); }
+
+  /** Called by IGEditorDelegate to set the value of the control with ctrlTag. If the render thread is drawing, the value is queued and set once the frame is finished */
+  void SendControlValueFromDelegate(int ctrlTag, double normalizedValue);
+
+  /** Called by IGEditorDelegate to set the values of the controls linked to a parameter. If the render thread is drawing, the value is queued and set once the frame is finished */
+  void SendParameterValueFromDelegate(int paramIdx, double normalizedValue);
+
+  /** Called by IGEditorDelegate to send a message to the control with ctrlTag. If the render thread is drawing, the message is queued and sent once the frame is finished */
+  void SendControlMsgFromDelegate(int ctrlTag, int msgTag, int dataSize, const void* pData);
+
+  /** Called by IGEditorDelegate to send a MIDI message to the controls that want MIDI. If the render thread is drawing, the message is queued and sent once the frame is finished */
+  void SendMidiMsgFromDelegate(const IMidiMsg& msg);
+
+  /** @return The render thread statistics */
+  IRenderThreadStats GetRenderThreadStats() const;
+
   /** Live edit mode allows you to relocate controls at runtime in debug builds
    * @param enable Set \c true if you wish to enable live editing mode */
   void EnableLiveEdit(bool enable);
@@ -1166,6 +1236,29 @@ private:
    * @param bounds /todo
    * @param scale /todo */
   void DrawControl(IControl* pControl, const IRECT& bounds, float scale);
+
+  /** Draw the dirty regions of a frame, between BeginFrame() and EndFrame() */
+  void DrawRects(IRECTList& rects, float scale);
+
+  /** Blit the last frame drawn by the render thread, and hand it any regions waiting to be drawn */
+  void DrawWithRenderThread();
+
+  void DoWaitForRenderThread();
+  void RenderThreadProc();
+  bool RenderThreadIsDrawing() const;
+
+  /** @return \c true if the render thread is drawing a frame, or there are delegate messages queued from when it was */
+  bool QueueDelegateMsgs();
+
+  /** Send the delegate messages that arrived while the last frame was being drawn */
+  void SendQueuedDelegateMsgs();
+
+  /** Update a control's layer cache state, once per frame, when the layer cache is enabled */
+  void UpdateLayerCache(IControl& control);
+
+  /** Draw a control from its cached layer, drawing the layer first if needed
+   * @return \c false if the control can't be cached, and should be drawn directly */
+  bool DrawCachedControl(IControl* pControl, const IRECT& controlBounds);
   
   /** Shows a pop up/contextual menu in relation to a rectangular region of the graphics context
    * @param control A reference to the IControl creating this pop-up menu. If it exists IControl::OnPopupMenuSelection() will be called on successful selection
@@ -1176,11 +1269,17 @@ private:
   void DoCreatePopupMenu(IControl& control, IPopupMenu& menu, const IRECT& bounds, int valIdx, bool isContext);
   
   /** Called by ICornerResizer when drag resize commences */
-  void StartDragResize() { mResizingInProcess = true; }
+  void StartDragResize();
   
   /** Called when drag resize ends */
   void EndDragResize();
 
+  /** Resize and lay out all the controls for the current size, after a resize */
+  void LayoutControlsForResize();
+
+  /** Draw the stretched snapshot of the UI, while the layout is being deferred during a drag resize */
+  void DrawDragResizePreview(float scale);
+
 #pragma mark - Control management
 public:
   /** For all controls, including the "special controls" call a method
@@ -1206,8 +1305,14 @@ public:
 
   /** For all standard controls in the main control stack that are linked to a specific parameter, execute a function
    * @param paramIdx The parameter index to match
-   * @param func A std::function to perform on each control */
+   * @param func A std::function to perform on each control. It may attach, remove or re-link controls, the parameter links are only updated once the loop is done */
   void ForControlWithParam(int paramIdx, std::function<void(IControl& control)> func);
+
+  /** For every value of the standard controls in the main control stack that is linked to a specific parameter, execute a function.
+   * Unlike ForControlWithParam(), a control with several values linked to the same parameter is visited once per value
+   * @param paramIdx The parameter index to match
+   * @param func A std::function to perform on each control and value index. As with ForControlWithParam(), link changes it makes are deferred until the loop is done */
+  void ForControlValueWithParam(int paramIdx, std::function<void(IControl& control, int valIdx)> func);
   
   /** For all standard controls in the main control stack that are linked to a group, execute a function
    * @param group CString specificying the goupd name
@@ -1680,9 +1785,37 @@ private:
     mMouseOver = nullptr;
     mMouseOverIdx = -1;
   }
-  
+
+  /** Add the values of a control in the main control stack to the parameter to control index */
+  void LinkControlParams(IControl* pControl);
+
+  /** Remove the values of a control from the parameter to control index, before it is removed from the main control stack */
+  void UnlinkControlParams(IControl* pControl);
+
+  /** Called by IControl::SetParamIdx() when an attached control's value is linked to a different parameter */
+  void UpdateControlParamLink(IControl* pControl, int valIdx, int oldParamIdx, int newParamIdx);
+
+  struct ParamLink
+  {
+    IControl* mControl; // nullptr for a link removed while a ForControlWithParam() loop was running, erased when the loop ends
+    int mValIdx;
+  };
+
+  /** Add a link, or queue it if a ForControlWithParam() loop is running, as adding can reallocate the lists being iterated */
+  void AddParamLink(int paramIdx, IControl* pControl, int valIdx);
+
+  /** Remove the links matching pControl (and valIdx, if it is not -1) from a parameter's list, or blank them if a ForControlWithParam() loop is running */
+  void RemoveParamLinks(int paramIdx, IControl* pControl, int valIdx = -1);
+
+  /** Called when a ForControlWithParam() loop ends, applies the link changes made during the outermost loop */
+  void EndParamLinksLoop();
+
   WDL_PtrList<IControl> mControls;
   std::unordered_map<int, IControl*> mCtrlTags;
+  std::vector<std::vector<ParamLink>> mParamLinks; // indexed by paramIdx, the control values linked to each parameter, so a parameter change doesn't have to search all the controls
+  std::vector<std::pair<int, ParamLink>> mDeferredParamLinks; // links added while a ForControlWithParam() loop was running
+  int mParamLinksLoopDepth = 0;
+  bool mParamLinksRemoved = false;
 
   // Order (front-to-back) ToolTip / PopUp / TextEntry / LiveEdit / Corner / PerfDisplay
   std::unique_ptr<ICornerResizerControl> mCornerResizer;
@@ -1728,6 +1861,45 @@ private:
   bool mShowAreaDrawn = false;
   bool mResizingInProcess = false;
   bool mLayoutOnResize = false;
+  bool mDeferLayoutDuringDragResize = false;
+  std::atomic<bool> mDragResizeLayoutPending { false }; // the controls are still laid out for mDragResizePreviewBounds, read by the render thread
+  int mDragResizeLayoutThrottleMs = 0;
+  std::chrono::steady_clock::time_point mLastDragResizeLayoutTime;
+  IRECT mDragResizePreviewBounds;
+  ILayerPtr mDragResizePreview;
+  bool mLayerCacheEnabled = false;
+  int mLayerCacheStaticFrames = 30;
+  size_t mLayerCacheMaxBytes = 0;
+  ILayerCacheStats mLayerCacheStats; // only touched by the thread drawing the frame
+  ILayerCacheStats mRenderedLayerCacheStats; // the stats of the last frame drawn on the render thread, guarded by mRenderMutex
+
+  enum class ERenderState { Idle, Rendering, Ready };
+  std::thread mRenderThread;
+  mutable std::mutex mRenderMutex;
+  std::condition_variable mRenderCV;
+  ERenderState mRenderState = ERenderState::Idle; // Rendering and Ready are guarded by mRenderMutex
+  bool mRenderThreadQuit = false;
+  int mMaxSkippedRenderTicks = 4;
+  int mRenderTicksToSkip = 0;
+  IRECTList mPendingRenderRects; // dirty regions waiting to be drawn, main thread only
+  IRECTList mRenderRects; // the regions being drawn, or drawn and waiting to be blitted
+  IRenderThreadStats mRenderStats;
+
+  struct QueuedDelegateMsg
+  {
+    enum class EType { ControlValue, ParameterValue, ControlMsg, Midi };
+
+    EType mType;
+    IMidiMsg mMidiMsg;
+    int mIdx; // the control tag, or the parameter index for ParameterValue
+    double mValue;
+    int mMsgTag;
+    int mDataSize;
+    size_t mDataOffset; // in mQueuedMsgData
+  };
+
+  std::vector<QueuedDelegateMsg> mQueuedDelegateMsgs; // delegate messages that arrived while a frame was being drawn, main thread only
+  std::vector<uint8_t> mQueuedMsgData;
   bool mEnableMultiTouch = false;
   EUIResizerMode mGUISizeMode = EUIResizerMode::Scale;
   double mPrevTimestamp = 0.;
@@ -1735,6 +1907,9 @@ private:
   IDisplayTickFunc mDisplayTickFunc = nullptr;
 
 protected:
+  /** Stop the render thread. Drawing classes that support it must call this in their destructor, before the offscreen bitmap is freed */
+  void StopRenderThread() { EnableRenderThread(false); }
+
   IGEditorDelegate* mDelegate;
   void* mPlatformContext = nullptr;
   bool mCursorHidden = false;
@@ -1745,6 +1920,7 @@ protected:
   float mXTranslation = 0.f;
   float mYTranslation = 0.f;
   
+  friend class IControl;
   friend class IGraphicsLiveEdit;
   friend class ICornerResizerControl;
   friend class ITextEntryControl;
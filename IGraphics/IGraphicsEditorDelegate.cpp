@@ -70,14 +70,7 @@ void IGEditorDelegate::SendControlValueFromDelegate(int ctrlTag, double normaliz
   if(!mGraphics)
     return;
 
-  IControl* pControl = mGraphics->GetControlWithTag(ctrlTag);
-  
-  assert(pControl);
-  
-  if(pControl)
-  {
-    pControl->SetValueFromDelegate(normalizedValue);
-  }
+  mGraphics->SendControlValueFromDelegate(ctrlTag, normalizedValue);
 }
 
 void IGEditorDelegate::SendControlMsgFromDelegate(int ctrlTag, int msgTag, int dataSize, const void* pData)
@@ -85,14 +78,7 @@ void IGEditorDelegate::SendControlMsgFromDelegate(int ctrlTag, int msgTag, int d
   if(!mGraphics)
     return;
   
-  IControl* pControl = mGraphics->GetControlWithTag(ctrlTag);
-  
-  assert(pControl);
-  
-  if(pControl)
-  {
-    pControl->OnMsgFromDelegate(msgTag, dataSize, pData);
-  }
+  mGraphics->SendControlMsgFromDelegate(ctrlTag, msgTag, dataSize, pData);
 }
 
 void IGEditorDelegate::SendParameterValueFromDelegate(int paramIdx, double value, bool normalized)
@@ -102,22 +88,7 @@ void IGEditorDelegate::SendParameterValueFromDelegate(int paramIdx, double value
     if (!normalized)
       value = GetParam(paramIdx)->ToNormalized(value);
 
-    for (int c = 0; c < mGraphics->NControls(); c++)
-    {
-      IControl* pControl = mGraphics->GetControl(c);
-      
-      int nVals = pControl->NVals();
-      
-      for(int v = 0; v < nVals; v++)
-      {
-        if (pControl->GetParamIdx(v) == paramIdx)
-        {
-          pControl->SetValueFromDelegate(value, v);
-          // Could be more than one, don't break until we check them all.
-        }
-      }
-
-    }
+    mGraphics->SendParameterValueFromDelegate(paramIdx, value);
   }
   
   IEditorDelegate::SendParameterValueFromDelegate(paramIdx, value, normalized);
@@ -126,17 +97,7 @@ void IGEditorDelegate::SendParameterValueFromDelegate(int paramIdx, double value
 void IGEditorDelegate::SendMidiMsgFromDelegate(const IMidiMsg& msg)
 {
   if(mGraphics)
-  {
-    for (auto c = 0; c < mGraphics->NControls(); c++) // TODO: could keep a map
-    {
-      IControl* pControl = mGraphics->GetControl(c);
-      
-      if (pControl->GetWantsMidi())
-      {
-        pControl->OnMidi(msg);
-      }
-    }
-  }
+    mGraphics->SendMidiMsgFromDelegate(msg);
   
   IEditorDelegate::SendMidiMsgFromDelegate(msg);
 }
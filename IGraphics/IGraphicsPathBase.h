@@ -54,6 +54,9 @@ public:
   
   void DrawLine(const IColor& color, float x1, float y1, float x2, float y2, const IBlend* pBlend, float thickness) override
   {
+    if (IsClippedOut(IRECT(std::min(x1, x2), std::min(y1, y2), std::max(x1, x2), std::max(y1, y2)), thickness))
+      return;
+
     PathClear();
     PathMoveTo(x1, y1);
     PathLineTo(x2, y2);
@@ -62,6 +65,9 @@ public:
   
   void DrawGrid(const IColor& color, const IRECT& bounds, float gridSizeH, float gridSizeV, const IBlend* pBlend, float thickness) override
   {
+    if (IsClippedOut(bounds, thickness))
+      return;
+
     PathClear();
 
     // Vertical Lines grid
@@ -88,6 +94,9 @@ public:
   
   void DrawData(const IColor& color, const IRECT& bounds, float* normYPoints, int nPoints, float* normXPoints, const IBlend* pBlend, float thickness) override
   {
+    if (IsClippedOut(bounds, thickness))
+      return;
+
     PathClear();
     
     float xPos = bounds.L;
@@ -109,6 +118,9 @@ public:
   
   void DrawDottedLine(const IColor& color, float x1, float y1, float x2, float y2, const IBlend* pBlend, float thickness, float dashLen) override
   {
+    if (IsClippedOut(IRECT(std::min(x1, x2), std::min(y1, y2), std::max(x1, x2), std::max(y1, y2)), thickness))
+      return;
+
     PathClear();
     
     IStrokeOptions options;
@@ -127,6 +139,9 @@ public:
   
   void DrawRect(const IColor& color, const IRECT& bounds, const IBlend* pBlend, float thickness) override
   {
+    if (IsClippedOut(bounds, thickness))
+      return;
+
     PathClear();
     PathRect(bounds);
     PathStroke(color, thickness, IStrokeOptions(), pBlend);
@@ -134,6 +149,9 @@ public:
   
   void DrawRoundRect(const IColor& color, const IRECT& bounds, float cornerRadius, const IBlend* pBlend, float thickness) override
   {
+    if (IsClippedOut(bounds, thickness))
+      return;
+
     PathClear();
     PathRoundRect(bounds, cornerRadius);
     PathStroke(color, thickness, IStrokeOptions(), pBlend);
@@ -141,6 +159,9 @@ public:
   
   void DrawRoundRect(const IColor& color, const IRECT& bounds, float cRTL, float cRTR, float cRBR, float cRBL, const IBlend* pBlend, float thickness) override
   {
+    if (IsClippedOut(bounds, thickness))
+      return;
+
     PathClear();
     PathRoundRect(bounds, cRTL, cRTR, cRBR, cRBL);
     PathStroke(color, thickness, IStrokeOptions(), pBlend);
@@ -155,6 +176,9 @@ public:
   
   void DrawArc(const IColor& color, float cx, float cy, float r, float a1, float a2, const IBlend* pBlend, float thickness) override
   {
+    if (IsClippedOut(IRECT(cx - r, cy - r, cx + r, cy + r), thickness))
+      return;
+
     PathClear();
     PathArc(cx, cy, r, a1, a2);
     PathStroke(color, thickness, IStrokeOptions(), pBlend);
@@ -162,6 +186,9 @@ public:
   
   void DrawCircle(const IColor& color, float cx, float cy, float r, const IBlend* pBlend, float thickness) override
   {
+    if (IsClippedOut(IRECT(cx - r, cy - r, cx + r, cy + r), thickness))
+      return;
+
     PathClear();
     PathCircle(cx, cy, r);
     PathStroke(color, thickness, IStrokeOptions(), pBlend);
@@ -169,6 +196,9 @@ public:
   
   void DrawDottedRect(const IColor& color, const IRECT& bounds, const IBlend* pBlend, float thickness, float dashLen) override
   {
+    if (IsClippedOut(bounds, thickness))
+      return;
+
     PathClear();
     IStrokeOptions options;
     options.mDash.SetDash(&dashLen, 0., 1);
@@ -178,6 +208,9 @@ public:
   
   void DrawEllipse(const IColor& color, const IRECT& bounds, const IBlend* pBlend, float thickness) override
   {
+    if (IsClippedOut(bounds, thickness))
+      return;
+
     PathClear();
     PathEllipse(bounds);
     PathStroke(color, thickness, IStrokeOptions(), pBlend);
@@ -192,6 +225,9 @@ public:
 
   void FillTriangle(const IColor& color, float x1, float y1, float x2, float y2, float x3, float y3, const IBlend* pBlend) override
   {
+    if (IsClippedOut(IRECT(std::min({x1, x2, x3}), std::min({y1, y2, y3}), std::max({x1, x2, x3}), std::max({y1, y2, y3}))))
+      return;
+
     PathClear();
     PathTriangle(x1, y1, x2, y2, x3, y3);
     PathFill(color, IFillOptions(), pBlend);
@@ -199,6 +235,9 @@ public:
   
   void FillRect(const IColor& color, const IRECT& bounds, const IBlend* pBlend) override
   {
+    if (IsClippedOut(bounds))
+      return;
+
     PathClear();
     PathRect(bounds);
     PathFill(color, IFillOptions(), pBlend);
@@ -206,6 +245,9 @@ public:
   
   void FillRoundRect(const IColor& color, const IRECT& bounds, float cornerRadius, const IBlend* pBlend) override
   {
+    if (IsClippedOut(bounds))
+      return;
+
     PathClear();
     PathRoundRect(bounds, cornerRadius);
     PathFill(color, IFillOptions(), pBlend);
@@ -213,6 +255,9 @@ public:
   
   void FillRoundRect(const IColor& color, const IRECT& bounds, float cRTL, float cRTR, float cRBR, float cRBL, const IBlend* pBlend) override
   {
+    if (IsClippedOut(bounds))
+      return;
+
     PathClear();
     PathRoundRect(bounds, cRTL, cRTR, cRBR, cRBL);
     PathFill(color, IFillOptions(), pBlend);
@@ -227,6 +272,9 @@ public:
   
   void FillArc(const IColor& color, float cx, float cy, float r, float a1, float a2, const IBlend* pBlend) override
   {
+    if (IsClippedOut(IRECT(cx - r, cy - r, cx + r, cy + r)))
+      return;
+
     PathClear();
     PathMoveTo(cx, cy);
     PathArc(cx, cy, r, a1, a2);
@@ -236,6 +284,9 @@ public:
   
   void FillCircle(const IColor& color, float cx, float cy, float r, const IBlend* pBlend) override
   {
+    if (IsClippedOut(IRECT(cx - r, cy - r, cx + r, cy + r)))
+      return;
+
     PathClear();
     PathCircle(cx, cy, r);
     PathFill(color, IFillOptions(), pBlend);
@@ -243,6 +294,9 @@ public:
   
   void FillEllipse(const IColor& color, const IRECT& bounds, const IBlend* pBlend) override
   {
+    if (IsClippedOut(bounds))
+      return;
+
     PathClear();
     PathEllipse(bounds);
     PathFill(color, IFillOptions(), pBlend);
@@ -395,6 +449,31 @@ public:
     PathTransformSetMatrix(mTransform);
   }
 
+  bool IsClippedOut(const IRECT& bounds, float pad = 0.f) const override
+  {
+    // layers are drawn outside the region being drawn, and are clipped to their own bounds
+    if (!mLayers.empty() || mClipRECT.Empty())
+      return false;
+
+    // the bounds of the transformed corners, padded for strokes and antialiasing
+    const double xs[4] = {bounds.L, bounds.R, bounds.L, bounds.R};
+    const double ys[4] = {bounds.T, bounds.T, bounds.B, bounds.B};
+    double xMin = 1e30, yMin = 1e30, xMax = -1e30, yMax = -1e30;
+
+    for (auto i = 0; i < 4; i++)
+    {
+      double x, y;
+      mTransform.TransformPoint(x, y, xs[i], ys[i]);
+      xMin = std::min(xMin, x);
+      yMin = std::min(yMin, y);
+      xMax = std::max(xMax, x);
+      yMax = std::max(yMax, y);
+    }
+
+    const double p = pad + 1.0;
+    return xMax + p < mClipRECT.L || xMin - p > mClipRECT.R || yMax + p < mClipRECT.T || yMin - p > mClipRECT.B;
+  }
+
   void PathClipRegion(const IRECT r = IRECT()) override
   {
     IRECT drawArea = mLayers.empty() ? mClipRECT : mLayers.top()->Bounds();
@@ -406,6 +485,9 @@ public:
   
   void DrawFittedBitmap(const IBitmap& bitmap, const IRECT& bounds, const IBlend* pBlend) override
   {
+    if (IsClippedOut(bounds))
+      return;
+
     PathTransformSave();
     PathTransformTranslate(bounds.L, bounds.T);
     IRECT newBounds(0., 0., static_cast<float>(bitmap.W()), static_cast<float>(bitmap.H()));
@@ -416,6 +498,9 @@ public:
   
   void DrawSVG(const ISVG& svg, const IRECT& dest, const IBlend* pBlend) override
   {
+    if (IsClippedOut(dest))
+      return;
+
     float xScale = dest.W() / svg.W();
     float yScale = dest.H() / svg.H();
     float scale = xScale < yScale ? xScale : yScale;
@@ -2317,6 +2317,27 @@ private:
 /** ILayerPtr is a managed pointer for transferring the ownership of layers */
 using ILayerPtr = std::unique_ptr<ILayer>;
 
+/** Statistics for the retained layer cache, see IGraphics::EnableLayerCache() */
+struct ILayerCacheStats
+{
+  int mNHits = 0; // controls drawn from their cached layer in the last frame
+  int mNMisses = 0; // controls drawn directly in the last frame
+  int mNCaptured = 0; // layers (re)drawn in the last frame
+  int mNInvalidated = 0; // layers released in the last frame, because their control was dirty
+  int mNLayers = 0; // cached layers in total
+  size_t mBytes = 0; // approximate memory used by the cached layers
+};
+
+/** Statistics for the background render thread, see IGraphics::EnableRenderThread() */
+struct IRenderThreadStats
+{
+  int mNFramesRendered = 0;
+  int mNTicksSkipped = 0; // display ticks that didn't start a frame, because a frame was still being drawn or the frame rate was being reduced
+  int mNWaits = 0; // times the main thread had to wait for a frame to finish before changing the controls
+  double mLastRenderMs = 0.;
+  double mMeanRenderMs = 0.; // exponential moving average
+};
+
 /** Used to specify a gaussian drop-shadow. */
 struct IShadow
 {
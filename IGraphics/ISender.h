@@ -18,7 +18,9 @@
 
 #include "IPlugPlatform.h"
 #include "IPlugQueue.h"
+#include <algorithm>
 #include <array>
+#include <vector>
 
 BEGIN_IPLUG_NAMESPACE
 BEGIN_IGRAPHICS_NAMESPACE
@@ -77,8 +79,58 @@ public:
     }
   }
 
+  /** Pops all the elements off the queue, but only sends the most recent one for each control tag. This is an opt-in alternative to TransmitData() for controls that only
+   *  display the latest packet, so that a backlog after the UI has stalled costs one message per control, rather than one per queued block.
+   *  This must be called on the main thread - typically in MyPlugin::OnIdle() */
+  void TransmitLatestData(IEditorDelegate& dlg)
+  {
+    TransmitMergedData(dlg, [](ISenderData<MAXNC, T>& latest, const ISenderData<MAXNC, T>& d) { latest = d; });
+  }
+
+protected:
+  /** Pops all the elements off the queue and sends one message per control tag, combining the elements queued for the same tag with merge(latest, d) in queue order.
+   *  This must be called on the main thread */
+  template <typename MergeFunc>
+  void TransmitMergedData(IEditorDelegate& dlg, MergeFunc merge)
+  {
+    // there can't be more tags than queued elements, so this only allocates on the first call
+    mLatest.reserve(QUEUE_SIZE);
+    mLatest.clear();
+
+    while(mQueue.ElementsAvailable())
+    {
+      ISenderData<MAXNC, T> d;
+      mQueue.Pop(d);
+
+      bool merged = false;
+
+      for (auto& latest : mLatest)
+      {
+        if (latest.ctrlTag == d.ctrlTag)
+        {
+          merge(latest, d);
+          merged = true;
+          break;
+        }
+      }
+
+      if (merged)
+        continue;
+
+      // the audio thread can keep pushing while this pops, in the unlikely case that brings more tags than there is room for, send the element as it is
+      if (mLatest.size() < mLatest.capacity())
+        mLatest.push_back(d);
+      else
+        dlg.SendControlMsgFromDelegate(d.ctrlTag, kUpdateMessage, sizeof(ISenderData<MAXNC, T>), (void*) &d);
+    }
+
+    for (auto& d : mLatest)
+      dlg.SendControlMsgFromDelegate(d.ctrlTag, kUpdateMessage, sizeof(ISenderData<MAXNC, T>), (void*) &d);
+  }
+
 private:
   IPlugQueue<ISenderData<MAXNC, T>> mQueue {QUEUE_SIZE};
+  std::vector<ISenderData<MAXNC, T>> mLatest; // main thread only, used by TransmitMergedData()
 };
 
 /** IPeakSender is a utility class which can be used to defer peak data from sample buffers for sending to the GUI */
@@ -86,6 +138,19 @@ template <int MAXNC = 1, int QUEUE_SIZE = 64>
 class IPeakSender : public ISender<MAXNC, QUEUE_SIZE, float>
 {
 public:
+  /** An opt-in alternative to TransmitData(), which sends one message per control tag holding the maximum of each channel's peaks queued since the last call,
+   *  so that a backlog costs one message per meter without hiding transients. This must be called on the main thread - typically in MyPlugin::OnIdle() */
+  void TransmitLatestData(IEditorDelegate& dlg)
+  {
+    ISender<MAXNC, QUEUE_SIZE, float>::TransmitMergedData(dlg, [](ISenderData<MAXNC, float>& latest, const ISenderData<MAXNC, float>& d) {
+      for (auto c = 0; c < MAXNC; c++)
+        latest.vals[c] = std::max(latest.vals[c], d.vals[c]);
+
+      latest.nChans = d.nChans;
+      latest.chanOffset = d.chanOffset;
+    });
+  }
+
   /** Queue peaks from sample buffers into the sender, checking the data is over the required threshold. This can be called on the realtime audio thread. */
   void ProcessBlock(sample** inputs, int nFrames, int ctrlTag, int nChans = MAXNC, int chanOffset = 0)
   {
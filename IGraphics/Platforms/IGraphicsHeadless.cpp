@@ -0,0 +1,477 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "IGraphicsHeadless.h"
+#include "IPlugPaths.h"
+
+using namespace iplug;
+using namespace igraphics;
+
+#pragma mark - Private Classes and Structs
+
+class IGraphicsHeadless::Font : public PlatformFont
+{
+public:
+  Font(const void* pData, int dataSize)
+  : PlatformFont(false)
+  {
+    mData.Set((const uint8_t*) pData, dataSize);
+  }
+
+  IFontDataPtr GetFontData() override
+  {
+    return IFontDataPtr(new IFontData(mData.Get(), mData.GetSize(), 0));
+  }
+
+private:
+  WDL_TypedBuf<uint8_t> mData;
+};
+
+#pragma mark - PNG
+
+// A minimal PNG writer, using stored (uncompressed) deflate blocks so there's no dependency on zlib
+
+static uint32_t PNGCrc(uint32_t crc, const unsigned char* pData, size_t size)
+{
+  static uint32_t sTable[256];
+  static bool sTableMade = false;
+
+  if (!sTableMade)
+  {
+    for (uint32_t n = 0; n < 256; n++)
+    {
+      uint32_t c = n;
+      for (int k = 0; k < 8; k++)
+        c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      sTable[n] = c;
+    }
+    sTableMade = true;
+  }
+
+  crc = ~crc;
+  for (size_t i = 0; i < size; i++)
+    crc = sTable[(crc ^ pData[i]) & 0xFF] ^ (crc >> 8);
+  return ~crc;
+}
+
+static void PNGPut32(std::vector<unsigned char>& buf, uint32_t value)
+{
+  buf.push_back((value >> 24) & 0xFF);
+  buf.push_back((value >> 16) & 0xFF);
+  buf.push_back((value >> 8) & 0xFF);
+  buf.push_back(value & 0xFF);
+}
+
+static void PNGWriteChunk(FILE* pFile, const char* type, const std::vector<unsigned char>& data)
+{
+  std::vector<unsigned char> chunk;
+  PNGPut32(chunk, (uint32_t) data.size());
+  chunk.insert(chunk.end(), type, type + 4);
+  chunk.insert(chunk.end(), data.begin(), data.end());
+  PNGPut32(chunk, PNGCrc(0, chunk.data() + 4, chunk.size() - 4));
+  fwrite(chunk.data(), 1, chunk.size(), pFile);
+}
+
+/** @param rgba Non-premultiplied, 8 bit RGBA, top row first */
+static bool WritePNG(const char* path, const unsigned char* rgba, int w, int h)
+{
+  FILE* pFile = fopen(path, "wb");
+
+  if (!pFile)
+    return false;
+
+  static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+  fwrite(signature, 1, 8, pFile);
+
+  std::vector<unsigned char> header;
+  PNGPut32(header, w);
+  PNGPut32(header, h);
+  header.insert(header.end(), { 8, 6, 0, 0, 0 }); // 8 bit RGBA, no interlace
+  PNGWriteChunk(pFile, "IHDR", header);
+
+  // each row is prefixed with filter type 0
+  std::vector<unsigned char> raw;
+  raw.reserve((size_t) h * (w * 4 + 1));
+  for (int y = 0; y < h; y++)
+  {
+    raw.push_back(0);
+    raw.insert(raw.end(), rgba + ((size_t) y * w * 4), rgba + ((size_t) (y + 1) * w * 4));
+  }
+
+  std::vector<unsigned char> zlib = { 0x78, 0x01 };
+  uint32_t a = 1, b = 0;
+
+  for (size_t pos = 0; pos < raw.size() || pos == 0; )
+  {
+    const size_t blockSize = std::min<size_t>(raw.size() - pos, 65535);
+    const bool last = pos + blockSize >= raw.size();
+    zlib.push_back(last ? 1 : 0);
+    zlib.push_back(blockSize & 0xFF);
+    zlib.push_back((blockSize >> 8) & 0xFF);
+    zlib.push_back(~blockSize & 0xFF);
+    zlib.push_back((~blockSize >> 8) & 0xFF);
+    zlib.insert(zlib.end(), raw.begin() + pos, raw.begin() + pos + blockSize);
+
+    for (size_t i = pos; i < pos + blockSize; i++)
+    {
+      a = (a + raw[i]) % 65521;
+      b = (b + a) % 65521;
+    }
+
+    pos += blockSize;
+
+    if (last)
+      break;
+  }
+
+  PNGPut32(zlib, (b << 16) | a);
+  PNGWriteChunk(pFile, "IDAT", zlib);
+  PNGWriteChunk(pFile, "IEND", {});
+
+  const bool ok = !ferror(pFile);
+  fclose(pFile);
+  return ok;
+}
+
+#pragma mark - IGraphicsHeadless
+
+IGraphicsHeadless::IGraphicsHeadless(IGEditorDelegate& dlg, int w, int h, int fps, float scale)
+: IGRAPHICS_DRAW_CLASS(dlg, w, h, fps, scale)
+{
+}
+
+IGraphicsHeadless::~IGraphicsHeadless()
+{
+  CloseWindow();
+}
+
+void* IGraphicsHeadless::OpenWindow(void* pParent)
+{
+  SetPlatformContext(this);
+  OnViewInitialized(nullptr);
+  mWindowOpen = true;
+
+  SetScreenScale(1); // resizes draw context
+
+  GetDelegate()->LayoutUI(this);
+  SetAllControlsDirty();
+  GetDelegate()->OnUIOpen();
+
+  return this;
+}
+
+void IGraphicsHeadless::CloseWindow()
+{
+  if (mWindowOpen)
+  {
+    OnViewDestroyed();
+    SetPlatformContext(nullptr);
+    mWindowOpen = false;
+  }
+}
+
+EMsgBoxResult IGraphicsHeadless::ShowMessageBox(const char* str, const char* caption, EMsgBoxType type, IMsgBoxCompletionHanderFunc completionHandler)
+{
+  DBGMSG("IGraphicsHeadless message box: %s %s\n", caption ? caption : "", str ? str : "");
+
+  const EMsgBoxResult result = (type == kMB_YESNO || type == kMB_YESNOCANCEL) ? kYES : kOK;
+
+  if (completionHandler)
+    completionHandler(result);
+
+  return result;
+}
+
+PlatformFontPtr IGraphicsHeadless::LoadPlatformFont(const char* fontID, const char* fileNameOrResID)
+{
+  WDL_String fullPath;
+  const EResourceLocation fontLocation = LocateResource(fileNameOrResID, "ttf", fullPath, GetBundleID(), nullptr, nullptr);
+
+  if (fontLocation == kNotFound)
+    return nullptr;
+
+  FILE* pFile = fopen(fullPath.Get(), "rb");
+
+  if (!pFile)
+    return nullptr;
+
+  fseek(pFile, 0, SEEK_END);
+  WDL_TypedBuf<uint8_t> data;
+  data.Resize((int) ftell(pFile));
+  fseek(pFile, 0, SEEK_SET);
+  const bool ok = data.GetSize() && fread(data.Get(), 1, data.GetSize(), pFile) == (size_t) data.GetSize();
+  fclose(pFile);
+
+  return ok ? PlatformFontPtr(new Font(data.Get(), data.GetSize())) : nullptr;
+}
+
+PlatformFontPtr IGraphicsHeadless::LoadPlatformFont(const char* fontID, const char* fontName, ETextStyle style)
+{
+  DBGMSG("IGraphicsHeadless: system fonts are not supported, load %s from a file\n", fontName);
+  return nullptr;
+}
+
+PlatformFontPtr IGraphicsHeadless::LoadPlatformFont(const char* fontID, void* pData, int dataSize)
+{
+  return PlatformFontPtr(new Font(pData, dataSize));
+}
+
+void IGraphicsHeadless::AddEvent(const IHeadlessEvent& event)
+{
+  // keep the script sorted by frame, events for the same frame stay in the order they were added
+  auto it = std::upper_bound(mScript.begin(), mScript.end(), event, [](const IHeadlessEvent& a, const IHeadlessEvent& b) { return a.mFrame < b.mFrame; });
+  mScript.insert(it, event);
+}
+
+bool IGraphicsHeadless::LoadScript(const char* path)
+{
+  FILE* pFile = fopen(path, "r");
+
+  if (!pFile)
+    return false;
+
+  char line[256];
+  bool ok = true;
+
+  while (fgets(line, sizeof(line), pFile))
+  {
+    char type[32] = {};
+    IHeadlessEvent event;
+    const char* pLine = line;
+
+    while (*pLine == ' ' || *pLine == '\t')
+      pLine++;
+
+    if (*pLine == '#' || *pLine == '\n' || *pLine == '\r' || !*pLine)
+      continue;
+
+    if (sscanf(pLine, "%d %31s", &event.mFrame, type) != 2)
+    {
+      ok = false;
+      continue;
+    }
+
+    const char* pArgs = strstr(pLine, type) + strlen(type);
+    using EType = IHeadlessEvent::EType;
+
+    if (!strcmp(type, "down"))
+    {
+      event.mType = EType::MouseDown;
+      ok &= sscanf(pArgs, "%f %f", &event.mX, &event.mY) == 2;
+    }
+    else if (!strcmp(type, "up"))
+    {
+      event.mType = EType::MouseUp;
+      ok &= sscanf(pArgs, "%f %f", &event.mX, &event.mY) == 2;
+    }
+    else if (!strcmp(type, "drag"))
+    {
+      event.mType = EType::MouseDrag;
+      ok &= sscanf(pArgs, "%f %f %f %f", &event.mX, &event.mY, &event.mDX, &event.mDY) == 4;
+    }
+    else if (!strcmp(type, "over"))
+    {
+      event.mType = EType::MouseOver;
+      ok &= sscanf(pArgs, "%f %f", &event.mX, &event.mY) == 2;
+    }
+    else if (!strcmp(type, "wheel"))
+    {
+      event.mType = EType::MouseWheel;
+      ok &= sscanf(pArgs, "%f %f %f", &event.mX, &event.mY, &event.mDY) == 3;
+    }
+    else if (!strcmp(type, "param"))
+    {
+      event.mType = EType::ParamChange;
+      ok &= sscanf(pArgs, "%d %lf", &event.mParamIdx, &event.mValue) == 2;
+    }
+    else if (!strcmp(type, "resize"))
+    {
+      event.mType = EType::Resize;
+      ok &= sscanf(pArgs, "%f %f", &event.mX, &event.mY) == 2;
+    }
+    else if (!strcmp(type, "dirty"))
+    {
+      event.mType = EType::SetAllDirty;
+    }
+    else
+    {
+      ok = false;
+      continue;
+    }
+
+    AddEvent(event);
+  }
+
+  fclose(pFile);
+  return ok;
+}
+
+void IGraphicsHeadless::DeliverEvent(const IHeadlessEvent& event)
+{
+  using EType = IHeadlessEvent::EType;
+
+  IMouseMod mod(true);
+  std::vector<IMouseInfo> points(1);
+  points[0].x = event.mX;
+  points[0].y = event.mY;
+  points[0].dX = event.mDX;
+  points[0].dY = event.mDY;
+  points[0].ms = mod;
+
+  switch (event.mType)
+  {
+    case EType::MouseDown: mMouseX = event.mX; mMouseY = event.mY; OnMouseDown(points); break;
+    case EType::MouseUp: mMouseX = event.mX; mMouseY = event.mY; OnMouseUp(points); break;
+    case EType::MouseDrag: mMouseX = event.mX; mMouseY = event.mY; OnMouseDrag(points); break;
+    case EType::MouseOver: mMouseX = event.mX; mMouseY = event.mY; OnMouseOver(event.mX, event.mY, IMouseMod()); break;
+    case EType::MouseWheel: OnMouseWheel(event.mX, event.mY, IMouseMod(), event.mDY); break;
+    case EType::ParamChange: GetDelegate()->SendParameterValueFromDelegate(event.mParamIdx, event.mValue, true); break;
+    case EType::Resize: Resize((int) event.mX, (int) event.mY, GetDrawScale()); break;
+    case EType::SetAllDirty: SetAllControlsDirty(); break;
+  }
+}
+
+IHeadlessFrameTiming IGraphicsHeadless::RenderFrame()
+{
+  IHeadlessFrameTiming timing;
+  IRECTList rects;
+
+  if (!IsDirty(rects))
+    return timing;
+
+  SetAllControlsClean();
+
+  float area = 0.f;
+  for (int i = 0; i < rects.Size(); i++)
+    area += rects.Get(i).Area();
+
+  using Clock = std::chrono::high_resolution_clock;
+  const auto start = Clock::now();
+  Draw(rects);
+  timing.mDrawMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  timing.mNDirtyRects = rects.Size();
+  timing.mDirtyArea = GetBounds().Area() > 0.f ? area / GetBounds().Area() : 0.f;
+
+  return timing;
+}
+
+const std::vector<IHeadlessFrameTiming>& IGraphicsHeadless::Run(int nFrames, const char* snapshotPathPrefix, int snapshotInterval)
+{
+  mFrameTimings.clear();
+  mFrameTimings.reserve(nFrames);
+
+  size_t nextEvent = 0;
+
+  for (auto frame = 0; frame < nFrames; frame++)
+  {
+    while (nextEvent < mScript.size() && mScript[nextEvent].mFrame <= frame)
+      DeliverEvent(mScript[nextEvent++]);
+
+    OnGUIIdle();
+
+    IHeadlessFrameTiming timing = RenderFrame();
+    timing.mFrame = frame;
+    mFrameTimings.push_back(timing);
+
+    if (snapshotPathPrefix && snapshotInterval > 0 && (frame % snapshotInterval) == 0)
+    {
+      WDL_String path;
+      path.SetFormatted(1024, "%s%i.png", snapshotPathPrefix, frame);
+      WriteSnapshotPNG(path.Get());
+    }
+  }
+
+  return mFrameTimings;
+}
+
+void IGraphicsHeadless::GetFrameTimingSummary(int& nDrawnFrames, double& meanMs, double& p95Ms, double& maxMs) const
+{
+  std::vector<double> times;
+
+  for (const auto& timing : mFrameTimings)
+  {
+    if (timing.mNDirtyRects)
+      times.push_back(timing.mDrawMs);
+  }
+
+  nDrawnFrames = (int) times.size();
+  meanMs = p95Ms = maxMs = 0.;
+
+  if (times.empty())
+    return;
+
+  std::sort(times.begin(), times.end());
+
+  for (auto t : times)
+    meanMs += t;
+
+  meanMs /= times.size();
+  p95Ms = times[std::min(times.size() - 1, (size_t) (times.size() * 0.95))];
+  maxMs = times.back();
+}
+
+bool IGraphicsHeadless::WriteFrameTimingsCSV(const char* path) const
+{
+  FILE* pFile = fopen(path, "w");
+
+  if (!pFile)
+    return false;
+
+  fprintf(pFile, "frame,dirty_rects,dirty_area,draw_ms\n");
+
+  for (const auto& timing : mFrameTimings)
+    fprintf(pFile, "%i,%i,%.4f,%.4f\n", timing.mFrame, timing.mNDirtyRects, timing.mDirtyArea, timing.mDrawMs);
+
+  fclose(pFile);
+  return true;
+}
+
+bool IGraphicsHeadless::WriteSnapshotPNG(const char* path)
+{
+  const int w = Width();
+  const int h = Height();
+
+  if (w <= 0 || h <= 0)
+    return false;
+
+  std::vector<unsigned char> rgba((size_t) w * h * 4);
+  unsigned char* pPixel = rgba.data();
+
+  for (int y = 0; y < h; y++)
+  {
+    for (int x = 0; x < w; x++, pPixel += 4)
+    {
+      const IColor color = GetPoint(x, y);
+      pPixel[0] = (unsigned char) color.R;
+      pPixel[1] = (unsigned char) color.G;
+      pPixel[2] = (unsigned char) color.B;
+      pPixel[3] = (unsigned char) color.A;
+    }
+  }
+
+  return WritePNG(path, rgba.data(), w, h);
+}
+
+#ifndef NO_IGRAPHICS
+#if defined IGRAPHICS_AGG
+  #include "IGraphicsAGG.cpp"
+#elif defined IGRAPHICS_LICE
+  #include "IGraphicsLice.cpp"
+#elif defined IGRAPHICS_SKIA && defined IGRAPHICS_CPU
+  #include "IGraphicsSkia.cpp"
+#else
+  #error IGraphicsHeadless needs a CPU drawing backend: IGRAPHICS_AGG, IGRAPHICS_LICE, or IGRAPHICS_SKIA with IGRAPHICS_CPU
+#endif
+#endif
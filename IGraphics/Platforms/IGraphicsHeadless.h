@@ -0,0 +1,159 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+#pragma once
+
+#include <vector>
+
+#include "IPlugPlatform.h"
+
+// checked before IGraphics_select.h, which would stop at IGraphicsAGG.h's less helpful error
+#if defined IGRAPHICS_AGG && !defined OS_WIN && !defined OS_MAC
+  #error IGraphicsHeadless with IGRAPHICS_AGG needs an AGG pixel map, which only exists on Windows and macOS. On Linux, use IGRAPHICS_SKIA with IGRAPHICS_CPU
+#endif
+
+#include "IGraphics_select.h"
+
+BEGIN_IPLUG_NAMESPACE
+BEGIN_IGRAPHICS_NAMESPACE
+
+/** An input event for IGraphicsHeadless to deliver, before a particular frame */
+struct IHeadlessEvent
+{
+  enum class EType
+  {
+    MouseDown,
+    MouseUp,
+    MouseDrag,
+    MouseOver,
+    MouseWheel,
+    ParamChange, // as if the host was playing back automation
+    Resize,
+    SetAllDirty
+  };
+
+  int mFrame = 0; // the index of the frame the event comes before
+  EType mType = EType::SetAllDirty;
+  float mX = 0.f; // mouse position, or the new width for Resize
+  float mY = 0.f; // mouse position, or the new height for Resize
+  float mDX = 0.f; // drag delta
+  float mDY = 0.f; // drag delta, or the wheel delta for MouseWheel
+  int mParamIdx = kNoParameter;
+  double mValue = 0.; // the normalized value for ParamChange
+};
+
+/** The time taken to draw one frame in IGraphicsHeadless */
+struct IHeadlessFrameTiming
+{
+  int mFrame = 0;
+  int mNDirtyRects = 0; // 0 if nothing was dirty and nothing was drawn
+  float mDirtyArea = 0.f; // the area of the dirty rectangles, as a fraction of the UI
+  double mDrawMs = 0.;
+};
+
+/** IGraphics platform class without a window, that draws into the drawing backend's offscreen buffer. For benchmarking and comparing drawing backends
+ * (IGRAPHICS_AGG, IGRAPHICS_LICE or IGRAPHICS_SKIA with IGRAPHICS_CPU) on machines with no display, such as CI servers.
+ * IGraphicsCairo still depends on platform fonts, so it can't be used yet, and on Linux IGraphicsAGG and IGraphicsLice still need a pixel map / SWELL bitmap for their offscreen buffer.
+ * Define IGRAPHICS_HEADLESS to get one from MakeGraphics(), and build IGraphicsHeadless.cpp instead of the platform's IGraphics source file.
+ * Frames are drawn when Run() or RenderFrame() is called, not on a timer, and the mouse and automation events of a script are delivered to the control tree between frames.
+ * Dialogs, menus and text entry are not supported, and only fonts loaded from files or memory can be used
+ * @ingroup PlatformClasses */
+class IGraphicsHeadless final : public IGRAPHICS_DRAW_CLASS
+{
+  class Font;
+public:
+  IGraphicsHeadless(IGEditorDelegate& dlg, int w, int h, int fps, float scale);
+  ~IGraphicsHeadless();
+
+  void* OpenWindow(void* pParent) override;
+  void CloseWindow() override;
+  void* GetWindow() override { return mWindowOpen ? this : nullptr; }
+  bool WindowIsOpen() override { return mWindowOpen; }
+  void PlatformResize(bool parentHasResized) override {}
+
+  // the frame stays in the offscreen buffer, there's nothing to blit it to
+  void EndFrame() override {}
+
+  void HideMouseCursor(bool hide, bool lock) override {}
+  void MoveMouseCursor(float x, float y) override { mMouseX = x; mMouseY = y; }
+  void GetMouseLocation(float& x, float& y) const override { x = mMouseX; y = mMouseY; }
+
+  EMsgBoxResult ShowMessageBox(const char* str, const char* caption, EMsgBoxType type, IMsgBoxCompletionHanderFunc completionHandler) override;
+  void ForceEndUserEdit() override {}
+
+  const char* GetPlatformAPIStr() override { return "Headless"; }
+
+  void UpdateTooltips() override {}
+
+  bool RevealPathInExplorerOrFinder(WDL_String& path, bool select) override { return false; }
+  void PromptForFile(WDL_String& fileName, WDL_String& path, EFileAction action, const char* ext) override { fileName.Set(""); }
+  void PromptForDirectory(WDL_String& dir) override { dir.Set(""); }
+  bool PromptForColor(IColor& color, const char* str, IColorPickerHandlerFunc func) override { return false; }
+
+  bool OpenURL(const char* url, const char* msgWindowTitle, const char* confirmMsg, const char* errMsgOnFailure) override { return false; }
+
+  bool GetTextFromClipboard(WDL_String& str) override { str.Set(mClipboard.Get()); return true; }
+  bool SetTextInClipboard(const char* str) override { mClipboard.Set(str); return true; }
+
+  //IGraphicsHeadless
+  /** Add an event to the script that Run() delivers */
+  void AddEvent(const IHeadlessEvent& event);
+
+  /** Load a script from a text file, with one event per line (blank lines and lines starting with # are ignored):
+   * frame down x y | frame up x y | frame drag x y dX dY | frame over x y | frame wheel x y delta | frame param idx value | frame resize w h | frame dirty
+   * @return \c true if every line was parsed */
+  bool LoadScript(const char* path);
+
+  void ClearScript() { mScript.clear(); }
+
+  /** Draw nFrames frames back to back, delivering the script's events before the frames they are for. Calls OnGUIIdle() before each frame, like a platform timer would
+   * @param nFrames The number of frames to draw
+   * @param snapshotPathPrefix If not nullptr, a PNG is written to snapshotPathPrefix + frame index + ".png" every snapshotInterval frames
+   * @param snapshotInterval How often to write a snapshot, in frames
+   * @return The timing of each frame, also available from GetFrameTimings() */
+  const std::vector<IHeadlessFrameTiming>& Run(int nFrames, const char* snapshotPathPrefix = nullptr, int snapshotInterval = 1);
+
+  /** Draw whatever is dirty, as a platform's paint handler would
+   * @return The timing of the frame */
+  IHeadlessFrameTiming RenderFrame();
+
+  const std::vector<IHeadlessFrameTiming>& GetFrameTimings() const { return mFrameTimings; }
+
+  /** Get a summary of the frames that drew something in the last Run() */
+  void GetFrameTimingSummary(int& nDrawnFrames, double& meanMs, double& p95Ms, double& maxMs) const;
+
+  /** Write the timings of the last Run() as comma separated values, one frame per line */
+  bool WriteFrameTimingsCSV(const char* path) const;
+
+  /** Write the current contents of the UI to an uncompressed PNG, at 1x scale. The pixels are read with GetPoint(), so this is slow, and is not included in the frame timings */
+  bool WriteSnapshotPNG(const char* path);
+
+protected:
+  IPopupMenu* CreatePlatformPopupMenu(IPopupMenu& menu, const IRECT& bounds, bool& isAsync) override { return nullptr; }
+  void CreatePlatformTextEntry(int paramIdx, const IText& text, const IRECT& bounds, int length, const char* str) override {}
+
+private:
+  PlatformFontPtr LoadPlatformFont(const char* fontID, const char* fileNameOrResID) override;
+  PlatformFontPtr LoadPlatformFont(const char* fontID, const char* fontName, ETextStyle style) override;
+  PlatformFontPtr LoadPlatformFont(const char* fontID, void* pData, int dataSize) override;
+  void CachePlatformFont(const char* fontID, const PlatformFontPtr& font) override {}
+
+  void DeliverEvent(const IHeadlessEvent& event);
+
+  std::vector<IHeadlessEvent> mScript;
+  std::vector<IHeadlessFrameTiming> mFrameTimings;
+  WDL_String mClipboard;
+  float mMouseX = 0.f;
+  float mMouseY = 0.f;
+  bool mWindowOpen = false;
+};
+
+END_IGRAPHICS_NAMESPACE
+END_IPLUG_NAMESPACE
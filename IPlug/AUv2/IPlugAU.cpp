@@ -1729,6 +1729,9 @@ OSStatus IPlugAU::RenderProc(void* pPlug, AudioUnitRenderActionFlags* pFlags, co
       ENTER_PARAMS_MUTEX
       _this->ProcessBuffers((AudioSampleType) 0, nFrames);
       LEAVE_PARAMS_MUTEX
+
+      if (_this->GetOutputsSilent())
+        *pFlags |= kAudioUnitRenderAction_OutputIsSilence;
     }
   }
 
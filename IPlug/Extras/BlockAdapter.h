@@ -0,0 +1,264 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+#pragma once
+
+/**
+ * @file
+ * @brief Adapters between the host's block size and DSP that needs fixed size blocks
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "IPlugPlatform.h"
+#include "IPlugMidi.h"
+
+#include "heapbuf.h"
+
+BEGIN_IPLUG_NAMESPACE
+
+/** Delivers blocks of exactly blockSize frames to a block process function, whatever nFrames the host sends, e.g. for FFT processing, partitioned convolution or neural inference.
+ * The input is collected in a FIFO and the output of the last full block is played out while the next one is collected, so the adapter adds exactly GetLatency() (= blockSize) frames of latency,
+ * which the plug-in must report, as well as any latency of its own, e.g.
+ * @code
+ * void OnReset() override
+ * {
+ *   mAdapter.Resize(1024, MaxNChannels(ERoute::kInput), MaxNChannels(ERoute::kOutput));
+ *   SetLatency(mAdapter.GetLatency());
+ * }
+ *
+ * void ProcessMidiMsg(const IMidiMsg& msg) override { mAdapter.AddMidiMsg(msg); }
+ *
+ * void ProcessBlock(sample** inputs, sample** outputs, int nFrames) override
+ * {
+ *   mAdapter.ProcessBlock(inputs, outputs, nFrames,
+ *                         [&](sample** in, sample** out, int blockSize) { ... },  // always called with blockSize frames
+ *                         [&](const IMidiMsg& msg) { mMidiQueue.Add(msg); });  // msg.mOffset is relative to the next block
+ * }
+ * @endcode
+ * Sidechain inputs are just more input channels, so nInChans should be the total number of input channels across all input buses.
+ * MIDI messages added with AddMidiMsg() are delivered to the MIDI function just before the block they fall in, with their offsets remapped to that block, so they stay in time with the (delayed) audio.
+ * Memory is allocated in Resize(), ProcessBlock() does not allocate unless a very large number of MIDI messages is queued.
+ * @tparam T The sample type */
+template<typename T = double>
+class FixedBlockAdapter
+{
+public:
+  FixedBlockAdapter(int blockSize = 1024, int nInChans = 2, int nOutChans = 2)
+  {
+    Resize(blockSize, nInChans, nOutChans);
+  }
+
+  FixedBlockAdapter(const FixedBlockAdapter&) = delete;
+  FixedBlockAdapter& operator=(const FixedBlockAdapter&) = delete;
+
+  /** Set the block size and channel counts, allocating the FIFOs and clearing them. Not realtime safe
+   * @param blockSize The number of frames the block process function is called with
+   * @param nInChans The total number of input channels, including sidechains
+   * @param nOutChans The total number of output channels */
+  void Resize(int blockSize, int nInChans, int nOutChans)
+  {
+    mBlockSize = std::max(blockSize, 1);
+    mNInChans = std::max(nInChans, 0);
+    mNOutChans = std::max(nOutChans, 0);
+
+    mInBuf.Resize(mBlockSize * mNInChans);
+    mOutBuf.Resize(mBlockSize * mNOutChans);
+    mInPtrs.Resize(mNInChans);
+    mOutPtrs.Resize(mNOutChans);
+
+    for (auto c = 0; c < mNInChans; c++)
+      mInPtrs.Get()[c] = mInBuf.Get() + (c * mBlockSize);
+
+    for (auto c = 0; c < mNOutChans; c++)
+      mOutPtrs.Get()[c] = mOutBuf.Get() + (c * mBlockSize);
+
+    mMidiQueue.Resize(mBlockSize);
+
+    Reset();
+  }
+
+  /** Clear the FIFOs and any queued MIDI messages, e.g. when the transport starts */
+  void Reset()
+  {
+    if (mInBuf.GetSize())
+      memset(mInBuf.Get(), 0, mInBuf.GetSize() * sizeof(T));
+
+    if (mOutBuf.GetSize())
+      memset(mOutBuf.Get(), 0, mOutBuf.GetSize() * sizeof(T));
+
+    mMidiQueue.Clear();
+    mPos = 0;
+  }
+
+  int GetBlockSize() const { return mBlockSize; }
+
+  /** @return The latency the adapter adds, in frames, to report with SetLatency() */
+  int GetLatency() const { return mBlockSize; }
+
+  /** Queue a MIDI message for the block it falls in. Call this from ProcessMidiMsg(), i.e. before ProcessBlock() for the host block the message's offset refers to
+   * @param msg The message, with its offset in the host's next block */
+  void AddMidiMsg(const IMidiMsg& msg)
+  {
+    IMidiMsg blockMsg = msg;
+    blockMsg.mOffset += mPos;
+    mMidiQueue.Add(blockMsg);
+  }
+
+  /** Process a host block. The block process function is called for every blockSize frames collected, which might be not at all, or several times
+   * @param inputs The host's inputs (at least nInChans channels), which may be the same buffers as the outputs
+   * @param outputs The host's outputs (at least nOutChans channels)
+   * @param nFrames The number of frames in the host's block
+   * @param blockFunc A function taking (T** inputs, T** outputs, int blockSize), which processes one fixed size block
+   * @param midiFunc A function taking (const IMidiMsg& msg), called for each queued MIDI message before the block it falls in */
+  template<typename BlockFunc, typename MidiFunc>
+  void ProcessBlock(T** inputs, T** outputs, int nFrames, BlockFunc&& blockFunc, MidiFunc&& midiFunc)
+  {
+    int s = 0;
+
+    while (s < nFrames)
+    {
+      const int n = std::min(mBlockSize - mPos, nFrames - s);
+
+      // input first, so that the host's buffers can be processed in place
+      for (auto c = 0; c < mNInChans; c++)
+        memcpy(mInPtrs.Get()[c] + mPos, inputs[c] + s, n * sizeof(T));
+
+      for (auto c = 0; c < mNOutChans; c++)
+        memcpy(outputs[c] + s, mOutPtrs.Get()[c] + mPos, n * sizeof(T));
+
+      mPos += n;
+      s += n;
+
+      if (mPos == mBlockSize)
+      {
+        while (!mMidiQueue.Empty() && mMidiQueue.Peek().mOffset < mBlockSize)
+        {
+          midiFunc(mMidiQueue.Peek());
+          mMidiQueue.Remove();
+        }
+
+        mMidiQueue.Flush(mBlockSize);
+        blockFunc(mInPtrs.Get(), mOutPtrs.Get(), mBlockSize);
+        mPos = 0;
+      }
+    }
+  }
+
+  /** Process a host block, for DSP that doesn't take MIDI. See ProcessBlock() above */
+  template<typename BlockFunc>
+  void ProcessBlock(T** inputs, T** outputs, int nFrames, BlockFunc&& blockFunc)
+  {
+    ProcessBlock(inputs, outputs, nFrames, blockFunc, [](const IMidiMsg&) {});
+  }
+
+private:
+  WDL_TypedBuf<T> mInBuf;
+  WDL_TypedBuf<T> mOutBuf;
+  WDL_TypedBuf<T*> mInPtrs;
+  WDL_TypedBuf<T*> mOutPtrs;
+  IMidiQueue mMidiQueue;
+  int mBlockSize = 0;
+  int mNInChans = 0;
+  int mNOutChans = 0;
+  int mPos = 0; // frames collected for the next block, and played out of the last one
+};
+
+/** The zero latency alternative to FixedBlockAdapter, for DSP that only needs an upper bound on the block size (e.g. to size its buffers).
+ * Host blocks are split into sub-blocks of at most maxBlockSize frames, which are processed in place in the host's buffers, so the last sub-block of a host block is usually shorter.
+ * MIDI messages added with AddMidiMsg() are delivered before the sub-block they fall in, with their offsets relative to that sub-block.
+ * Memory is allocated in Resize(), ProcessBlock() does not allocate unless a very large number of MIDI messages is queued.
+ * @tparam T The sample type */
+template<typename T = double>
+class BlockSplitter
+{
+public:
+  BlockSplitter(int maxBlockSize = 64, int nInChans = 2, int nOutChans = 2)
+  {
+    Resize(maxBlockSize, nInChans, nOutChans);
+  }
+
+  BlockSplitter(const BlockSplitter&) = delete;
+  BlockSplitter& operator=(const BlockSplitter&) = delete;
+
+  /** Set the maximum block size and channel counts. Not realtime safe
+   * @param maxBlockSize The maximum number of frames the block process function is called with
+   * @param nInChans The total number of input channels, including sidechains
+   * @param nOutChans The total number of output channels */
+  void Resize(int maxBlockSize, int nInChans, int nOutChans)
+  {
+    mMaxBlockSize = std::max(maxBlockSize, 1);
+    mNInChans = std::max(nInChans, 0);
+    mNOutChans = std::max(nOutChans, 0);
+    mInPtrs.Resize(mNInChans);
+    mOutPtrs.Resize(mNOutChans);
+    mMidiQueue.Clear();
+  }
+
+  /** Clear any queued MIDI messages */
+  void Reset() { mMidiQueue.Clear(); }
+
+  int GetMaxBlockSize() const { return mMaxBlockSize; }
+
+  /** Queue a MIDI message for the sub-block it falls in. Call this from ProcessMidiMsg()
+   * @param msg The message, with its offset in the host's next block */
+  void AddMidiMsg(const IMidiMsg& msg) { mMidiQueue.Add(msg); }
+
+  /** Process a host block, as a number of sub-blocks of at most maxBlockSize frames
+   * @param inputs The host's inputs (at least nInChans channels)
+   * @param outputs The host's outputs (at least nOutChans channels)
+   * @param nFrames The number of frames in the host's block
+   * @param blockFunc A function taking (T** inputs, T** outputs, int nFrames), which processes one sub-block
+   * @param midiFunc A function taking (const IMidiMsg& msg), called for each queued MIDI message before the sub-block it falls in */
+  template<typename BlockFunc, typename MidiFunc>
+  void ProcessBlock(T** inputs, T** outputs, int nFrames, BlockFunc&& blockFunc, MidiFunc&& midiFunc)
+  {
+    for (auto s = 0; s < nFrames; s += mMaxBlockSize)
+    {
+      const int n = std::min(mMaxBlockSize, nFrames - s);
+
+      for (auto c = 0; c < mNInChans; c++)
+        mInPtrs.Get()[c] = inputs[c] + s;
+
+      for (auto c = 0; c < mNOutChans; c++)
+        mOutPtrs.Get()[c] = outputs[c] + s;
+
+      while (!mMidiQueue.Empty() && mMidiQueue.Peek().mOffset < s + n)
+      {
+        IMidiMsg msg = mMidiQueue.Peek();
+        msg.mOffset = std::max(msg.mOffset - s, 0);
+        midiFunc(msg);
+        mMidiQueue.Remove();
+      }
+
+      blockFunc(mInPtrs.Get(), mOutPtrs.Get(), n);
+    }
+
+    mMidiQueue.Flush(nFrames);
+  }
+
+  /** Process a host block, for DSP that doesn't take MIDI. See ProcessBlock() above */
+  template<typename BlockFunc>
+  void ProcessBlock(T** inputs, T** outputs, int nFrames, BlockFunc&& blockFunc)
+  {
+    ProcessBlock(inputs, outputs, nFrames, blockFunc, [](const IMidiMsg&) {});
+  }
+
+private:
+  WDL_TypedBuf<T*> mInPtrs;
+  WDL_TypedBuf<T*> mOutPtrs;
+  IMidiQueue mMidiQueue;
+  int mMaxBlockSize = 0;
+  int mNInChans = 0;
+  int mNOutChans = 0;
+};
+
+END_IPLUG_NAMESPACE
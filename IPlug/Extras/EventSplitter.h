@@ -0,0 +1,269 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+#pragma once
+
+/**
+ * @file
+ * @brief Splits host blocks at the timestamps of MIDI, parameter and transport events, for sample accurate event handling without checking for events every sample
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "IPlugPlatform.h"
+#include "IPlugMidi.h"
+#include "IPlugStructs.h"
+
+#include "heapbuf.h"
+
+BEGIN_IPLUG_NAMESPACE
+
+/** Walks the MIDI messages, parameter changes and transport changes queued for a block in timestamp order, and calls the DSP with the longest sub-blocks that have no events in them,
+ * so the DSP's inner loops run over spans of samples (and can be vectorized) rather than checking a queue every sample, e.g.
+ * @code
+ * void ProcessMidiMsg(const IMidiMsg& msg) override { mSplitter.AddMidiMsg(msg); }
+ *
+ * void ProcessBlock(sample** inputs, sample** outputs, int nFrames) override
+ * {
+ *   mSplitter.ProcessBlock(inputs, outputs, nFrames,
+ *                          [&](sample** in, sample** out, int subFrames) { ... }, // no events in these frames
+ *                          [&](const IMidiMsg& msg) { ... },                     // at the start of the next sub-block
+ *                          [&](int paramIdx, double value) { ... },
+ *                          [&](const ITimeInfo& timeInfo) { ... });
+ * }
+ * @endcode
+ * Events at the same offset are delivered transport changes first, then parameter changes, then MIDI, so a note sees the parameters set at its own sample.
+ * SetMinSubBlockSize() bounds the overhead of very dense events: an event that falls less than the minimum after the start of a sub-block is delivered at the start of the next one instead, up to minimum - 1 frames late.
+ * Events with offsets beyond the block are kept for the next one. Memory is allocated in Resize(), ProcessBlock() does not allocate unless more than maxNEvents of a kind are queued.
+ * @tparam T The sample type */
+template<typename T = double>
+class EventSplitter
+{
+public:
+  EventSplitter(int maxNEvents = DEFAULT_BLOCK_SIZE, int nInChans = 2, int nOutChans = 2)
+  {
+    Resize(maxNEvents, nInChans, nOutChans);
+  }
+
+  EventSplitter(const EventSplitter&) = delete;
+  EventSplitter& operator=(const EventSplitter&) = delete;
+
+  /** Allocate the event queues and set the channel counts, clearing any queued events. Not realtime safe
+   * @param maxNEvents The number of events of each kind that can be queued without allocating
+   * @param nInChans The total number of input channels, including sidechains
+   * @param nOutChans The total number of output channels */
+  void Resize(int maxNEvents, int nInChans, int nOutChans)
+  {
+    mNInChans = std::max(nInChans, 0);
+    mNOutChans = std::max(nOutChans, 0);
+    mInPtrs.Resize(mNInChans);
+    mOutPtrs.Resize(mNOutChans);
+    mMidiQueue.Resize(maxNEvents);
+    mParamQueue.Resize(maxNEvents);
+    mTransportQueue.Resize(maxNEvents);
+    Reset();
+  }
+
+  /** Clear the queued events, e.g. when the transport starts */
+  void Reset()
+  {
+    mMidiQueue.Clear();
+    mParamQueue.Clear();
+    mTransportQueue.Clear();
+  }
+
+  /** @param minSubBlockSize The shortest sub-block the DSP is called with, unless the block ends first. 1 (the default) for sample accurate events */
+  void SetMinSubBlockSize(int minSubBlockSize) { mMinSubBlockSize = std::max(minSubBlockSize, 1); }
+
+  int GetMinSubBlockSize() const { return mMinSubBlockSize; }
+
+  /** Queue a MIDI message. Call this from ProcessMidiMsg()
+   * @param msg The message, with its offset in the host's next block */
+  void AddMidiMsg(const IMidiMsg& msg) { mMidiQueue.Add(msg); }
+
+  /** Queue a parameter change, e.g. from a host's sample accurate automation, or a modulation source
+   * @param offset The frame in the next block at which the change happens
+   * @param paramIdx The parameter
+   * @param value The new value */
+  void AddParamChange(int offset, int paramIdx, double value) { mParamQueue.Add({ offset, paramIdx, value }); }
+
+  /** Queue a transport change, e.g. a tempo change or the loop point within a block
+   * @param offset The frame in the next block at which the change happens
+   * @param timeInfo The transport state from that frame */
+  void AddTransportChange(int offset, const ITimeInfo& timeInfo) { mTransportQueue.Add({ offset, timeInfo }); }
+
+  /** Process a host block as sub-blocks split at the queued events' offsets
+   * @param inputs The host's inputs (at least nInChans channels)
+   * @param outputs The host's outputs (at least nOutChans channels)
+   * @param nFrames The number of frames in the host's block
+   * @param blockFunc A function taking (T** inputs, T** outputs, int nFrames), which processes a sub-block with no events in it
+   * @param midiFunc A function taking (const IMidiMsg& msg), with the offset relative to the next sub-block (i.e. 0, or negative if it was delayed by the minimum sub-block size)
+   * @param paramFunc A function taking (int paramIdx, double value)
+   * @param transportFunc A function taking (const ITimeInfo& timeInfo) */
+  template<typename BlockFunc, typename MidiFunc, typename ParamFunc, typename TransportFunc>
+  void ProcessBlock(T** inputs, T** outputs, int nFrames, BlockFunc&& blockFunc, MidiFunc&& midiFunc, ParamFunc&& paramFunc, TransportFunc&& transportFunc)
+  {
+    int s = 0;
+
+    while (s < nFrames)
+    {
+      // everything due by the start of this sub-block, in timestamp order
+      while (true)
+      {
+        const int transportOffset = mTransportQueue.Empty() ? nFrames : mTransportQueue.Peek().mOffset;
+        const int paramOffset = mParamQueue.Empty() ? nFrames : mParamQueue.Peek().mOffset;
+        const int midiOffset = mMidiQueue.Empty() ? nFrames : mMidiQueue.Peek().mOffset;
+
+        if (transportOffset <= s && transportOffset <= paramOffset && transportOffset <= midiOffset)
+        {
+          transportFunc(mTransportQueue.Peek().mTimeInfo);
+          mTransportQueue.Remove();
+        }
+        else if (paramOffset <= s && paramOffset <= midiOffset)
+        {
+          paramFunc(mParamQueue.Peek().mParamIdx, mParamQueue.Peek().mValue);
+          mParamQueue.Remove();
+        }
+        else if (midiOffset <= s)
+        {
+          IMidiMsg msg = mMidiQueue.Peek();
+          msg.mOffset -= s;
+          midiFunc(msg);
+          mMidiQueue.Remove();
+        }
+        else
+          break;
+      }
+
+      int end = nFrames;
+
+      if (!mTransportQueue.Empty())
+        end = std::min(end, mTransportQueue.Peek().mOffset);
+
+      if (!mParamQueue.Empty())
+        end = std::min(end, mParamQueue.Peek().mOffset);
+
+      if (!mMidiQueue.Empty())
+        end = std::min(end, mMidiQueue.Peek().mOffset);
+
+      end = std::min(std::max(end, s + mMinSubBlockSize), nFrames);
+
+      for (auto c = 0; c < mNInChans; c++)
+        mInPtrs.Get()[c] = inputs[c] + s;
+
+      for (auto c = 0; c < mNOutChans; c++)
+        mOutPtrs.Get()[c] = outputs[c] + s;
+
+      blockFunc(mInPtrs.Get(), mOutPtrs.Get(), end - s);
+      s = end;
+    }
+
+    mMidiQueue.Flush(nFrames);
+    mParamQueue.Flush(nFrames);
+    mTransportQueue.Flush(nFrames);
+  }
+
+  /** Process a host block, for DSP that only takes MIDI events. See ProcessBlock() above */
+  template<typename BlockFunc, typename MidiFunc>
+  void ProcessBlock(T** inputs, T** outputs, int nFrames, BlockFunc&& blockFunc, MidiFunc&& midiFunc)
+  {
+    ProcessBlock(inputs, outputs, nFrames, blockFunc, midiFunc, [](int, double) {}, [](const ITimeInfo&) {});
+  }
+
+private:
+  struct ParamChange
+  {
+    int mOffset;
+    int mParamIdx;
+    double mValue;
+  };
+
+  struct TransportChange
+  {
+    int mOffset;
+    ITimeInfo mTimeInfo;
+  };
+
+  /** A queue of events kept in offset order, like IMidiQueue */
+  template<typename E>
+  class EventQueue
+  {
+  public:
+    void Resize(int size)
+    {
+      mBuf.Resize(std::max(size, 1));
+      Clear();
+    }
+
+    void Add(const E& event)
+    {
+      if (mBack >= mBuf.GetSize())
+      {
+        if (mFront > 0)
+          Compact();
+        else
+          mBuf.Resize(mBuf.GetSize() * 2);
+      }
+
+      E* pBuf = mBuf.Get();
+      int i = mBack;
+
+      // insert after any events at the same or earlier offsets, events are usually added in order so this rarely moves anything
+      while (i > mFront && event.mOffset < pBuf[i - 1].mOffset)
+      {
+        pBuf[i] = pBuf[i - 1];
+        i--;
+      }
+
+      pBuf[i] = event;
+      mBack++;
+    }
+
+    bool Empty() const { return mFront == mBack; }
+    const E& Peek() const { return mBuf.Get()[mFront]; }
+    void Remove() { mFront++; }
+    void Clear() { mFront = mBack = 0; }
+
+    void Flush(int nFrames)
+    {
+      Compact();
+
+      for (auto i = 0; i < mBack; i++)
+        mBuf.Get()[i].mOffset -= nFrames;
+    }
+
+  private:
+    void Compact()
+    {
+      if (mFront > 0)
+      {
+        memmove(mBuf.Get(), mBuf.Get() + mFront, (mBack - mFront) * sizeof(E));
+        mBack -= mFront;
+        mFront = 0;
+      }
+    }
+
+    WDL_TypedBuf<E> mBuf;
+    int mFront = 0;
+    int mBack = 0;
+  };
+
+  WDL_TypedBuf<T*> mInPtrs;
+  WDL_TypedBuf<T*> mOutPtrs;
+  IMidiQueue mMidiQueue;
+  EventQueue<ParamChange> mParamQueue;
+  EventQueue<TransportChange> mTransportQueue;
+  int mNInChans = 0;
+  int mNOutChans = 0;
+  int mMinSubBlockSize = 1;
+};
+
+END_IPLUG_NAMESPACE
@@ -0,0 +1,253 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+#pragma once
+
+/**
+ * @file
+ * @brief Multichannel feedback delay network reverb
+ */
+
+#include <cmath>
+#include <cstring>
+
+#include "IPlugPlatform.h"
+
+#include "heapbuf.h"
+
+BEGIN_IPLUG_NAMESPACE
+
+/** A 16 line feedback delay network (FDN) reverb, for 1 to 16 channels (e.g. surround/ambisonic buses).
+ * Unlike WDL_ReverbEngine, which runs a freeverb style comb/allpass bank per stereo channel, the network here is shared by all channels,
+ * so the per-sample cost is (almost) constant whatever the channel count. Each input channel feeds the delay lines l where (l % nChans == c)
+ * and each output channel is tapped from the same lines, so the feedback matrix does the spreading between channels.
+ * The delay lines are stored structure-of-arrays, each in its own power-of-two region of one buffer so read/write addresses are masked rather than wrapped.
+ * The per-line state is kept in small fixed size arrays, so the inner loops are easily auto-vectorized.
+ * The memory is allocated in SetSampleRate(), SetSize() and SetNChans() do not allocate */
+template<typename T = double, int MAXNC = 16>
+class FDNReverb
+{
+public:
+  static constexpr int kNumDelayLines = 16;
+  static constexpr double kMaxSize = 2.;
+
+  static_assert(MAXNC > 0 && MAXNC <= kNumDelayLines, "FDNReverb supports between 1 and 16 channels");
+
+  enum class EMixMatrix
+  {
+    kHadamard,   // dense, maximally diffuse, computed as a fast walsh-hadamard transform (64 add/sub)
+    kHouseholder // I - 2/N * 11^T, cheaper but less diffuse
+  };
+
+  FDNReverb(int nChans = 2, double sampleRate = 44100.)
+  {
+    SetNChans(nChans);
+    SetSampleRate(sampleRate);
+  }
+
+  /** Set the number of channels to process, does not allocate
+   * @param nChans Number of channels (1 - MAXNC) */
+  void SetNChans(int nChans)
+  {
+    mNChans = nChans < 1 ? 1 : nChans > MAXNC ? MAXNC : nChans;
+
+    // every channel gets the same number (+/- 1) of lines, normalise the output gain to that
+    for (auto l = 0; l < kNumDelayLines; l++)
+    {
+      const int c = l % mNChans;
+      const int nLinesForChan = (kNumDelayLines / mNChans) + ((c < (kNumDelayLines % mNChans)) ? 1 : 0);
+      mLineChan[l] = c;
+      mLineOutGain[l] = T(1. / std::sqrt((double) nLinesForChan)) * ((l / mNChans) & 1 ? T(-1) : T(1));
+    }
+  }
+
+  int NChans() const { return mNChans; }
+
+  /** Set the sample rate. This (re)allocates the delay lines, so don't call it on the audio thread */
+  void SetSampleRate(double sampleRate)
+  {
+    mSampleRate = sampleRate;
+
+    const double maxLen = kDelayTunings[kNumDelayLines - 1] * (sampleRate / 44100.) * kMaxSize + 1.;
+
+    int lineSize = 1;
+    while (lineSize < maxLen)
+      lineSize <<= 1;
+
+    mLineSize = lineSize;
+    mMask = lineSize - 1;
+    mBuffer.Resize(lineSize * kNumDelayLines);
+
+    CalculateDelays();
+    Reset();
+  }
+
+  /** Set the size of the space, this scales the delay line lengths
+   * @param size Scalar (0.1 - kMaxSize), 1. is the default tuning */
+  void SetSize(double size)
+  {
+    mSize = size < 0.1 ? 0.1 : size > kMaxSize ? kMaxSize : size;
+    CalculateDelays();
+  }
+
+  /** @param decayTimeSec The time in seconds for the reverb to decay by 60dB */
+  void SetDecayTime(double decayTimeSec)
+  {
+    mDecayTime = decayTimeSec < 0.01 ? 0.01 : decayTimeSec;
+    CalculateFeedback();
+  }
+
+  /** @param damp High frequency damping amount (0 - 1) */
+  void SetDampening(double damp)
+  {
+    damp = damp < 0. ? 0. : damp > 0.99 ? 0.99 : damp;
+    mDamp = T(damp);
+  }
+
+  void SetMixMatrix(EMixMatrix matrix) { mMixMatrix = matrix; }
+
+  /** Clear the delay lines and filter states */
+  void Reset()
+  {
+    memset(mBuffer.Get(), 0, mBuffer.GetSize() * sizeof(T));
+    memset(mFilterState, 0, sizeof(mFilterState));
+    mWritePos = 0;
+  }
+
+  /** Process a block of audio. Outputs are 100% wet
+   * @param inputs NChans() input channel pointers
+   * @param outputs NChans() output channel pointers, can be the same as inputs
+   * @param nFrames The number of sample frames to process */
+  void ProcessBlock(T** inputs, T** outputs, int nFrames)
+  {
+    T* pBuffer = mBuffer.Get();
+    const int nChans = mNChans;
+    const int lineSize = mLineSize;
+    const uint32_t mask = mMask;
+    const T damp = mDamp;
+    const T oneMinusDamp = T(1) - damp;
+    T lineOut[kNumDelayLines];
+    T lineIn[kNumDelayLines];
+    T chanIn[MAXNC];
+
+    for (auto s = 0; s < nFrames; s++)
+    {
+      for (auto c = 0; c < nChans; c++)
+        chanIn[c] = inputs[c][s];
+
+      // read taps, SoA: line l lives at [l * lineSize, (l + 1) * lineSize)
+      for (auto l = 0; l < kNumDelayLines; l++)
+        lineOut[l] = pBuffer[l * lineSize + ((mWritePos - mDelaySamples[l]) & mask)];
+
+      // one-pole damping + decay gain
+      for (auto l = 0; l < kNumDelayLines; l++)
+      {
+        mFilterState[l] = (lineOut[l] * oneMinusDamp) + (mFilterState[l] * damp) + kAntiDenormal;
+        lineIn[l] = mFilterState[l] * mFeedback[l];
+      }
+
+      Mix(lineIn);
+
+      for (auto l = 0; l < kNumDelayLines; l++)
+        pBuffer[l * lineSize + mWritePos] = lineIn[l] + chanIn[mLineChan[l]];
+
+      for (auto c = 0; c < nChans; c++)
+        outputs[c][s] = T(0);
+
+      for (auto l = 0; l < kNumDelayLines; l++)
+        outputs[mLineChan[l]][s] += lineOut[l] * mLineOutGain[l];
+
+      mWritePos = (mWritePos + 1) & mask;
+    }
+  }
+
+private:
+  inline void Mix(T* x) const
+  {
+    if (mMixMatrix == EMixMatrix::kHadamard)
+    {
+      for (auto h = 1; h < kNumDelayLines; h <<= 1)
+      {
+        for (auto i = 0; i < kNumDelayLines; i += (h << 1))
+        {
+          for (auto j = i; j < i + h; j++)
+          {
+            const T a = x[j];
+            const T b = x[j + h];
+            x[j] = a + b;
+            x[j + h] = a - b;
+          }
+        }
+      }
+
+      for (auto l = 0; l < kNumDelayLines; l++)
+        x[l] *= T(0.25); // 1/sqrt(16) keeps the matrix orthonormal
+    }
+    else
+    {
+      T sum = T(0);
+      for (auto l = 0; l < kNumDelayLines; l++)
+        sum += x[l];
+
+      sum *= T(2. / kNumDelayLines);
+
+      for (auto l = 0; l < kNumDelayLines; l++)
+        x[l] -= sum;
+    }
+  }
+
+  void CalculateDelays()
+  {
+    const double sc = (mSampleRate / 44100.) * mSize;
+
+    for (auto l = 0; l < kNumDelayLines; l++)
+    {
+      int delay = (int) (kDelayTunings[l] * sc);
+      mDelaySamples[l] = delay < 1 ? 1 : delay > (int) mMask ? (int) mMask : delay;
+    }
+
+    CalculateFeedback();
+  }
+
+  void CalculateFeedback()
+  {
+    // per line gain for -60dB after mDecayTime, depends on the line length
+    for (auto l = 0; l < kNumDelayLines; l++)
+      mFeedback[l] = T(std::pow(10., (-3. * mDelaySamples[l]) / (mDecayTime * mSampleRate)));
+  }
+
+  // mutually prime lengths in samples at 44.1khz, scaled by sample rate and size
+  static constexpr int kDelayTunings[kNumDelayLines] = { 601, 683, 757, 853, 941, 1031, 1123, 1217, 1319, 1423, 1523, 1619, 1741, 1847, 1949, 2053 };
+  static constexpr T kAntiDenormal = T(1e-18);
+
+  WDL_TypedBuf<T> mBuffer;
+  T mFilterState[kNumDelayLines] = {};
+  T mFeedback[kNumDelayLines] = {};
+  T mLineOutGain[kNumDelayLines] = {};
+  uint32_t mDelaySamples[kNumDelayLines] = {};
+  int mLineChan[kNumDelayLines] = {};
+  uint32_t mWritePos = 0;
+  uint32_t mMask = 0;
+  int mLineSize = 0;
+  int mNChans = 2;
+  double mSampleRate = 44100.;
+  double mSize = 1.;
+  double mDecayTime = 2.;
+  T mDamp = T(0.2);
+  EMixMatrix mMixMatrix = EMixMatrix::kHadamard;
+} WDL_FIXALIGN;
+
+template<typename T, int MAXNC>
+constexpr int FDNReverb<T, MAXNC>::kDelayTunings[];
+
+template<typename T, int MAXNC>
+constexpr T FDNReverb<T, MAXNC>::kAntiDenormal;
+
+END_IPLUG_NAMESPACE
@@ -1,71 +1,260 @@
 /*
  ==============================================================================
- 
- This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers. 
- 
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
  See LICENSE.txt for  more info.
- 
+
  ==============================================================================
 */
 
 #pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
 #include "IPlugPlatform.h"
 
+#include "heapbuf.h"
+
 BEGIN_IPLUG_NAMESPACE
 
-// A static delayline used to delay bypassed signals to match mLatency in AAX/VST3/AU
+/** A multichannel delay line, with one ring buffer per channel.
+ * ProcessBlock() delays all the channels by the same whole number of samples, with block copies rather than a loop per sample. It is used to delay bypassed signals to match the latency in AAX/VST3/AU.
+ * For musical delays, Write() a block of input, then read it back with ReadTap(), with a fixed or per sample (modulated) fractional delay and a choice of interpolation.
+ * Several taps can be read from the same line, each with its own state for allpass interpolation.
+ * The ring buffers are a power of two in size, so read and write addresses are masked rather than wrapped with %.
+ * Memory is allocated in SetMaxDelayTime() and SetNTaps(), SetDelayTime() only allocates if the delay is longer than the maximum */
 template<typename T>
 class NChanDelayLine
 {
 public:
+  enum class EInterp
+  {
+    kNone,    // rounds the delay down to a whole number of samples
+    kLinear,
+    kCubic,   // 4 point hermite, delays must be at least 1 sample
+    kAllpass  // first order allpass, flat magnitude but the delay should only be modulated slowly
+  };
+
   NChanDelayLine(int nInputChans = 2, int nOutputChans = 2)
   : mNInChans(nInputChans)
   , mNOutChans(nOutputChans)
-  {}
+  {
+    SetMaxDelayTime(0);
+    SetNTaps(1);
+  }
 
-  void SetDelayTime(int delayTimeSamples)
+  /** Allocate the ring buffers, so that SetDelayTime() can change the delay without allocating. Clears the buffers
+   * @param maxDelaySamples The longest delay that will be needed
+   * @param maxBlockSize The largest block that will be passed to Write(). ProcessBlock() takes any block size */
+  void SetMaxDelayTime(int maxDelaySamples, int maxBlockSize = kDefaultMaxBlockSize)
   {
-    mDTSamples = delayTimeSamples;
-    mBuffer.Resize(mNInChans * delayTimeSamples);
+    mMaxBlockSize = std::max(maxBlockSize, 1);
+
+    int capacity = 1;
+
+    while (capacity < maxDelaySamples + mMaxBlockSize + kInterpolationFrames)
+      capacity <<= 1;
+
+    mCapacity = capacity;
+    mMask = capacity - 1;
+    mMaxDelaySamples = capacity - mMaxBlockSize - kInterpolationFrames; // anything that fits the power of two
+    mBuffer.Resize(mNInChans * capacity);
     mWriteAddress = 0;
     ClearBuffer();
   }
 
+  /** Set the delay used by ProcessBlock(). Doesn't allocate or clear the buffers unless the delay is longer than the maximum, so the delay can be changed while processing
+   * @param delayTimeSamples The delay in samples */
+  void SetDelayTime(int delayTimeSamples)
+  {
+    if (delayTimeSamples > mMaxDelaySamples)
+      SetMaxDelayTime(delayTimeSamples, mMaxBlockSize);
+
+    mDTSamples = std::max(delayTimeSamples, 0);
+  }
+
+  int GetDelayTime() const { return mDTSamples; }
+  int GetMaxDelayTime() const { return mMaxDelaySamples; }
+
+  /** Set the number of taps that will be read with ReadTap(), allocating their allpass interpolation state
+   * @param nTaps The number of taps per channel */
+  void SetNTaps(int nTaps)
+  {
+    mNTaps = std::max(nTaps, 1);
+    mAllpassState.Resize(mNTaps * mNInChans);
+    memset(mAllpassState.Get(), 0, mAllpassState.GetSize() * sizeof(T));
+  }
+
   void ClearBuffer()
   {
-    memset(mBuffer.Get(), 0, mNInChans * mDTSamples * sizeof(T));
+    memset(mBuffer.Get(), 0, mBuffer.GetSize() * sizeof(T));
+    memset(mAllpassState.Get(), 0, mAllpassState.GetSize() * sizeof(T));
   }
 
+  /** Delay the inputs by the delay time. Channels beyond the number of inputs are zeroed. The inputs and outputs can be the same buffers
+   * @param inputs The input channels
+   * @param outputs The output channels
+   * @param nFrames The number of frames to process */
   void ProcessBlock(T** inputs, T** outputs, int nFrames)
   {
-    T* buffer = mBuffer.Get();
+    const int nChans = std::min(mNInChans, mNOutChans);
+    int s = 0;
 
-    for (auto s = 0 ; s < nFrames; ++s)
+    while (s < nFrames)
     {
-      int32_t readAddress = mWriteAddress - mDTSamples;
-      readAddress %= mDTSamples;
+      // each chunk is written before it's read, so it mustn't overwrite samples that it still has to read
+      const int n = std::min(nFrames - s, mCapacity - mDTSamples);
+      const uint32_t readAddress = (mWriteAddress - mDTSamples) & mMask;
 
-      for (auto c = 0; c < mNInChans; c++)
+      for (auto c = 0; c < nChans; c++)
       {
-        if (c < mNOutChans)
-        {
-          T input = inputs[c][s];
-          const int offset = c * mDTSamples;
-          outputs[c][s] = buffer[offset + readAddress];
-          buffer[offset + mWriteAddress] = input;
-        }
+        T* pRing = GetRing(c);
+        CopyToRing(pRing, mWriteAddress, inputs[c] + s, n);
+        CopyFromRing(outputs[c] + s, pRing, readAddress, n);
       }
 
-      mWriteAddress++;
-      mWriteAddress %= mDTSamples;
+      mWriteAddress = (mWriteAddress + n) & mMask;
+      s += n;
     }
+
+    for (auto c = nChans; c < mNOutChans; c++)
+      memset(outputs[c], 0, nFrames * sizeof(T));
+  }
+
+  /** Write a block of input into the line, to be read back with ReadTap()
+   * @param inputs The input channels
+   * @param nFrames The number of frames, no more than the maxBlockSize passed to SetMaxDelayTime() */
+  void Write(T** inputs, int nFrames)
+  {
+    assert(nFrames <= mMaxBlockSize);
+
+    for (auto c = 0; c < mNInChans; c++)
+      CopyToRing(GetRing(c), mWriteAddress, inputs[c], nFrames);
+
+    mWriteAddress = (mWriteAddress + nFrames) & mMask;
+  }
+
+  /** Read the last block passed to Write() from a tap with a fixed delay
+   * @param tapIdx The tap, for its allpass interpolation state (0 to nTaps-1)
+   * @param chan The channel
+   * @param pOutput Where to write the nFrames delayed samples
+   * @param delaySamples The delay in samples, relative to each input sample, clamped to the maximum delay time
+   * @param nFrames The number of frames, which should be the number of frames written
+   * @param interp The interpolation */
+  void ReadTap(int tapIdx, int chan, T* pOutput, double delaySamples, int nFrames, EInterp interp = EInterp::kLinear)
+  {
+    ReadTapImpl(tapIdx, chan, pOutput, nFrames, interp, [delaySamples](int) { return delaySamples; });
+  }
+
+  /** Read the last block passed to Write() from a tap with a delay per sample, e.g. for chorus, flanger or tape delay effects
+   * @param tapIdx The tap, for its allpass interpolation state (0 to nTaps-1)
+   * @param chan The channel
+   * @param pOutput Where to write the nFrames delayed samples
+   * @param pDelaySamples The delay in samples for each frame, relative to each input sample, clamped to the maximum delay time
+   * @param nFrames The number of frames, which should be the number of frames written
+   * @param interp The interpolation */
+  void ReadTap(int tapIdx, int chan, T* pOutput, const T* pDelaySamples, int nFrames, EInterp interp = EInterp::kLinear)
+  {
+    ReadTapImpl(tapIdx, chan, pOutput, nFrames, interp, [pDelaySamples](int s) { return (double) pDelaySamples[s]; });
   }
 
 private:
+  static constexpr int kInterpolationFrames = 4;
+  static constexpr int kDefaultMaxBlockSize = 512;
+
+  T* GetRing(int chan) { return mBuffer.Get() + (chan * mCapacity); }
+
+  void CopyToRing(T* pRing, uint32_t address, const T* pSrc, int n)
+  {
+    const int n1 = std::min(n, (int) (mCapacity - address));
+    memcpy(pRing + address, pSrc, n1 * sizeof(T));
+    memcpy(pRing, pSrc + n1, (n - n1) * sizeof(T));
+  }
+
+  void CopyFromRing(T* pDest, const T* pRing, uint32_t address, int n)
+  {
+    const int n1 = std::min(n, (int) (mCapacity - address));
+    memcpy(pDest, pRing + address, n1 * sizeof(T));
+    memcpy(pDest + n1, pRing, (n - n1) * sizeof(T));
+  }
+
+  template <typename F>
+  void ReadTapImpl(int tapIdx, int chan, T* pOutput, int nFrames, EInterp interp, F&& getDelay)
+  {
+    assert(tapIdx < mNTaps && chan < mNInChans);
+
+    const T* pRing = GetRing(chan);
+    const uint32_t mask = mMask;
+    const uint32_t start = mWriteAddress - nFrames; // the address of the first frame of the last block
+    const double minDelay = interp == EInterp::kCubic ? 1. : 0.;
+    const double maxDelay = (double) mMaxDelaySamples;
+    T& allpassState = mAllpassState.Get()[(tapIdx * mNInChans) + chan];
+
+    for (auto s = 0; s < nFrames; s++)
+    {
+      const double delay = std::min(std::max(getDelay(s), minDelay), maxDelay);
+      int i = (int) delay;
+      T frac = (T) (delay - i);
+      const uint32_t t = start + s;
+
+      switch (interp)
+      {
+        case EInterp::kNone:
+          pOutput[s] = pRing[(t - i) & mask];
+          break;
+        case EInterp::kLinear:
+        {
+          const T x0 = pRing[(t - i) & mask];
+          const T x1 = pRing[(t - i - 1) & mask];
+          pOutput[s] = x0 + frac * (x1 - x0);
+          break;
+        }
+        case EInterp::kCubic:
+        {
+          const T xm1 = pRing[(t - i + 1) & mask];
+          const T x0 = pRing[(t - i) & mask];
+          const T x1 = pRing[(t - i - 1) & mask];
+          const T x2 = pRing[(t - i - 2) & mask];
+          const T c1 = T(0.5) * (x1 - xm1);
+          const T c2 = xm1 - T(2.5) * x0 + T(2.) * x1 - T(0.5) * x2;
+          const T c3 = T(0.5) * (x2 - xm1) + T(1.5) * (x0 - x1);
+          pOutput[s] = ((c3 * frac + c2) * frac + c1) * frac + x0;
+          break;
+        }
+        case EInterp::kAllpass:
+        {
+          // the allpass is most accurate for fractional delays between 0.5 and 1.5 samples
+          if (frac < T(0.5) && i > 0)
+          {
+            i--;
+            frac += T(1.);
+          }
+
+          const T eta = (T(1.) - frac) / (T(1.) + frac);
+          const T x0 = pRing[(t - i) & mask];
+          const T x1 = pRing[(t - i - 1) & mask];
+          allpassState = eta * (x0 - allpassState) + x1;
+          pOutput[s] = allpassState;
+          break;
+        }
+      }
+    }
+  }
+
   WDL_TypedBuf<T> mBuffer;
-  uint32_t mNInChans, mNOutChans;
+  WDL_TypedBuf<T> mAllpassState; // the last output of each tap, per channel
+  int mNInChans, mNOutChans;
+  int mNTaps = 0;
+  int mCapacity = 0; // per channel, a power of two
+  uint32_t mMask = 0;
   uint32_t mWriteAddress = 0;
-  uint32_t mDTSamples = 0;
+  int mDTSamples = 0;
+  int mMaxDelaySamples = -1;
+  int mMaxBlockSize = kDefaultMaxBlockSize;
 } WDL_FIXALIGN;
 
 END_IPLUG_NAMESPACE
@@ -12,6 +12,7 @@
 
 #define OVERSAMPLING_FACTORS_VA_LIST "None", "2x", "4x", "8x", "16x"
 
+#include <algorithm>
 #include <functional>
 #include <cmath>
 
@@ -23,6 +24,7 @@
 #include "ptrlist.h"
 
 #include "IPlugPlatform.h"
+#include "IPlugQuality.h"
 
 BEGIN_IPLUG_NAMESPACE
 
@@ -39,10 +41,13 @@ enum EFactor
 };
 
 template<typename T = double>
-class OverSampler
+class OverSampler : public IQualityTierListener
 {
 public:
   using BlockProcessFunc = std::function<void(T**, T**, int)>;
+
+  /** The number of samples the output fades out and in over when the quality tier changes the factor, whatever the block size */
+  static constexpr int kSampleRampLength = 64;
   
   OverSampler(EFactor factor = kNone, bool blockProcessing = true, int nChannels = 1)
   : mBlockProcessing(blockProcessing)
@@ -168,6 +173,9 @@ public:
     mDown8BufferPtrs.Empty();
     mDown4BufferPtrs.Empty();
     mDown2BufferPtrs.Empty();
+
+    mRampGain = 1.;
+    mRampSamplesLeft = 0;
     
     for (auto c = 0; c < mNChannels; c++)
     {
@@ -200,6 +208,8 @@ public:
   void ProcessBlock(T** inputs, T** outputs, int nFrames, int nChans, BlockProcessFunc func)
   {
     assert(nChans <= mNChannels);
+
+    const int rampOffset = ApplyQualityTierFactor(nFrames);
     
     if(mRate != mPrevRate)
     {
@@ -287,6 +297,22 @@ public:
         mDownsampler2x.Get(c)->process_block(outputs[c], mDown2BufferPtrs.Get(c), nFrames);
       }
     }
+
+    if (mRampSamplesLeft > 0 || mRampGain != T(1.))
+    {
+      const T gain = mRampGain;
+      const int rampSamplesLeft = mRampSamplesLeft;
+
+      for(auto c = 0; c < nChans; c++)
+      {
+        mRampGain = gain;
+        mRampSamplesLeft = rampSamplesLeft;
+
+        // once a fade out is done, the rest of the block is silent until the factor is switched at the start of the next one
+        for (auto s = rampOffset; s < nFrames; s++)
+          outputs[c][s] *= mRampSamplesLeft > 0 ? NextRampGain() : mRampGain;
+      }
+    }
   }
   
   /** Over sample an input sample with a per-sample function (up-sample input -> process with function -> down-sample)
@@ -295,6 +321,8 @@ public:
    * @return The audio sample output */
   T Process(T input, std::function<T(T)> func)
   {
+    ApplyQualityTierFactor(1);
+
     T output;
 
     if(mRate == 16)
@@ -355,7 +383,7 @@ public:
       output = func(input);
     }
 
-    return output;
+    return mRampSamplesLeft > 0 ? output * NextRampGain() : output;
   }
 
   /** Over-sample an per-sample synthesis function
@@ -363,6 +391,8 @@ public:
    * @return The audio sample output */
   T ProcessGen(std::function<T()> genFunc)
   {
+    ApplyQualityTierFactor(1);
+
     auto ProcessDown16x = [&](T input)
     {
       mDown16x.Get()[mWritePos] = (T) input;
@@ -439,11 +469,13 @@ public:
     if(mRate > 1)
       output = mDownSamplerOutput;
 
-    return output;
+    return mRampSamplesLeft > 0 ? output * NextRampGain() : output;
   }
 
   void SetOverSampling(EFactor factor)
   {
+    mQualityTierFactor = kNumFactors; // an explicit factor overrides the tier's until the tier changes again
+
     if(factor != mFactor)
     {
       mFactor = factor;
@@ -453,6 +485,25 @@ public:
     }
   }
   
+  /** Choose the factor for each quality tier, for when the over sampler is told about tier changes with OnQualityTierChanged(), e.g. by IPlugProcessor::AddQualityTierListener() */
+  void SetQualityTierFactors(EFactor low, EFactor normal, EFactor high, EFactor offline)
+  {
+    mQualityTierFactors[kQualityLow] = low;
+    mQualityTierFactors[kQualityNormal] = normal;
+    mQualityTierFactors[kQualityHigh] = high;
+    mQualityTierFactors[kQualityOffline] = offline;
+  }
+
+  /** Switch to the factor for a quality tier. Unlike SetOverSampling() this doesn't reallocate anything, so it can be called on the audio thread.
+   * So that the switch doesn't click, the output fades out over kSampleRampLength samples at the old factor and back in over kSampleRampLength samples at the new one.
+   * With ProcessBlock() the fade out ends with the block, so the factor is switched at the start of the next block. The factors are not run in parallel and crossfaded,
+   * as that would call the processing function twice for the same samples, and their filters have different delays. The filters that both factors use keep their state,
+   * the ones only the new factor uses are cleared, which happens while the output is silent */
+  void OnQualityTierChanged(EQualityTier tier) override
+  {
+    mQualityTierFactor = mQualityTierFactors[tier];
+  }
+
   static EFactor RateToFactor(int rate)
   {
     switch (rate)
@@ -472,10 +523,72 @@ public:
   }
 
 private:
+  /** Called at the start of each block (or sample, for per-sample processing) to fade out before a tier's factor is switched to and back in after
+   * @param nFrames The number of samples in the block
+   * @return The index of the sample in the block that the fade starts at, a fade out is started so that it ends with the block if the block is long enough */
+  int ApplyQualityTierFactor(int nFrames)
+  {
+    if (mRampSamplesLeft > 0)
+      return 0;
+
+    if (mRampGain == T(0.))
+    {
+      // faded out, switch the factor (unless the tier went back to the old one) and fade back in
+      if (mQualityTierFactor != kNumFactors && mQualityTierFactor != mFactor)
+      {
+        const int prevRate = mRate;
+
+        // the buffers are always big enough for 16x, so only the rate and the filters change
+        mFactor = mQualityTierFactor;
+        mRate = 1 << (int) mFactor;
+        mWritePos = 0;
+
+        // the stages the old rate didn't use have stale state, from when they were last used
+        for (auto c = 0; c < mNChannels; c++)
+        {
+          if (prevRate < 2 && mRate >= 2) { mUpsampler2x.Get(c)->clear_buffers(); mDownsampler2x.Get(c)->clear_buffers(); }
+          if (prevRate < 4 && mRate >= 4) { mUpsampler4x.Get(c)->clear_buffers(); mDownsampler4x.Get(c)->clear_buffers(); }
+          if (prevRate < 8 && mRate >= 8) { mUpsampler8x.Get(c)->clear_buffers(); mDownsampler8x.Get(c)->clear_buffers(); }
+          if (prevRate < 16 && mRate >= 16) { mUpsampler16x.Get(c)->clear_buffers(); mDownsampler16x.Get(c)->clear_buffers(); }
+        }
+      }
+
+      StartRamp(T(1.));
+    }
+    else if (mQualityTierFactor != kNumFactors && mQualityTierFactor != mFactor)
+    {
+      StartRamp(T(-1.));
+      return std::max(nFrames - kSampleRampLength, 0);
+    }
+
+    return 0;
+  }
+
+  void StartRamp(T direction)
+  {
+    mRampSamplesLeft = kSampleRampLength;
+    mRampStep = direction / (T) kSampleRampLength;
+  }
+
+  T NextRampGain()
+  {
+    mRampGain += mRampStep;
+
+    if (--mRampSamplesLeft == 0)
+      mRampGain = mRampStep < T(0.) ? T(0.) : T(1.);
+
+    return mRampGain;
+  }
+
   EFactor mFactor = kNone;
+  EFactor mQualityTierFactor = kNumFactors; // the factor requested by OnQualityTierChanged(), kNumFactors until the first tier change
+  EFactor mQualityTierFactors[kNumQualityTiers] = { kNone, k2x, k4x, k8x };
   int mPrevRate = 0;
   int mRate = 1;
   int mWritePos = 0;
+  T mRampGain = 1.; // the output gain, faded to 0 and back when the tier's factor changes
+  T mRampStep = 0.;
+  int mRampSamplesLeft = 0;
   T mDownSamplerOutput = 0.;
   bool mBlockProcessing; // false
   int mNChannels; // 1
@@ -0,0 +1,82 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+#pragma once
+
+/**
+ * @file
+ * @brief A WDL_Resampler that changes its interpolation with the quality tier
+ */
+
+#include "IPlugPlatform.h"
+#include "IPlugQuality.h"
+
+#include "resample.h"
+
+BEGIN_IPLUG_NAMESPACE
+
+/** A WDL_Resampler whose mode (see WDL_Resampler::SetMode()) is chosen by the quality tier: cheaper interpolation in real time, longer sinc filters when rendering offline.
+ * Register it with IPlugProcessor::AddQualityTierListener(), or call OnQualityTierChanged() yourself, and the mode changes at the start of the next ResamplePrepare() call.
+ * WDL_Resampler::ResamplePrepare() isn't virtual, so this only happens when it is called through a QualityResampler, not through a WDL_Resampler pointer or reference.
+ * Changing the mode can allocate and free on the audio thread: WDL_Resampler::SetMode() frees the sinc table when switching to a mode without sinc interpolation and the IIR filters
+ * when switching to one without filters, and they are allocated again the next time a mode that uses them is. The sinc table is also rebuilt when its size changes,
+ * and reallocated when it grows or shrinks to under half its allocation. That can't be avoided without changing WDL_Resampler, so it should be considered when choosing the real-time tiers' modes.
+ * The resampler's latency (GetCurrentLatency()) depends on the mode, so a plug-in that reports it should update its latency on a tier change */
+class QualityResampler : public WDL_Resampler, public IQualityTierListener
+{
+public:
+  /** The arguments of WDL_Resampler::SetMode() for a tier */
+  struct Mode
+  {
+    bool interp;
+    int filterCnt;
+    bool sinc;
+    int sincSize;
+    int sincInterpSize;
+  };
+
+  QualityResampler()
+  {
+    ApplyMode(mModes[kQualityNormal]);
+  }
+
+  /** Set the mode for a quality tier
+   * @param tier The tier
+   * @param mode The mode to use at that tier */
+  void SetQualityTierMode(EQualityTier tier, const Mode& mode) { mModes[tier] = mode; }
+
+  void OnQualityTierChanged(EQualityTier tier) override { mPendingTier = tier; }
+
+  /** Like WDL_Resampler::ResamplePrepare(), but switches to the mode of the last tier change first, which can allocate (see the class description).
+   * This hides rather than overrides WDL_Resampler::ResamplePrepare(), so call it through a QualityResampler */
+  int ResamplePrepare(int out_samples, int nch, WDL_ResampleSample** inbuffer)
+  {
+    if (mPendingTier != kNumQualityTiers)
+    {
+      ApplyMode(mModes[mPendingTier]);
+      mPendingTier = kNumQualityTiers;
+    }
+
+    return WDL_Resampler::ResamplePrepare(out_samples, nch, inbuffer);
+  }
+
+private:
+  void ApplyMode(const Mode& mode) { SetMode(mode.interp, mode.filterCnt, mode.sinc, mode.sincSize, mode.sincInterpSize); }
+
+  Mode mModes[kNumQualityTiers] = {
+    { true, 1, false, 0, 0 },    // kQualityLow, linear interpolation with a single low pass filter
+    { false, 0, true, 32, 16 },  // kQualityNormal
+    { false, 0, true, 64, 32 },  // kQualityHigh, WDL_Resampler's default sinc
+    { false, 0, true, 256, 64 }  // kQualityOffline
+  };
+  EQualityTier mPendingTier = kNumQualityTiers; // kNumQualityTiers if the mode is up to date
+};
+
+END_IPLUG_NAMESPACE
@@ -0,0 +1,397 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+#pragma once
+
+/**
+ * @file
+ * @brief Short time fourier transform (STFT) overlap-add processing, using the WDL FFT
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "IPlugPlatform.h"
+#include "IPlugConstants.h"
+
+#include "fft.h"
+#include "heapbuf.h"
+
+BEGIN_IPLUG_NAMESPACE
+
+/** A multichannel STFT engine for spectral processing: the input is windowed into overlapping frames of fftSize samples, hopSize samples apart, which are transformed with WDL_real_fft,
+ * passed to a spectrum function to be modified, transformed back, windowed again and overlap-added to make the output.
+ * The spectrum function is called once per frame with the spectra of all the channels, so it can process them together (e.g. mid/side, or a sidechain controlling the main channels).
+ * Each spectrum is fftSize/2 + 1 contiguous complex bins, from DC to nyquist, un-permuted from WDL_real_fft's order.
+ * The window is applied before the forward FFT and after the inverse FFT, and the output is normalised for the window and hop, so if the spectra aren't modified the output is the input,
+ * delayed by GetLatency() samples, for any window and any hop up to fftSize/2 (fftSize/4 is a good choice for the Hann window).
+ * Large FFTs can be computed on a worker thread (SetWorkerThread()), in which case the spectrum function is called on that thread, and the latency is one hop longer,
+ * which is the time the worker has to finish each frame. If it hasn't finished, the audio thread waits for it.
+ * Memory is allocated in Resize(), ProcessBlock() does not allocate. WDL/fft.c must be compiled into the project
+ * @tparam T The sample type */
+template<typename T = double>
+class STFT
+{
+public:
+  enum class EWindow
+  {
+    kHann,
+    kHamming,
+    kBlackman,
+    kRectangular
+  };
+
+  /** A function taking (WDL_FFT_COMPLEX** spectra, int nChans, int nBins), that modifies the spectra of the channels in place */
+  using SpectrumFunc = std::function<void(WDL_FFT_COMPLEX**, int, int)>;
+
+  static constexpr int kMinFFTSize = 16;
+  static constexpr int kMaxFFTSize = 32768;
+
+  STFT(int fftSize = 1024, int hopSize = 256, int nChans = 2, EWindow window = EWindow::kHann)
+  {
+    WDL_fft_init();
+    Resize(fftSize, hopSize, nChans, window);
+  }
+
+  ~STFT()
+  {
+    SetWorkerThread(false);
+  }
+
+  STFT(const STFT&) = delete;
+  STFT& operator=(const STFT&) = delete;
+
+  /** Set the function that modifies the spectra. Not realtime safe, set it before processing starts
+   * @param func The function, see SpectrumFunc */
+  void SetSpectrumFunc(SpectrumFunc func)
+  {
+    WaitForFrame();
+    mSpectrumFunc = func;
+  }
+
+  /** Set the FFT size, hop size, channel count and window, allocating the buffers and clearing them. Not realtime safe
+   * @param fftSize The FFT size, a power of two from kMinFFTSize to kMaxFFTSize
+   * @param hopSize The number of samples between frames, from 1 to fftSize/2
+   * @param nChans The number of channels to process
+   * @param window The window function */
+  void Resize(int fftSize, int hopSize, int nChans, EWindow window = EWindow::kHann)
+  {
+    assert(fftSize >= kMinFFTSize && fftSize <= kMaxFFTSize && (fftSize & (fftSize - 1)) == 0);
+
+    WaitForFrame();
+
+    mFFTSize = fftSize;
+    mHopSize = hopSize < 1 ? 1 : hopSize > fftSize / 2 ? fftSize / 2 : hopSize;
+    mNChans = nChans < 1 ? 1 : nChans;
+    mNBins = mFFTSize / 2 + 1;
+    mPermute = WDL_fft_permute_tab(mFFTSize / 2);
+
+    mInFifo.Resize(mNChans * mFFTSize);
+    mOutAccum.Resize(mNChans * mFFTSize);
+    mFrame.Resize(mNChans * mFFTSize);
+    mBins.Resize(mNChans * mNBins);
+    mBinPtrs.Resize(mNChans);
+
+    for (auto c = 0; c < mNChans; c++)
+      mBinPtrs.Get()[c] = mBins.Get() + (c * mNBins);
+
+    SetWindow(window);
+    Reset();
+  }
+
+  /** Clear the input and output buffers, e.g. when the transport starts */
+  void Reset()
+  {
+    WaitForFrame();
+    mFrameInFlight = false;
+    memset(mInFifo.Get(), 0, mInFifo.GetSize() * sizeof(T));
+    memset(mOutAccum.Get(), 0, mOutAccum.GetSize() * sizeof(T));
+    mHopPos = 0;
+  }
+
+  /** Compute the FFTs and call the spectrum function on a worker thread, rather than in ProcessBlock(). This adds a hop of latency,
+   * but moves the cost of each frame off the audio thread, and spreads it over the hop rather than it landing in whichever block completes the frame,
+   * which matters for large FFT sizes with small host blocks. Not realtime safe, and the latency changes, so call it before processing starts
+   * @param enable \c true to start the worker thread, \c false to stop it */
+  void SetWorkerThread(bool enable)
+  {
+    if (enable == mThread.joinable())
+      return;
+
+    if (enable)
+    {
+      Reset();
+      mRunning = true;
+      mThread = std::thread(&STFT::ThreadProc, this);
+    }
+    else
+    {
+      WaitForFrame();
+
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mRunning = false;
+      }
+
+      mCV.notify_one();
+      mThread.join();
+      Reset();
+    }
+  }
+
+  bool GetWorkerThread() const { return mThread.joinable(); }
+
+  int GetFFTSize() const { return mFFTSize; }
+  int GetHopSize() const { return mHopSize; }
+  int GetNChans() const { return mNChans; }
+  int GetNBins() const { return mNBins; }
+
+  /** @return The latency in samples, to report with SetLatency() */
+  int GetLatency() const { return mFFTSize + (GetWorkerThread() ? mHopSize : 0); }
+
+  /** Process a block of audio. A frame is processed every hopSize samples, which might be not at all, or several times in one block
+   * @param inputs The inputs (nChans channels), which may be the same buffers as the outputs
+   * @param outputs The outputs (nChans channels)
+   * @param nFrames The number of samples in the block */
+  void ProcessBlock(T** inputs, T** outputs, int nFrames)
+  {
+    const int fifoStart = mFFTSize - mHopSize;
+    int s = 0;
+
+    while (s < nFrames)
+    {
+      const int n = std::min(mHopSize - mHopPos, nFrames - s);
+
+      // the newest hop is at the end of the input FIFO, the oldest hop of the accumulator is finished, and is played out
+      for (auto c = 0; c < mNChans; c++)
+      {
+        memcpy(GetInFifo(c) + fifoStart + mHopPos, inputs[c] + s, n * sizeof(T));
+        memcpy(outputs[c] + s, GetOutAccum(c) + mHopPos, n * sizeof(T));
+      }
+
+      mHopPos += n;
+      s += n;
+
+      if (mHopPos == mHopSize)
+      {
+        if (GetWorkerThread())
+        {
+          // the worker has had a hop to transform the last frame
+          WaitForFrame();
+          ShiftOutAccum(mFrameInFlight);
+          LoadFrame();
+
+          {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mFramePending = true;
+          }
+
+          mFrameInFlight = true;
+          mCV.notify_one();
+        }
+        else
+        {
+          LoadFrame();
+          TransformFrame();
+          ShiftOutAccum(true);
+        }
+
+        mHopPos = 0;
+      }
+    }
+  }
+
+private:
+  T* GetInFifo(int chan) { return mInFifo.Get() + (chan * mFFTSize); }
+  T* GetOutAccum(int chan) { return mOutAccum.Get() + (chan * mFFTSize); }
+  WDL_FFT_REAL* GetFrame(int chan) { return mFrame.Get() + (chan * mFFTSize); }
+
+  void SetWindow(EWindow window)
+  {
+    mAnalysisWindow.Resize(mFFTSize);
+    mSynthesisWindow.Resize(mFFTSize);
+
+    WDL_FFT_REAL* pAnalysis = mAnalysisWindow.Get();
+    WDL_FFT_REAL* pSynthesis = mSynthesisWindow.Get();
+
+    // periodic windows, so that they overlap evenly
+    for (auto i = 0; i < mFFTSize; i++)
+    {
+      const double x = 2. * PI * i / mFFTSize;
+      double w = 1.;
+
+      switch (window)
+      {
+        case EWindow::kHann: w = 0.5 - 0.5 * std::cos(x); break;
+        case EWindow::kHamming: w = 0.54 - 0.46 * std::cos(x); break;
+        case EWindow::kBlackman: w = 0.42 - 0.5 * std::cos(x) + 0.08 * std::cos(2. * x); break;
+        case EWindow::kRectangular: break;
+      }
+
+      pAnalysis[i] = (WDL_FFT_REAL) w;
+    }
+
+    // normalise the synthesis window so that the squared windows of the overlapping frames add up to 1 at every sample, which also takes out WDL_real_fft's round trip gain of 2 * fftSize
+    for (auto i = 0; i < mFFTSize; i++)
+    {
+      double sum = 0.;
+
+      for (auto j = i % mHopSize; j < mFFTSize; j += mHopSize)
+        sum += (double) pAnalysis[j] * pAnalysis[j];
+
+      pSynthesis[i] = (WDL_FFT_REAL) (sum > 0. ? pAnalysis[i] / (sum * 2. * mFFTSize) : 0.);
+    }
+  }
+
+  /** Window the input FIFO into the frame buffers, and move the FIFO on by a hop */
+  void LoadFrame()
+  {
+    const WDL_FFT_REAL* pWindow = mAnalysisWindow.Get();
+
+    for (auto c = 0; c < mNChans; c++)
+    {
+      T* pFifo = GetInFifo(c);
+      WDL_FFT_REAL* pFrame = GetFrame(c);
+
+      for (auto i = 0; i < mFFTSize; i++)
+        pFrame[i] = (WDL_FFT_REAL) pFifo[i] * pWindow[i];
+
+      memmove(pFifo, pFifo + mHopSize, (mFFTSize - mHopSize) * sizeof(T));
+    }
+  }
+
+  /** Transform the frame buffers to spectra, call the spectrum function, and transform them back, with the synthesis window applied */
+  void TransformFrame()
+  {
+    const int half = mFFTSize / 2;
+    const int* pPermute = mPermute;
+    const WDL_FFT_REAL* pWindow = mSynthesisWindow.Get();
+
+    for (auto c = 0; c < mNChans; c++)
+    {
+      WDL_FFT_REAL* pFrame = GetFrame(c);
+      WDL_FFT_COMPLEX* pPacked = (WDL_FFT_COMPLEX*) pFrame;
+      WDL_FFT_COMPLEX* pBins = mBinPtrs.Get()[c];
+
+      WDL_real_fft(pFrame, mFFTSize, 0);
+
+      // WDL_real_fft packs the nyquist bin into the imaginary part of DC
+      pBins[0].re = pPacked[0].re;
+      pBins[0].im = 0.;
+      pBins[half].re = pPacked[0].im;
+      pBins[half].im = 0.;
+
+      for (auto k = 1; k < half; k++)
+        pBins[k] = pPacked[pPermute[k]];
+    }
+
+    if (mSpectrumFunc)
+      mSpectrumFunc(mBinPtrs.Get(), mNChans, mNBins);
+
+    for (auto c = 0; c < mNChans; c++)
+    {
+      WDL_FFT_REAL* pFrame = GetFrame(c);
+      WDL_FFT_COMPLEX* pPacked = (WDL_FFT_COMPLEX*) pFrame;
+      const WDL_FFT_COMPLEX* pBins = mBinPtrs.Get()[c];
+
+      pPacked[0].re = pBins[0].re;
+      pPacked[0].im = pBins[half].re;
+
+      for (auto k = 1; k < half; k++)
+        pPacked[pPermute[k]] = pBins[k];
+
+      WDL_real_fft(pFrame, mFFTSize, 1);
+
+      for (auto i = 0; i < mFFTSize; i++)
+        pFrame[i] *= pWindow[i];
+    }
+  }
+
+  /** Move the output accumulator on by a hop, and overlap-add the frame buffers if they hold a transformed frame */
+  void ShiftOutAccum(bool addFrame)
+  {
+    const int keep = mFFTSize - mHopSize;
+
+    for (auto c = 0; c < mNChans; c++)
+    {
+      T* pAccum = GetOutAccum(c);
+      memmove(pAccum, pAccum + mHopSize, keep * sizeof(T));
+      memset(pAccum + keep, 0, mHopSize * sizeof(T));
+
+      if (addFrame)
+      {
+        const WDL_FFT_REAL* pFrame = GetFrame(c);
+
+        for (auto i = 0; i < mFFTSize; i++)
+          pAccum[i] += (T) pFrame[i];
+      }
+    }
+  }
+
+  /** Wait for the worker thread to finish the frame it is transforming, if any */
+  void WaitForFrame()
+  {
+    if (!mThread.joinable())
+      return;
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCV.wait(lock, [this]() { return !mFramePending; });
+  }
+
+  void ThreadProc()
+  {
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    while (true)
+    {
+      mCV.wait(lock, [this]() { return mFramePending || !mRunning; });
+
+      if (!mRunning)
+        break;
+
+      lock.unlock();
+      TransformFrame();
+      lock.lock();
+
+      mFramePending = false;
+      mCV.notify_all();
+    }
+  }
+
+  int mFFTSize = 0;
+  int mHopSize = 0;
+  int mNChans = 0;
+  int mNBins = 0;
+  int mHopPos = 0; // samples into the current hop
+  const int* mPermute = nullptr;
+  WDL_TypedBuf<WDL_FFT_REAL> mAnalysisWindow;
+  WDL_TypedBuf<WDL_FFT_REAL> mSynthesisWindow;
+  WDL_TypedBuf<T> mInFifo; // the last fftSize input samples per channel
+  WDL_TypedBuf<T> mOutAccum; // overlap-added output per channel, the first hop of which is finished
+  WDL_TypedBuf<WDL_FFT_REAL> mFrame; // per channel, the windowed input frame, then the transformed output frame
+  WDL_TypedBuf<WDL_FFT_COMPLEX> mBins;
+  WDL_TypedBuf<WDL_FFT_COMPLEX*> mBinPtrs;
+  SpectrumFunc mSpectrumFunc;
+
+  std::thread mThread;
+  std::mutex mMutex;
+  std::condition_variable mCV;
+  bool mRunning = false; // guarded by mMutex
+  bool mFramePending = false; // guarded by mMutex, the worker is transforming mFrame
+  bool mFrameInFlight = false; // audio thread only, mFrame holds (or will hold) a transformed frame that hasn't been added to the output
+};
+
+END_IPLUG_NAMESPACE
@@ -19,13 +19,14 @@
 #include <complex>
 
 #include "IPlugPlatform.h"
+#include "IPlugQuality.h"
 
 BEGIN_IPLUG_NAMESPACE
 
 #define SVFMODES_VALIST "LowPass", "HighPass", "BandPass", "Notch", "Peak", "Bell", "LowPassShelf", "HighPassShelf"
 
 template<typename T = double, int NC = 1>
-class SVF
+class SVF : public IQualityTierListener
 {
 public:
 
@@ -85,22 +86,35 @@ public:
     return magnitude;
   }
 
-  void SetFreqCPS(double freqCPS) { mNewState.freq = Clip(freqCPS, 10, 20000.); }
+  void SetFreqCPS(double freqCPS) { mNewState.freq = Clip(freqCPS, 10., 20000.); }
 
   void SetQ(double Q) { mNewState.Q = Clip(Q, 0.1, 100.); }
 
-  void SetGain(double gainDB) { mNewState.gain = Clip(gainDB, -36, 36.); }
+  void SetGain(double gainDB) { mNewState.gain = Clip(gainDB, -36., 36.); }
 
   void SetMode(EMode mode) { mNewState.mode = mode; }
   
   void SetSampleRate(double sampleRate) { mNewState.sampleRate = sampleRate; }
 
+  /** At kQualityHigh and above, coefficient changes are interpolated across the block, rather than applied at its start, to avoid zipper noise when the filter is modulated */
+  void OnQualityTierChanged(EQualityTier tier) override { mInterpolateCoefficients = tier >= kQualityHigh; }
+
   void ProcessBlock(T** inputs, T** outputs, int nChans, int nFrames)
   {
     assert(nChans <= NC);
 
     if(mState != mNewState)
+    {
+      if (mInterpolateCoefficients && nFrames > 1)
+      {
+        const double prevCoeffs[6] = { m_a1, m_a2, m_a3, m_m0, m_m1, m_m2 };
+        UpdateCoefficients();
+        ProcessBlockInterpolated(inputs, outputs, nChans, nFrames, prevCoeffs);
+        return;
+      }
+
       UpdateCoefficients();
+    }
 
     for (auto c = 0; c < nChans; c++)
     {
@@ -132,6 +146,38 @@ public:
   }
 
 private:
+  void ProcessBlockInterpolated(T** inputs, T** outputs, int nChans, int nFrames, const double* prevCoeffs)
+  {
+    const double step = 1. / nFrames;
+    const double d_a1 = (m_a1 - prevCoeffs[0]) * step;
+    const double d_a2 = (m_a2 - prevCoeffs[1]) * step;
+    const double d_a3 = (m_a3 - prevCoeffs[2]) * step;
+    const double d_m0 = (m_m0 - prevCoeffs[3]) * step;
+    const double d_m1 = (m_m1 - prevCoeffs[4]) * step;
+    const double d_m2 = (m_m2 - prevCoeffs[5]) * step;
+
+    for (auto c = 0; c < nChans; c++)
+    {
+      for (auto s = 0; s < nFrames; s++)
+      {
+        // reaches the new coefficients on the last sample
+        const double i = s + 1.;
+        const double a1 = prevCoeffs[0] + i * d_a1;
+        const double a2 = prevCoeffs[1] + i * d_a2;
+        const double a3 = prevCoeffs[2] + i * d_a3;
+        const double v0 = (double) inputs[c][s];
+
+        mV3[c] = v0 - mIc2eq[c];
+        mV1[c] = a1 * mIc1eq[c] + a2 * mV3[c];
+        mV2[c] = mIc2eq[c] + a2 * mIc1eq[c] + a3 * mV3[c];
+        mIc1eq[c] = 2. * mV1[c] - mIc1eq[c];
+        mIc2eq[c] = 2. * mV2[c] - mIc2eq[c];
+
+        outputs[c][s] = (T) ((prevCoeffs[3] + i * d_m0) * v0 + (prevCoeffs[4] + i * d_m1) * mV1[c] + (prevCoeffs[5] + i * d_m2) * mV2[c]);
+      }
+    }
+  }
+
   void UpdateCoefficients()
   {
     mState = mNewState;
@@ -256,6 +302,7 @@ private:
   double m_m0 = 0.;
   double m_m1 = 0.;
   double m_m2 = 0.;
+  bool mInterpolateCoefficients = false;
 
   struct Settings
   {
@@ -8,6 +8,13 @@
  ==============================================================================
 */
 
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "wdltypes.h"
 #include "denormal.h"
 #include "IPlugConstants.h"
 
@@ -86,4 +93,265 @@ public:
 
 } WDL_FIXALIGN;
 
+/** A bank of parameter smoothers that stop doing any work once they have reached their targets, for plug-ins with many smoothed parameters.
+ * Unlike LogParamSmooth, whose one-pole filter runs for every sample forever, each smoother here ramps for a fixed number of samples after its target changes, and then snaps to the target and is settled:
+ * settled smoothers just fill their output with a constant, or can be skipped entirely, with the DSP using GetValue() when IsSmoothing() is \c false.
+ * The state is stored structure-of-arrays, and ramping smoothers are computed in chunks of kChunkSize samples from a precomputed table of kChunkSize steps,
+ * with no dependency between the samples of a chunk, so compilers vectorize the inner loop. Three types of ramp are supported:
+ * - kLinear: a straight line to the target over the smoothing time
+ * - kOnePole: the same exponential approach as LogParamSmooth, until it is within the settle threshold of the target
+ * - kMultiplicative: a constant ratio per sample (a straight line in dB or octaves) over the smoothing time, for gains and frequencies. If the value or target is zero or they have different signs, it is linear
+ * SetTarget() only writes the target, and the ramp starts in the next ProcessBlock(), so it can be called from another thread, like LogParamSmooth's inputs.
+ * Memory is allocated in the constructor and Resize(), nothing else allocates
+ * @tparam T The sample type */
+template<typename T = double>
+class SmootherBank
+{
+public:
+  enum class EType
+  {
+    kLinear,
+    kOnePole,
+    kMultiplicative
+  };
+
+  static constexpr int kChunkSize = 8;
+
+  SmootherBank(int nParams = 0, double sampleRate = DEFAULT_SAMPLE_RATE)
+  : mSampleRate(sampleRate)
+  {
+    Resize(nParams);
+  }
+
+  /** Set the number of smoothers, allocating their state. New smoothers are one-pole with a 5ms time and a value of 0. Not realtime safe
+   * @param nParams The number of smoothers */
+  void Resize(int nParams)
+  {
+    mNParams = std::max(nParams, 0);
+    mType.resize(mNParams, EType::kOnePole);
+    mTimeMs.resize(mNParams, 5.);
+    mCoeff.resize(mNParams, 0.);
+    mTarget.resize(mNParams, T(0));
+    mRampTarget.resize(mNParams, T(0));
+    mValue.resize(mNParams, T(0));
+    mBase.resize(mNParams, T(0));
+    mScale.resize(mNParams, T(0));
+    mSteps.resize(mNParams * kChunkSize, T(0));
+    mNRemaining.resize(mNParams, 0);
+    mRampedLastBlock.resize(mNParams, false);
+    mLinearRamp.resize(mNParams, false);
+
+    for (auto i = 0; i < mNParams; i++)
+      UpdateCoeff(i);
+  }
+
+  int GetNParams() const { return mNParams; }
+
+  void SetSampleRate(double sampleRate)
+  {
+    mSampleRate = sampleRate;
+
+    for (auto i = 0; i < mNParams; i++)
+      UpdateCoeff(i);
+  }
+
+  /** Set the type of ramp and the smoothing time for one smoother. Takes effect from its next target change
+   * @param idx The smoother
+   * @param type The type of ramp
+   * @param timeMs For kLinear and kMultiplicative the duration of the ramp, for kOnePole the time constant, as for LogParamSmooth */
+  void SetSmoother(int idx, EType type, double timeMs)
+  {
+    mType[idx] = type;
+    mTimeMs[idx] = timeMs;
+    UpdateCoeff(idx);
+  }
+
+  /** Set how close a kOnePole smoother has to get to its target before it snaps to it and settles
+   * @param threshold The absolute difference from the target */
+  void SetSettleThreshold(double threshold) { mSettleThreshold = threshold; }
+
+  /** Set the value a smoother ramps to, from the next ProcessBlock()
+   * @param idx The smoother
+   * @param target The target value */
+  void SetTarget(int idx, T target) { mTarget[idx] = target; }
+
+  /** Jump straight to a value, with no ramp, e.g. when the plug-in is reset. Call it from the audio thread, or before processing starts
+   * @param idx The smoother
+   * @param value The new value */
+  void SetValue(int idx, T value)
+  {
+    mTarget[idx] = mRampTarget[idx] = mValue[idx] = value;
+    mNRemaining[idx] = 0;
+  }
+
+  /** @return The value at the end of the last block, which is the target once the smoother has settled */
+  T GetValue(int idx) const { return mValue[idx]; }
+
+  /** @return \c true if the smoother's output changed during the last ProcessBlock(), \c false if it was constant (GetValue()) for the whole block */
+  bool IsSmoothing(int idx) const { return mRampedLastBlock[idx]; }
+
+  /** @return \c true if any smoother's output changed during the last ProcessBlock() */
+  bool IsAnySmoothing() const { return std::find(mRampedLastBlock.begin(), mRampedLastBlock.end(), true) != mRampedLastBlock.end(); }
+
+  /** Compute a block of smoothed values for every smoother
+   * @param outputs One buffer of at least nFrames for each smoother
+   * @param nFrames The number of frames
+   * @param fillSettled If \c false, the buffers of smoothers that are settled for the whole block are not written, and the DSP should use GetValue() when IsSmoothing() is \c false */
+  void ProcessBlock(T** outputs, int nFrames, bool fillSettled = true)
+  {
+    for (auto i = 0; i < mNParams; i++)
+    {
+      const T target = mTarget[i];
+
+      if (target != mRampTarget[i])
+        StartRamp(i, target);
+
+      T* pOutput = outputs[i];
+      int s = 0;
+
+      if (mNRemaining[i] > 0)
+      {
+        s = std::min(nFrames, mNRemaining[i]);
+        Ramp(i, pOutput, s);
+        mNRemaining[i] -= s;
+
+        if (!mNRemaining[i])
+          mValue[i] = mRampTarget[i];
+      }
+
+      mRampedLastBlock[i] = s > 0;
+
+      if (s < nFrames && (s > 0 || fillSettled))
+        std::fill(pOutput + s, pOutput + nFrames, mValue[i]);
+    }
+  }
+
+private:
+  void UpdateCoeff(int idx)
+  {
+    const double samples = mTimeMs[idx] * 0.001 * mSampleRate;
+    mCoeff[idx] = samples > 0. ? std::exp(-2. * PI / samples) : 0.;
+  }
+
+  void StartRamp(int idx, T target)
+  {
+    const T value = mValue[idx];
+    const int nRampSamples = static_cast<int>(mTimeMs[idx] * 0.001 * mSampleRate + 0.5);
+    T* pSteps = mSteps.data() + (idx * kChunkSize);
+    EType type = mType[idx];
+
+    mRampTarget[idx] = target;
+
+    if (type == EType::kMultiplicative && !(value * target > T(0)))
+      type = EType::kLinear;
+
+    mLinearRamp[idx] = type == EType::kLinear;
+
+    switch (type)
+    {
+      case EType::kLinear:
+      {
+        mNRemaining[idx] = nRampSamples;
+        mBase[idx] = value;
+        mScale[idx] = nRampSamples > 0 ? (target - value) / T(nRampSamples) : T(0);
+
+        for (auto j = 0; j < kChunkSize; j++)
+          pSteps[j] = T(j + 1);
+
+        break;
+      }
+      case EType::kMultiplicative:
+      {
+        const double ratio = nRampSamples > 0 ? std::pow((double) target / (double) value, 1. / nRampSamples) : 1.;
+        mNRemaining[idx] = nRampSamples;
+        mBase[idx] = T(0);
+        mScale[idx] = value;
+
+        for (auto j = 0; j < kChunkSize; j++)
+          pSteps[j] = T(std::pow(ratio, j + 1));
+
+        break;
+      }
+      case EType::kOnePole:
+      {
+        const double error = std::abs((double) (value - target));
+        const double coeff = mCoeff[idx];
+        mNRemaining[idx] = (error > mSettleThreshold && coeff > 0.) ? static_cast<int>(std::ceil(std::log(mSettleThreshold / error) / std::log(coeff))) : 0;
+        mBase[idx] = target;
+        mScale[idx] = value - target;
+
+        for (auto j = 0; j < kChunkSize; j++)
+          pSteps[j] = T(std::pow(coeff, j + 1));
+
+        break;
+      }
+    }
+
+    if (mNRemaining[idx] <= 0)
+    {
+      mNRemaining[idx] = 0;
+      mValue[idx] = target;
+    }
+  }
+
+  /** value = base + scale * step, where the steps are the sample indices of the chunk for a linear ramp (the base moves on each chunk),
+   * or the powers of the per sample factor for exponential ramps (the scale shrinks or grows each chunk) */
+  void Ramp(int idx, T* pOutput, int nFrames)
+  {
+    T steps[kChunkSize];
+    std::copy_n(mSteps.data() + (idx * kChunkSize), kChunkSize, steps);
+
+    const bool linear = mLinearRamp[idx];
+    T base = mBase[idx];
+    T scale = mScale[idx];
+    int s = 0;
+
+    for (; s + kChunkSize <= nFrames; s += kChunkSize)
+    {
+      for (auto j = 0; j < kChunkSize; j++)
+        pOutput[s + j] = base + scale * steps[j];
+
+      Advance(linear, base, scale, steps[kChunkSize - 1]);
+    }
+
+    const int nLeft = nFrames - s;
+
+    if (nLeft)
+    {
+      for (auto j = 0; j < nLeft; j++)
+        pOutput[s + j] = base + scale * steps[j];
+
+      Advance(linear, base, scale, steps[nLeft - 1]);
+    }
+
+    mBase[idx] = base;
+    mScale[idx] = scale;
+    mValue[idx] = pOutput[nFrames - 1];
+  }
+
+  static inline void Advance(bool linear, T& base, T& scale, T lastStep)
+  {
+    if (linear)
+      base += scale * lastStep;
+    else
+      scale *= lastStep;
+  }
+
+  int mNParams = 0;
+  double mSampleRate;
+  double mSettleThreshold = 1e-5;
+  std::vector<EType> mType;
+  std::vector<double> mTimeMs;
+  std::vector<double> mCoeff; // the one-pole coefficient
+  std::vector<T> mTarget; // written by SetTarget()
+  std::vector<T> mRampTarget; // the target of the current ramp
+  std::vector<T> mValue;
+  std::vector<T> mBase;
+  std::vector<T> mScale;
+  std::vector<T> mSteps; // kChunkSize per smoother
+  std::vector<int> mNRemaining; // samples left in the ramp, 0 when settled
+  std::vector<bool> mRampedLastBlock;
+  std::vector<bool> mLinearRamp; // the base moves rather than the scale, see Ramp()
+};
+
 END_IPLUG_NAMESPACE
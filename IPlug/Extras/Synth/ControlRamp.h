@@ -51,10 +51,11 @@ struct ControlRamp
    * @param buffer Pointer to the start of an output buffer.
    * @param startIdx Sample index of the start of the desired write within the buffer.
    * @param nFrames The number of samples to be written. */
-  void Write(float* buffer, int startIdx, int nFrames)
+  template<typename T = float>
+  void Write(T* buffer, int startIdx, int nFrames)
   {
-    float val = static_cast<float>(startValue);
-    float dv = static_cast<float>((endValue - startValue)/(transitionEnd - transitionStart));
+    T val = static_cast<T>(startValue);
+    T dv = static_cast<T>((endValue - startValue)/(transitionEnd - transitionStart));
 
     for(int i=startIdx; i<startIdx + transitionStart; ++i)
     {
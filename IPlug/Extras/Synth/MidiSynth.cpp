@@ -431,33 +431,21 @@ bool MidiSynth::ProcessBlock(sample** inputs, sample** outputs, int nInputs, int
       }
 
       mVoiceAllocator.ProcessEvents(blockSize, mSampleTime);
-      mVoiceAllocator.ProcessVoices(inputs, outputs, nInputs, nOutputs, startIndex, blockSize);
+      ProcessVoices(inputs, outputs, nInputs, nOutputs, startIndex, blockSize);
 
       samplesRemaining -= blockSize;
       startIndex += blockSize;
       mSampleTime += blockSize;
     }
 
-    bool voicesbusy = false;
-    int activeCount = 0;
+    // the voice allocator keeps a list of the voices that were still busy at the end of the block
+    const int activeCount = mVoiceAllocator.NActiveVoices();
 
-    for(int v = 0; v < NVoices(); v++)
-    {
-      bool busy = GetVoice(v)->GetBusy();
-      voicesbusy |= busy;
-
-      activeCount += (busy==true);
 #if DEBUG_VOICE_COUNT
-      if(GetVoice(v)->GetBusy()) printf("X");
-      else DBGMSG("_");
-    }
-    DBGMSG("\n");
     DBGMSG("Num Voices busy %i\n", activeCount);
-#else
-    }
 #endif
 
-    mVoicesAreActive = voicesbusy;
+    mVoicesAreActive = activeCount > 0;
 
     mMidiQueue.Flush(nFrames);
   }
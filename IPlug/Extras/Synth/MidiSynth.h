@@ -44,7 +44,7 @@ public:
 #pragma mark - MidiSynth class
 
   MidiSynth(VoiceAllocator::EPolyMode mode, int blockSize = kDefaultBlockSize);
-  ~MidiSynth();
+  virtual ~MidiSynth();
 
   MidiSynth(const MidiSynth&) = delete;
   MidiSynth& operator=(const MidiSynth&) = delete;
@@ -63,6 +63,9 @@ public:
   void SetVoicesActive(bool active)
   {
     mVoicesAreActive = active;
+
+    if(active)
+      mVoiceAllocator.ActivateAllVoices();
   }
   
   void InitBasicMPE()
@@ -154,6 +157,22 @@ public:
    * @return \c true if the synth is silent */
   bool ProcessBlock(sample** inputs, sample** outputs, int nInputs, int nOutputs, int nFrames);
 
+protected:
+  /** Called once per sub-block by ProcessBlock() to render the active voices.
+   * The default implementation calls SynthVoice::ProcessSamplesAccumulating() on each active voice, see TypedMidiSynth for a statically dispatched version
+   * @param inputs Pointer to input Arrays
+   * @param outputs Pointer to output Arrays
+   * @param nInputs The number of input channels that contain valid data
+   * @param nOutputs The number of output channels that contain valid data
+   * @param startIdx The start index of the block of samples to process
+   * @param nFrames The number of samples to process in this block */
+  virtual void ProcessVoices(sample** inputs, sample** outputs, int nInputs, int nOutputs, int startIdx, int nFrames)
+  {
+    mVoiceAllocator.ProcessVoices(inputs, outputs, nInputs, nOutputs, startIdx, nFrames);
+  }
+
+  VoiceAllocator mVoiceAllocator;
+
 private:
 
   // maintain the state for one MIDI channel including RPN receipt state and pitch bend range.
@@ -193,7 +212,6 @@ private:
   void HandleRPN(IMidiMsg msg);
 
   // basic MIDI data
-  VoiceAllocator mVoiceAllocator;
   uint16_t mUnisonVoices{1};
   IMidiQueue mMidiQueue;
   float mVelocityLUT[128];
@@ -0,0 +1,212 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+ */
+
+#pragma once
+
+/**
+ * @file
+ * @copydoc ModMatrix
+ */
+
+#include <array>
+#include <atomic>
+#include <cstring>
+
+#include "IPlugPlatform.h"
+
+BEGIN_IPLUG_NAMESPACE
+
+/** A block based modulation matrix, to route modulation sources to destinations in a SynthVoice (or anywhere else).
+ * Sources are buffers of samples, which may be per-voice (e.g. envelopes, or the MPE pressure/timbre VoiceInputs written with ControlRamp::Write())
+ * or global (e.g. a global LFO or a smoothed parameter, where every voice gets the same pointer).
+ * The routes are edited on the UI thread with SetRoute()/ClearRoute(), and then Commit() "compiles" them into a compact connection list,
+ * containing only the active routes, sorted by destination. The compiled lists are exchanged with the audio thread via a lock-free triple buffer,
+ * so nothing is allocated or locked when routes change.
+ * On the audio thread call BeginBlock() once per processing block (before any voices are processed), and then ProcessBlock() in each voice
+ * in order to sum the routed sources into the destination buffers, one vectorizable multiply-add loop per route.
+ * @tparam T The sample type
+ * @tparam NSOURCES The number of modulation sources
+ * @tparam NDESTS The number of modulation destinations
+ * @tparam MAXROUTES The maximum number of routes */
+template<typename T = double, int NSOURCES = 16, int NDESTS = 16, int MAXROUTES = 64>
+class ModMatrix
+{
+public:
+  struct Route
+  {
+    int mSource = -1;
+    int mDest = -1;
+    T mDepth = T(0);
+
+    bool IsActive() const { return mSource >= 0 && mDest >= 0 && mDepth != T(0); }
+  };
+
+  ModMatrix()
+  {
+    Commit();
+  }
+
+  ModMatrix(const ModMatrix&) = delete;
+  ModMatrix& operator=(const ModMatrix&) = delete;
+
+#pragma mark - UI thread
+
+  /** Set a route. The change is only heard after Commit() is called. Should be called on the UI thread
+   * @param routeIdx The slot in the matrix (0 - MAXROUTES-1)
+   * @param source The source index (0 - NSOURCES-1)
+   * @param dest The destination index (0 - NDESTS-1)
+   * @param depth The amount of the source to add to the destination
+   * @return \c true if the arguments were valid */
+  bool SetRoute(int routeIdx, int source, int dest, T depth)
+  {
+    if (routeIdx < 0 || routeIdx >= MAXROUTES || source < 0 || source >= NSOURCES || dest < 0 || dest >= NDESTS)
+      return false;
+
+    mRoutes[routeIdx] = {source, dest, depth};
+    return true;
+  }
+
+  /** Set the depth of an existing route. The change is only heard after Commit() is called. Should be called on the UI thread */
+  void SetRouteDepth(int routeIdx, T depth)
+  {
+    if (routeIdx >= 0 && routeIdx < MAXROUTES)
+      mRoutes[routeIdx].mDepth = depth;
+  }
+
+  /** Remove a route. The change is only heard after Commit() is called. Should be called on the UI thread */
+  void ClearRoute(int routeIdx)
+  {
+    if (routeIdx >= 0 && routeIdx < MAXROUTES)
+      mRoutes[routeIdx] = Route();
+  }
+
+  void ClearAllRoutes()
+  {
+    mRoutes.fill(Route());
+  }
+
+  const Route& GetRoute(int routeIdx) const { return mRoutes[routeIdx]; }
+
+  /** Compile the routes into a connection list and pass it to the audio thread. Doesn't allocate or lock. Should be called on the UI thread */
+  void Commit()
+  {
+    CompiledRoutes& compiled = mCompiled[mBackIdx];
+    compiled.mNRoutes = 0;
+
+    // counting sort by destination, so each destination's routes are contiguous
+    for (auto d = 0; d < NDESTS; d++)
+    {
+      compiled.mDestStart[d] = compiled.mNRoutes;
+
+      for (auto r = 0; r < MAXROUTES; r++)
+      {
+        const Route& route = mRoutes[r];
+
+        if (route.IsActive() && route.mDest == d)
+        {
+          compiled.mSource[compiled.mNRoutes] = route.mSource;
+          compiled.mDepth[compiled.mNRoutes] = route.mDepth;
+          compiled.mNRoutes++;
+        }
+      }
+    }
+
+    compiled.mDestStart[NDESTS] = compiled.mNRoutes;
+
+    mBackIdx = mPendingIdx.exchange(mBackIdx | kDirty, std::memory_order_acq_rel) & ~kDirty;
+  }
+
+#pragma mark - Audio thread
+
+  /** Pick up any routes committed since the last block. Call once per processing block, before any ProcessBlock() calls */
+  void BeginBlock()
+  {
+    if (mPendingIdx.load(std::memory_order_relaxed) & kDirty)
+      mFrontIdx = mPendingIdx.exchange(mFrontIdx, std::memory_order_acq_rel) & ~kDirty;
+  }
+
+  /** @return \c true if any route targets the destination. If not, the destination buffer will be zeros after ProcessBlock(), and the DSP can take a scalar path */
+  bool IsDestModulated(int dest) const
+  {
+    const CompiledRoutes& compiled = mCompiled[mFrontIdx];
+    return compiled.mDestStart[dest + 1] > compiled.mDestStart[dest];
+  }
+
+  /** @return \c true if any route uses the source. If not, the source doesn't need to be computed */
+  bool IsSourceUsed(int source) const
+  {
+    const CompiledRoutes& compiled = mCompiled[mFrontIdx];
+
+    for (auto r = 0; r < compiled.mNRoutes; r++)
+    {
+      if (compiled.mSource[r] == source)
+        return true;
+    }
+
+    return false;
+  }
+
+  /** Sum the routed sources into the destination buffers
+   * @param sources NSOURCES source buffer pointers. Sources that are not used by any route may be nullptr
+   * @param dests NDESTS destination buffer pointers, which will be overwritten
+   * @param startIdx The start index of the block of samples to process
+   * @param nFrames The number of samples to process */
+  void ProcessBlock(T** sources, T** dests, int startIdx, int nFrames) const
+  {
+    const CompiledRoutes& compiled = mCompiled[mFrontIdx];
+
+    for (auto d = 0; d < NDESTS; d++)
+    {
+      T* pDest = dests[d] + startIdx;
+      const int start = compiled.mDestStart[d];
+      const int end = compiled.mDestStart[d + 1];
+
+      if (start == end)
+      {
+        memset(pDest, 0, nFrames * sizeof(T));
+        continue;
+      }
+
+      const T* pSrc = sources[compiled.mSource[start]] + startIdx;
+      T depth = compiled.mDepth[start];
+
+      for (auto s = 0; s < nFrames; s++)
+        pDest[s] = pSrc[s] * depth;
+
+      for (auto r = start + 1; r < end; r++)
+      {
+        pSrc = sources[compiled.mSource[r]] + startIdx;
+        depth = compiled.mDepth[r];
+
+        for (auto s = 0; s < nFrames; s++)
+          pDest[s] += pSrc[s] * depth;
+      }
+    }
+  }
+
+private:
+  struct CompiledRoutes
+  {
+    int mNRoutes = 0;
+    int mDestStart[NDESTS + 1] = {};
+    int mSource[MAXROUTES] = {};
+    T mDepth[MAXROUTES] = {};
+  };
+
+  static constexpr int kDirty = 1 << 2;
+
+  std::array<Route, MAXROUTES> mRoutes; // UI thread only
+  CompiledRoutes mCompiled[3];
+  int mBackIdx = 0; // UI thread only
+  int mFrontIdx = 1; // audio thread only
+  std::atomic<int> mPendingIdx{2};
+};
+
+END_IPLUG_NAMESPACE
@@ -0,0 +1,343 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+ */
+
+#include "SampleStreamer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+
+#ifndef OS_WIN
+#include <unistd.h>
+#endif
+
+#include "fileread.h"
+
+using namespace iplug;
+
+static inline uint32_t ReadLE32(const unsigned char* p)
+{
+  return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static inline uint16_t ReadLE16(const unsigned char* p)
+{
+  return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+#pragma mark - SampleFile
+
+SampleFile::SampleFile()
+{
+}
+
+SampleFile::~SampleFile()
+{
+}
+
+bool SampleFile::Load(const char* path, int preloadFrames, bool useMemoryMap)
+{
+  Unload();
+
+  // files under 4GB are mapped whole, bigger ones fall back to buffered reads
+  mFile = std::make_unique<WDL_FileRead>(path, 0, 65536, 4, 0, useMemoryMap ? 0xFFFFFFFF : 0);
+
+  if (!mFile->IsOpen() || !ParseHeader())
+  {
+    Unload();
+    return false;
+  }
+
+  mReadBuf.Resize(kReadChunkFrames * mFrameBytes);
+
+  mNPreloadedFrames = (int) std::min<int64_t>(std::max(preloadFrames, 0), mNFrames);
+  mHead.Resize(mNPreloadedFrames * mNChans);
+
+  float* ptrs[kMaxNChans];
+
+  for (auto c = 0; c < mNChans; c++)
+    ptrs[c] = mHead.Get() + (c * mNPreloadedFrames);
+
+  if (ReadFrames(0, ptrs, mNPreloadedFrames) != mNPreloadedFrames)
+  {
+    Unload();
+    return false;
+  }
+
+  return true;
+}
+
+void SampleFile::Unload()
+{
+  mFile = nullptr;
+  mReadBuf.Resize(0);
+  mHead.Resize(0);
+  mDataOffset = 0;
+  mNFrames = 0;
+  mNChans = 0;
+  mFrameBytes = 0;
+  mNPreloadedFrames = 0;
+}
+
+bool SampleFile::ParseHeader()
+{
+  unsigned char buf[40];
+
+  if (mFile->Read(buf, 12) != 12 || memcmp(buf, "RIFF", 4) || memcmp(buf + 8, "WAVE", 4))
+    return false;
+
+  const int64_t fileSize = mFile->GetSize();
+  int64_t pos = 12;
+  bool gotFormat = false;
+
+  while (pos + 8 <= fileSize)
+  {
+    if (mFile->SetPosition(pos) || mFile->Read(buf, 8) != 8)
+      return false;
+
+    const int64_t chunkSize = ReadLE32(buf + 4);
+
+    if (!memcmp(buf, "fmt ", 4))
+    {
+      if (chunkSize < 16 || mFile->Read(buf, (int) std::min<int64_t>(chunkSize, 40)) < 16)
+        return false;
+
+      int formatTag = ReadLE16(buf);
+      mNChans = ReadLE16(buf + 2);
+      mSampleRate = (double) ReadLE32(buf + 4);
+      const int bitsPerSample = ReadLE16(buf + 14);
+
+      if (formatTag == 0xFFFE && chunkSize >= 40) // WAVE_FORMAT_EXTENSIBLE, the format is in the first two bytes of the subformat GUID
+        formatTag = ReadLE16(buf + 24);
+
+      if (formatTag == 1 && bitsPerSample == 16) mFormat = EFormat::kPCM16;
+      else if (formatTag == 1 && bitsPerSample == 24) mFormat = EFormat::kPCM24;
+      else if (formatTag == 1 && bitsPerSample == 32) mFormat = EFormat::kPCM32;
+      else if (formatTag == 3 && bitsPerSample == 32) mFormat = EFormat::kFloat32;
+      else return false;
+
+      if (mNChans < 1 || mNChans > kMaxNChans || mSampleRate <= 0.)
+        return false;
+
+      mFrameBytes = mNChans * (bitsPerSample / 8);
+      gotFormat = true;
+    }
+    else if (!memcmp(buf, "data", 4))
+    {
+      if (!gotFormat)
+        return false;
+
+      mDataOffset = pos + 8;
+      // the size can be wrong in files that weren't finalized, or > 4GB, so trust the file size if it's smaller
+      const int64_t dataSize = std::min<int64_t>(chunkSize == 0xFFFFFFFF ? fileSize : chunkSize, fileSize - mDataOffset);
+      mNFrames = dataSize / mFrameBytes;
+      return mNFrames > 0;
+    }
+
+    pos += 8 + chunkSize + (chunkSize & 1);
+  }
+
+  return false;
+}
+
+void SampleFile::Convert(const unsigned char* pSrc, float** dest, int destOffset, int nFrames) const
+{
+  const int nChans = mNChans;
+
+  switch (mFormat)
+  {
+    case EFormat::kPCM16:
+      for (auto s = 0; s < nFrames; s++)
+        for (auto c = 0; c < nChans; c++, pSrc += 2)
+          dest[c][destOffset + s] = (float) (int16_t) ReadLE16(pSrc) * (1.f / 32768.f);
+      break;
+    case EFormat::kPCM24:
+      for (auto s = 0; s < nFrames; s++)
+        for (auto c = 0; c < nChans; c++, pSrc += 3)
+          dest[c][destOffset + s] = (float) ((int32_t) (((uint32_t) pSrc[0] << 8) | ((uint32_t) pSrc[1] << 16) | ((uint32_t) pSrc[2] << 24)) >> 8) * (1.f / 8388608.f);
+      break;
+    case EFormat::kPCM32:
+      for (auto s = 0; s < nFrames; s++)
+        for (auto c = 0; c < nChans; c++, pSrc += 4)
+          dest[c][destOffset + s] = (float) ((double) (int32_t) ReadLE32(pSrc) * (1. / 2147483648.));
+      break;
+    case EFormat::kFloat32:
+      for (auto s = 0; s < nFrames; s++)
+      {
+        for (auto c = 0; c < nChans; c++, pSrc += 4)
+        {
+          const uint32_t bits = ReadLE32(pSrc);
+          memcpy(&dest[c][destOffset + s], &bits, 4);
+        }
+      }
+      break;
+  }
+}
+
+int SampleFile::ReadFrames(int64_t startFrame, float** dest, int nFrames)
+{
+  if (!mFile || startFrame < 0 || startFrame >= mNFrames)
+    return 0;
+
+  nFrames = (int) std::min<int64_t>(nFrames, mNFrames - startFrame);
+
+  if (mFile->SetPosition(mDataOffset + (startFrame * mFrameBytes)))
+    return 0;
+
+  int nRead = 0;
+
+  while (nRead < nFrames)
+  {
+    const int toRead = std::min(nFrames - nRead, kReadChunkFrames);
+    const int gotFrames = mFile->Read(mReadBuf.Get(), toRead * mFrameBytes) / mFrameBytes;
+
+    Convert(mReadBuf.Get(), dest, nRead, gotFrames);
+    nRead += gotFrames;
+
+    if (gotFrames < toRead)
+      break;
+  }
+
+  return nRead;
+}
+
+#pragma mark - SampleStream
+
+void SampleStream::Allocate(int nChans, int capacityFrames)
+{
+  mNChans = std::min(std::max(nChans, 1), SampleFile::kMaxNChans);
+
+  int shift = 0;
+  while ((1 << shift) < capacityFrames)
+    shift++;
+
+  mCapacityShift = shift;
+  mCapacity = 1 << shift;
+  mMask = mCapacity - 1;
+  mBuffer.Resize(mCapacity * mNChans);
+  memset(mBuffer.Get(), 0, mBuffer.GetSize() * sizeof(float));
+}
+
+int SampleStream::Service(int maxFrames)
+{
+  const uint32_t gen = mRequestGen.load(std::memory_order_acquire);
+
+  if (gen != mServedGen.load(std::memory_order_relaxed))
+  {
+    mProducerFile = mRequestFile.load(std::memory_order_relaxed);
+    mProducerFrame = mRequestStart.load(std::memory_order_relaxed);
+    mWriteFrame.store(mProducerFrame, std::memory_order_relaxed);
+    mServedGen.store(gen, std::memory_order_release);
+  }
+
+  if (!mProducerFile || !mCapacity || mProducerFile->NChans() > mNChans)
+    return 0;
+
+  const int64_t readFrame = mReadFrame.load(std::memory_order_acquire);
+
+  // the voice underran and has moved on, don't waste time reading frames it has skipped
+  if (mProducerFrame < readFrame)
+    mProducerFrame = readFrame;
+
+  const int64_t endFrame = std::min(mProducerFile->NFrames(), readFrame + mCapacity);
+  int toWrite = (int) std::min<int64_t>(endFrame - mProducerFrame, maxFrames);
+
+  if (toWrite <= 0)
+    return 0;
+
+  const int nChans = mProducerFile->NChans();
+  int nWritten = 0;
+
+  while (toWrite > 0)
+  {
+    const int idx = (int) (mProducerFrame & mMask);
+    const int run = std::min(toWrite, mCapacity - idx);
+    float* ptrs[SampleFile::kMaxNChans];
+
+    for (auto c = 0; c < nChans; c++)
+      ptrs[c] = mBuffer.Get() + (c << mCapacityShift) + idx;
+
+    const int nRead = mProducerFile->ReadFrames(mProducerFrame, ptrs, run);
+
+    mProducerFrame += nRead;
+    nWritten += nRead;
+    toWrite -= run;
+
+    if (nRead < run)
+      break;
+  }
+
+  mWriteFrame.store(mProducerFrame, std::memory_order_release);
+
+  return nWritten;
+}
+
+#pragma mark - SampleStreamer
+
+SampleStreamer::SampleStreamer(int readChunkFrames, int pollIntervalMs)
+: mReadChunkFrames(readChunkFrames)
+, mPollIntervalMs(pollIntervalMs)
+{
+}
+
+SampleStreamer::~SampleStreamer()
+{
+  Stop();
+}
+
+void SampleStreamer::AddStream(SampleStream* pStream)
+{
+  assert(!IsRunning());
+  mStreams.push_back(pStream);
+}
+
+void SampleStreamer::ClearStreams()
+{
+  assert(!IsRunning());
+  mStreams.clear();
+}
+
+void SampleStreamer::Start()
+{
+  if (IsRunning())
+    return;
+
+  mRunning = true;
+  mThread = std::thread(&SampleStreamer::ThreadProc, this);
+}
+
+void SampleStreamer::Stop()
+{
+  if (!IsRunning())
+    return;
+
+  mRunning = false;
+  mThread.join();
+}
+
+int SampleStreamer::ServiceStreams()
+{
+  int nFrames = 0;
+
+  for (auto* pStream : mStreams)
+    nFrames += pStream->Service(mReadChunkFrames);
+
+  return nFrames;
+}
+
+void SampleStreamer::ThreadProc()
+{
+  while (mRunning)
+  {
+    if (!ServiceStreams())
+      std::this_thread::sleep_for(std::chrono::milliseconds(mPollIntervalMs));
+  }
+}
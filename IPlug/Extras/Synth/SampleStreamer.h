@@ -0,0 +1,233 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+ */
+
+#pragma once
+
+/**
+ * @file
+ * @brief Classes for streaming sample data from disk: SampleFile, SampleStream and SampleStreamer
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "IPlugPlatform.h"
+
+#include "heapbuf.h"
+
+class WDL_FileRead;
+
+BEGIN_IPLUG_NAMESPACE
+
+/** A .wav file (16, 24 or 32 bit integer PCM, or 32 bit float), whose first frames (the "head") are loaded into memory
+ * so that a voice can start playing it immediately, while the rest of the file is read from disk by a SampleStreamer.
+ * The file stays open, memory mapped if possible, but the mapping is only ever touched by the thread that calls ReadFrames(),
+ * so page faults never happen on the audio thread. */
+class SampleFile
+{
+public:
+  static constexpr int kMaxNChans = 8;
+
+  SampleFile();
+  ~SampleFile();
+
+  SampleFile(const SampleFile&) = delete;
+  SampleFile& operator=(const SampleFile&) = delete;
+
+  /** Open a file and load its head. Allocates and does file IO, so don't call it on the audio thread
+   * @param path UTF-8 path to a .wav file
+   * @param preloadFrames The number of sample frames to keep in memory, the whole file if it is shorter
+   * @param useMemoryMap If \c true the file is memory mapped for streaming (if it is smaller than 4GB), otherwise it is read with buffered IO
+   * @return \c true on success */
+  bool Load(const char* path, int preloadFrames, bool useMemoryMap = true);
+
+  /** Close the file and free the head */
+  void Unload();
+
+  bool IsLoaded() const { return mNFrames > 0; }
+  int NChans() const { return mNChans; }
+  int64_t NFrames() const { return mNFrames; }
+  double GetSampleRate() const { return mSampleRate; }
+
+  /** @return The number of frames in memory. If this is NFrames() the file doesn't need to be streamed */
+  int NPreloadedFrames() const { return mNPreloadedFrames; }
+
+  /** @return A pointer to the preloaded frames of a channel, NPreloadedFrames() long */
+  const float* GetHead(int chan) const { return mHead.Get() + (chan * mNPreloadedFrames); }
+
+  /** @return The number of bytes of memory used by the head */
+  size_t GetMemoryUsage() const { return mHead.GetSize() * sizeof(float); }
+
+  /** Read frames from the file, converting to float and deinterleaving. Not thread safe, only call it from one thread at a time (normally the SampleStreamer thread)
+   * @param startFrame The first frame to read
+   * @param dest NChans() channel pointers to write to
+   * @param nFrames The number of frames to read
+   * @return The number of frames read, which is less than nFrames at the end of the file or if there was an IO error */
+  int ReadFrames(int64_t startFrame, float** dest, int nFrames);
+
+private:
+  enum class EFormat { kPCM16, kPCM24, kPCM32, kFloat32 };
+
+  bool ParseHeader();
+  void Convert(const unsigned char* pSrc, float** dest, int destOffset, int nFrames) const;
+
+  static constexpr int kReadChunkFrames = 4096;
+
+  std::unique_ptr<WDL_FileRead> mFile;
+  WDL_TypedBuf<unsigned char> mReadBuf;
+  WDL_TypedBuf<float> mHead;
+  int64_t mDataOffset = 0;
+  int64_t mNFrames = 0;
+  double mSampleRate = 44100.;
+  int mNChans = 0;
+  int mFrameBytes = 0;
+  int mNPreloadedFrames = 0;
+  EFormat mFormat = EFormat::kPCM16;
+};
+
+/** A single producer single consumer ring buffer of sample frames, that follows the playback position of one voice in a SampleFile.
+ * The voice (the consumer, on the audio thread) calls Start() with the frame it wants streaming to begin from, and the SampleStreamer thread (the producer)
+ * fills the ring ahead of the voice's read position. Frames are addressed by their absolute position in the file, and every Start() bumps a request generation
+ * that the producer acknowledges before any frames are considered valid, so a voice that is re-triggered never reads data meant for the previous note.
+ * Nothing is locked or allocated after Allocate() */
+class SampleStream
+{
+public:
+  SampleStream() = default;
+
+  SampleStream(const SampleStream&) = delete;
+  SampleStream& operator=(const SampleStream&) = delete;
+
+  /** Allocate the ring buffer. Don't call this while the SampleStreamer is running
+   * @param nChans The maximum number of channels in the files that will be streamed, files with more channels will not be streamed
+   * @param capacityFrames The size of the ring in frames, rounded up to a power of two */
+  void Allocate(int nChans, int capacityFrames);
+
+  int NChans() const { return mNChans; }
+  int GetCapacity() const { return mCapacity; }
+
+  /** @return The number of bytes of memory used by the ring */
+  size_t GetMemoryUsage() const { return mBuffer.GetSize() * sizeof(float); }
+
+#pragma mark - Audio thread
+
+  /** Start streaming a file
+   * @param pFile The file to stream, or nullptr to stop streaming
+   * @param startFrame The first frame the voice will need from the ring, usually SampleFile::NPreloadedFrames() */
+  void Start(SampleFile* pFile, int64_t startFrame)
+  {
+    mReadFrame.store(startFrame, std::memory_order_relaxed);
+    mRequestFile.store(pFile, std::memory_order_relaxed);
+    mRequestStart.store(startFrame, std::memory_order_relaxed);
+    mRequestGen.store(++mConsumerGen, std::memory_order_release);
+  }
+
+  void Stop() { Start(nullptr, 0); }
+
+  /** Call once per block before reading frames
+   * @return The frame after the last valid frame in the ring, or -1 if the producer hasn't picked up the last Start() yet */
+  int64_t GetAvailableEnd() const
+  {
+    if (mServedGen.load(std::memory_order_acquire) != mConsumerGen)
+      return -1;
+
+    return mWriteFrame.load(std::memory_order_acquire);
+  }
+
+  /** @return A frame from the ring. Only valid for frames between the last SetReadPosition() and GetAvailableEnd() */
+  inline float GetFrame(int chan, int64_t frame) const
+  {
+    return mBuffer.Get()[(chan << mCapacityShift) + (int) (frame & mMask)];
+  }
+
+  /** Tell the producer which frames can be overwritten. Call at the end of each block
+   * @param frame The lowest frame the voice may read in future */
+  void SetReadPosition(int64_t frame) { mReadFrame.store(frame, std::memory_order_release); }
+
+  /** Called by the voice when it needed frames that weren't there in time */
+  void AddUnderrun() { mNUnderruns.fetch_add(1, std::memory_order_relaxed); }
+
+  /** @return The number of blocks where the voice ran out of streamed data, can be called from any thread */
+  uint32_t GetNUnderruns() const { return mNUnderruns.load(std::memory_order_relaxed); }
+
+  void ResetNUnderruns() { mNUnderruns.store(0, std::memory_order_relaxed); }
+
+private:
+  /** Called by SampleStreamer, on its thread
+   * @return The number of frames written */
+  int Service(int maxFrames);
+
+  WDL_TypedBuf<float> mBuffer;
+  int mNChans = 0;
+  int mCapacity = 0;
+  int mCapacityShift = 0;
+  int64_t mMask = 0;
+
+  // written by the consumer
+  std::atomic<SampleFile*> mRequestFile{nullptr};
+  std::atomic<int64_t> mRequestStart{0};
+  std::atomic<uint32_t> mRequestGen{0};
+  std::atomic<int64_t> mReadFrame{0};
+  std::atomic<uint32_t> mNUnderruns{0};
+  uint32_t mConsumerGen = 0;
+
+  // written by the producer
+  std::atomic<uint32_t> mServedGen{0};
+  std::atomic<int64_t> mWriteFrame{0};
+  SampleFile* mProducerFile = nullptr;
+  int64_t mProducerFrame = 0;
+
+  friend class SampleStreamer;
+};
+
+/** Owns a background thread that keeps a set of SampleStreams topped up from their SampleFiles.
+ * The thread polls the streams, reading up to readChunkFrames per stream per pass, and sleeps for a short time when there is nothing to do.
+ * The worst case time between a voice starting and the first streamed frames arriving is about one poll interval plus one pass of reads,
+ * which is what the preloaded head of each SampleFile needs to cover */
+class SampleStreamer
+{
+public:
+  /** @param readChunkFrames The maximum number of frames to read for one stream in one go
+   * @param pollIntervalMs How long the thread sleeps when all the streams are full */
+  SampleStreamer(int readChunkFrames = 8192, int pollIntervalMs = 1);
+  ~SampleStreamer();
+
+  SampleStreamer(const SampleStreamer&) = delete;
+  SampleStreamer& operator=(const SampleStreamer&) = delete;
+
+  /** Add a stream to service. Only call this when the thread isn't running */
+  void AddStream(SampleStream* pStream);
+
+  /** Remove all the streams. Only call this when the thread isn't running */
+  void ClearStreams();
+
+  void Start();
+  void Stop();
+  bool IsRunning() const { return mThread.joinable(); }
+
+  /** Do one pass of reads on the calling thread. This is what the thread calls in a loop, but it can also be used when the thread is not running,
+   * for instance to render offline faster than realtime without underruns. Does file IO, so don't call it on the audio thread in a realtime context
+   * @return The number of frames read */
+  int ServiceStreams();
+
+private:
+  void ThreadProc();
+
+  std::vector<SampleStream*> mStreams;
+  std::thread mThread;
+  std::atomic<bool> mRunning{false};
+  int mReadChunkFrames;
+  int mPollIntervalMs;
+};
+
+END_IPLUG_NAMESPACE
@@ -0,0 +1,393 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+ */
+
+#pragma once
+
+/**
+ * @file
+ * @brief A disk streaming sample player: SamplerVoice and StreamingSampler
+ */
+
+#include <cmath>
+#include <functional>
+#include <vector>
+
+#include "IPlugPlatform.h"
+
+#include "SampleStreamer.h"
+#include "TypedMidiSynth.h"
+#include "ADSREnvelope.h"
+
+BEGIN_IPLUG_NAMESPACE
+
+/** Maps a range of MIDI keys to a SampleFile, recorded at mRootKey */
+struct SampleZone
+{
+  SampleFile* mFile = nullptr;
+  int mRootKey = 60;
+  int mLoKey = 0;
+  int mHiKey = 127;
+};
+
+/** A SynthVoice that plays a SampleFile, chosen from a list of SampleZones by the key that triggered the voice.
+ * The first SampleFile::NPreloadedFrames() frames are played from memory, so the voice can start immediately, and the rest is read from the voice's SampleStream,
+ * which a SampleStreamer fills on a background thread. If the streamed data doesn't arrive in time the voice outputs silence for the missing frames (rather than stalling),
+ * and counts an underrun. Pitch is applied with 4 point cubic hermite interpolation. */
+class SamplerVoice : public SynthVoice
+{
+public:
+  SamplerVoice()
+  : mAMPEnv("sampler", [&]() { StartPlayback(); })
+  {
+    mAMPEnv.SetStageTime(ADSREnvelope<sample>::kAttack, 1.);
+    mAMPEnv.SetStageTime(ADSREnvelope<sample>::kDecay, 10.);
+    mAMPEnv.SetStageTime(ADSREnvelope<sample>::kRelease, 200.);
+  }
+
+  /** Set the zones and stream that the voice uses, normally done by StreamingSampler. Don't call this while the voice is playing */
+  void Setup(const std::vector<SampleZone>* pZones, SampleStream* pStream)
+  {
+    mZones = pZones;
+    mStream = pStream;
+  }
+
+  void SetEnvelope(double attackMs, double releaseMs)
+  {
+    mAMPEnv.SetStageTime(ADSREnvelope<sample>::kAttack, attackMs);
+    mAMPEnv.SetStageTime(ADSREnvelope<sample>::kRelease, releaseMs);
+  }
+
+  bool GetBusy() const override
+  {
+    return mAMPEnv.GetBusy();
+  }
+
+  void Trigger(double level, bool isRetrigger) override
+  {
+    if (isRetrigger)
+    {
+      // keep playing the old note while the envelope ramps down, StartPlayback() is called from the envelope's reset function
+      mAMPEnv.Retrigger(level);
+    }
+    else
+    {
+      StartPlayback();
+      mAMPEnv.Start(level);
+    }
+  }
+
+  void Release() override
+  {
+    mAMPEnv.Release();
+  }
+
+  void ProcessSamplesAccumulating(sample** /*inputs*/, sample** outputs, int /*nInputs*/, int nOutputs, int startIdx, int nFrames) override
+  {
+    if (!mFile)
+    {
+      mAMPEnv.Kill(true);
+      return;
+    }
+
+    const double pitch = mInputs[kVoiceControlPitch].endValue + mInputs[kVoiceControlPitchBend].endValue - mRootPitch;
+    const double increment = std::pow(2., pitch) * mRateRatio;
+    mAvailableEnd = mStream ? mStream->GetAvailableEnd() : -1;
+    bool underrun = false;
+
+    for (auto s = startIdx; s < startIdx + nFrames; s++)
+    {
+      const int64_t i = (int64_t) mPos;
+
+      if (i >= mNFrames)
+      {
+        mAMPEnv.Kill(true);
+        break;
+      }
+
+      const float t = (float) (mPos - (double) i);
+      const sample env = mAMPEnv.Process(1.);
+
+      // the file changes in the envelope's reset function, after a retrigger
+      if (!mFile)
+        break;
+
+      for (auto c = 0; c < nOutputs; c++)
+      {
+        const int chan = c % mNChans;
+        const float y = Interpolate(GetFrame(chan, i - 1, underrun), GetFrame(chan, i, underrun),
+                                    GetFrame(chan, i + 1, underrun), GetFrame(chan, i + 2, underrun), t);
+        outputs[c][s] += y * env;
+      }
+
+      mPos += increment;
+    }
+
+    if (!mFile || !mAMPEnv.GetBusy())
+    {
+      mAMPEnv.Kill(true);
+      mFile = nullptr;
+
+      if (mStream)
+        mStream->Stop();
+    }
+    else if (mStream)
+    {
+      mStream->SetReadPosition(std::max<int64_t>((int64_t) mPos - 1, mNPreloaded));
+
+      if (underrun)
+        mStream->AddUnderrun();
+    }
+  }
+
+  void SetSampleRateAndBlockSize(double sampleRate, int /*blockSize*/) override
+  {
+    mSampleRate = sampleRate;
+    mAMPEnv.SetSampleRate(sampleRate);
+  }
+
+private:
+  void StartPlayback()
+  {
+    mFile = nullptr;
+
+    if (mZones)
+    {
+      for (const auto& zone : *mZones)
+      {
+        if (zone.mFile && zone.mFile->IsLoaded() && mKey >= zone.mLoKey && mKey <= zone.mHiKey)
+        {
+          mFile = zone.mFile;
+          mRootPitch = (zone.mRootKey - 69.) / 12.;
+          break;
+        }
+      }
+    }
+
+    if (!mFile)
+    {
+      if (mStream)
+        mStream->Stop();
+
+      return;
+    }
+
+    mPos = 0.;
+    mAvailableEnd = -1; // the ring is invalid until the streamer picks up the new request
+    mNFrames = mFile->NFrames();
+    mNChans = mFile->NChans();
+    mNPreloaded = mFile->NPreloadedFrames();
+    mRateRatio = mFile->GetSampleRate() / mSampleRate;
+
+    for (auto c = 0; c < mNChans; c++)
+      mHead[c] = mFile->GetHead(c);
+
+    if (mStream)
+    {
+      if (mNPreloaded < mNFrames)
+        mStream->Start(mFile, mNPreloaded);
+      else
+        mStream->Stop();
+    }
+  }
+
+  inline float GetFrame(int chan, int64_t frame, bool& underrun) const
+  {
+    if (frame < 0 || frame >= mNFrames)
+      return 0.f;
+
+    if (frame < mNPreloaded)
+      return mHead[chan][frame];
+
+    if (frame < mAvailableEnd)
+      return mStream->GetFrame(chan, frame);
+
+    underrun = true;
+    return 0.f;
+  }
+
+  static inline float Interpolate(float xm1, float x0, float x1, float x2, float t)
+  {
+    const float c1 = 0.5f * (x1 - xm1);
+    const float c2 = xm1 - 2.5f * x0 + 2.f * x1 - 0.5f * x2;
+    const float c3 = 0.5f * (x2 - xm1) + 1.5f * (x0 - x1);
+    return ((c3 * t + c2) * t + c1) * t + x0;
+  }
+
+  ADSREnvelope<sample> mAMPEnv;
+  const std::vector<SampleZone>* mZones = nullptr;
+  SampleStream* mStream = nullptr;
+  SampleFile* mFile = nullptr;
+  const float* mHead[SampleFile::kMaxNChans] = {};
+  double mPos = 0.;
+  double mRootPitch = 0.;
+  double mRateRatio = 1.;
+  double mSampleRate = 44100.;
+  int64_t mNFrames = 0;
+  int64_t mAvailableEnd = -1;
+  int mNPreloaded = 0;
+  int mNChans = 1;
+};
+
+/** A polyphonic disk streaming sampler, built from a TypedMidiSynth of SamplerVoices, a SampleStream per voice, and a SampleStreamer thread.
+ *
+ * The memory use is a trade-off between the number of samples, the number of voices and how safe the streaming is:
+ * - each sample keeps preloadFrames * nChans floats in memory, and
+ * - each voice has a ring of streamBufferFrames * maxNChans floats.
+ *
+ * preloadFrames has to cover the time it takes for the streamer to pick up a new voice and do its first read (at least a few milliseconds, much more on spinning disks),
+ * at the highest playback rate: a note played two octaves above its root key consumes frames four times as fast.
+ * streamBufferFrames has to cover the time the streamer takes to service all the other voices, at the highest playback rate.
+ * Use GetMemoryUsage() to check the total, and GetNUnderruns() to see if the settings are too small. */
+class StreamingSampler
+{
+public:
+  struct Config
+  {
+    int mPreloadFrames = 32768;
+    int mStreamBufferFrames = 32768;
+    int mReadChunkFrames = 8192;
+    int mMaxNChans = 2;
+    bool mUseMemoryMap = true;
+  };
+
+  StreamingSampler(int nVoices)
+  : StreamingSampler(nVoices, Config())
+  {
+  }
+
+  StreamingSampler(int nVoices, const Config& config)
+  : mSynth(nVoices, VoiceAllocator::kPolyModePoly)
+  , mStreamer(config.mReadChunkFrames)
+  , mStreams(new SampleStream[nVoices])
+  , mNVoices(nVoices)
+  , mConfig(config)
+  {
+    for (auto v = 0; v < nVoices; v++)
+    {
+      mStreams[v].Allocate(config.mMaxNChans, config.mStreamBufferFrames);
+      mStreamer.AddStream(&mStreams[v]);
+    }
+
+    auto v = 0;
+    mSynth.ForEachTypedVoice([&](SamplerVoice& voice) { voice.Setup(&mZones, &mStreams[v++]); });
+  }
+
+  ~StreamingSampler()
+  {
+    mStreamer.Stop();
+  }
+
+  /** Load a sample and map it to a range of keys. Does file IO and allocates, and must not be called while the sampler is processing
+   * @return \c true if the file was loaded, \c false if it couldn't be read or has more than Config::mMaxNChans channels */
+  bool AddSample(const char* path, int rootKey, int loKey = 0, int hiKey = 127)
+  {
+    std::unique_ptr<SampleFile> pFile(new SampleFile);
+
+    if (!pFile->Load(path, mConfig.mPreloadFrames, mConfig.mUseMemoryMap) || pFile->NChans() > mConfig.mMaxNChans)
+      return false;
+
+    mZones.push_back({pFile.get(), rootKey, loKey, hiKey});
+    mFiles.push_back(std::move(pFile));
+    return true;
+  }
+
+  /** Remove all samples. Must not be called while the sampler is processing */
+  void ClearSamples()
+  {
+    const bool wasRunning = mStreamer.IsRunning();
+    mStreamer.Stop();
+    mSynth.Reset();
+
+    for (auto v = 0; v < mNVoices; v++)
+      mStreams[v].Stop();
+
+    mStreamer.ServiceStreams(); // pick up the stops, so no stream refers to a file
+
+    mZones.clear();
+    mFiles.clear();
+
+    if (wasRunning)
+      mStreamer.Start();
+  }
+
+  /** Start/stop the streaming thread. Typically started when the plug-in is activated */
+  void SetStreamingActive(bool active)
+  {
+    if (active)
+      mStreamer.Start();
+    else
+      mStreamer.Stop();
+  }
+
+  void SetSampleRateAndBlockSize(double sampleRate, int blockSize)
+  {
+    mSynth.SetSampleRateAndBlockSize(sampleRate, blockSize);
+  }
+
+  void SetEnvelope(double attackMs, double releaseMs)
+  {
+    mSynth.ForEachTypedVoice([&](SamplerVoice& voice) { voice.SetEnvelope(attackMs, releaseMs); });
+  }
+
+  void ProcessMidiMsg(const IMidiMsg& msg)
+  {
+    mSynth.AddMidiMsgToQueue(msg);
+  }
+
+  bool ProcessBlock(sample** inputs, sample** outputs, int nInputs, int nOutputs, int nFrames)
+  {
+    return mSynth.ProcessBlock(inputs, outputs, nInputs, nOutputs, nFrames);
+  }
+
+  /** @return The total number of bytes used by the preloaded sample heads and the voices' ring buffers */
+  size_t GetMemoryUsage() const
+  {
+    size_t bytes = 0;
+
+    for (const auto& pFile : mFiles)
+      bytes += pFile->GetMemoryUsage();
+
+    for (auto v = 0; v < mNVoices; v++)
+      bytes += mStreams[v].GetMemoryUsage();
+
+    return bytes;
+  }
+
+  /** @return The total number of voice blocks where the streamed data didn't arrive in time */
+  uint32_t GetNUnderruns() const
+  {
+    uint32_t n = 0;
+
+    for (auto v = 0; v < mNVoices; v++)
+      n += mStreams[v].GetNUnderruns();
+
+    return n;
+  }
+
+  void ResetNUnderruns()
+  {
+    for (auto v = 0; v < mNVoices; v++)
+      mStreams[v].ResetNUnderruns();
+  }
+
+  SampleStreamer& GetStreamer() { return mStreamer; }
+  TypedMidiSynth<SamplerVoice>& GetSynth() { return mSynth; }
+
+private:
+  TypedMidiSynth<SamplerVoice> mSynth;
+  SampleStreamer mStreamer;
+  std::unique_ptr<SampleStream[]> mStreams;
+  std::vector<std::unique_ptr<SampleFile>> mFiles;
+  std::vector<SampleZone> mZones;
+  int mNVoices;
+  Config mConfig;
+};
+
+END_IPLUG_NAMESPACE
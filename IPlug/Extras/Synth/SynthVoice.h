@@ -86,6 +86,27 @@ public:
     }
   }
 
+  /** Process a batch of voices of the same concrete type. This is used by TypedMidiSynth, which knows the voice type at compile time and
+   * calls VOICE::ProcessVoicesBatch() once per block with all the active voices. This default implementation calls ProcessSamplesAccumulating() on each voice
+   * without virtual dispatch. Implement a static method with the same signature (taking your voice type) in your voice class if you want to render all the
+   * active voices in one go, for instance to process several voices in parallel with SIMD instructions.
+   @param pVoices Pointer to an array of pointers to the active voices
+   @param nVoices The number of active voices
+   @param inputs Pointer to input channel arrays.
+   @param outputs Pointer to output channel arrays. Voices should add to the existing data in these arrays
+   @param nInputs The number of input channels that contain valid data
+   @param nOutputs The number of output channels that contain valid data
+   @param startIdx The start index of the block of samples to process
+   @param nFrames The number of samples to process in this block */
+  template<class VOICE>
+  static void ProcessVoicesBatch(VOICE* const* pVoices, int nVoices, sample** inputs, sample** outputs, int nInputs, int nOutputs, int startIdx, int nFrames)
+  {
+    for (auto v = 0; v < nVoices; v++)
+    {
+      pVoices[v]->VOICE::ProcessSamplesAccumulating(inputs, outputs, nInputs, nOutputs, startIdx, nFrames);
+    }
+  }
+
   /** Implement this if you need to do work when the sample rate or block size changes.
    * @param sampleRate The new sample rate
    * @param blockSize The new block size in samples */
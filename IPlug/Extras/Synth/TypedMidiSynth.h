@@ -0,0 +1,91 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+ */
+
+#pragma once
+
+/**
+ * @file
+ * @copydoc TypedMidiSynth
+ */
+
+#include <memory>
+#include <vector>
+
+#include "MidiSynth.h"
+
+BEGIN_IPLUG_NAMESPACE
+
+/** A MidiSynth that is parameterized on a concrete voice type.
+ * The voices are stored contiguously in one allocation owned by the synth, rather than as separate heap objects.
+ * Only the voices in the VoiceAllocator's active voice list are rendered, with one call per block to VOICE::ProcessVoicesBatch()
+ * (see SynthVoice::ProcessVoicesBatch()), and GetBusy()/ProcessSamplesAccumulating() are called without virtual dispatch.
+ * This makes a big difference with lots of small voices and short control blocks, where the voice dispatch and cache misses can cost more than the DSP.
+ * @tparam VOICE The voice class, which must inherit from SynthVoice and be default constructible */
+template<class VOICE>
+class TypedMidiSynth final : public MidiSynth
+{
+public:
+  static_assert(std::is_base_of<SynthVoice, VOICE>::value, "VOICE must inherit from SynthVoice");
+
+  /** @param nVoices The number of voices to create, all in zone 0
+   * @param mode Polyphonic or monophonic mode
+   * @param blockSize The size in samples of a single block of processing, see MidiSynth */
+  TypedMidiSynth(int nVoices, VoiceAllocator::EPolyMode mode, int blockSize = kDefaultBlockSize)
+  : MidiSynth(mode, blockSize)
+  , mVoices(new VOICE[nVoices])
+  , mNVoices(nVoices)
+  {
+    mActiveVoicePtrs.resize(nVoices);
+
+    for (auto v = 0; v < nVoices; v++)
+    {
+      MidiSynth::AddVoice(&mVoices[v], 0);
+    }
+  }
+
+  /** Voices are created in the constructor */
+  void AddVoice(SynthVoice* pVoice, uint8_t zone) = delete;
+
+  VOICE& GetTypedVoice(int voiceIdx)
+  {
+    return mVoices[voiceIdx];
+  }
+
+  /** Call a function on every voice, without needing to cast the SynthVoice */
+  template<typename F>
+  void ForEachTypedVoice(F&& func)
+  {
+    for (auto v = 0; v < mNVoices; v++)
+      func(mVoices[v]);
+  }
+
+protected:
+  void ProcessVoices(sample** inputs, sample** outputs, int nInputs, int nOutputs, int startIdx, int nFrames) override
+  {
+    const std::vector<int>& activeVoices = mVoiceAllocator.GetActiveVoices();
+    const int nActive = static_cast<int>(activeVoices.size());
+
+    for (auto i = 0; i < nActive; i++)
+    {
+      mActiveVoicePtrs[i] = &mVoices[activeVoices[i]];
+    }
+
+    VOICE::ProcessVoicesBatch(mActiveVoicePtrs.data(), nActive, inputs, outputs, nInputs, nOutputs, startIdx, nFrames);
+
+    mVoiceAllocator.UpdateActiveVoices([this](int voiceIdx) { return mVoices[voiceIdx].VOICE::GetBusy(); });
+  }
+
+private:
+  std::unique_ptr<VOICE[]> mVoices;
+  std::vector<VOICE*> mActiveVoicePtrs;
+  int mNVoices;
+};
+
+END_IPLUG_NAMESPACE
@@ -56,6 +56,8 @@ void VoiceAllocator::AddVoice(SynthVoice* pVoice, uint8_t zone)
   if(mVoicePtrs.size() + 1 < UCHAR_MAX)
   {
     mVoicePtrs.push_back(pVoice);
+    mVoiceIsActive.push_back(false);
+    mActiveVoices.reserve(mVoicePtrs.size());
     ClearVoiceInputs(pVoice);
     pVoice->mKey = -1;
     pVoice->mZone = zone;
@@ -117,7 +119,7 @@ VoiceAllocator::VoiceBitsArray VoiceAllocator::VoicesMatchingAddress(VoiceAddres
   {
     for(int i=0; i<n; ++i)
     {
-      v[i] = v[i] & mVoicePtrs[i]->GetBusy();
+      v[i] = v[i] & mVoiceIsActive[i];
     }
   }
 
@@ -296,8 +298,7 @@ int VoiceAllocator::FindFreeVoiceIndex(int startIndex) const
   for(int i=0; i<voices; ++i)
   {
     int j = (startIndex + i)%voices;
-    SynthVoice* pv = mVoicePtrs[j];
-    if(!pv->GetBusy())
+    if(!mVoiceIsActive[j])
     {
       return j;
     }
@@ -343,6 +344,8 @@ void VoiceAllocator::StartVoice(int voiceIdx, int channel, int key, float pitch,
 
   // call voice's Trigger method
   pVoice->Trigger(velocity, retrig);
+
+  ActivateVoice(voiceIdx);
 }
 
 // start all of the voice indexes marked in the VoieBitsArray and set the current channel and key of each.
@@ -529,12 +532,12 @@ void VoiceAllocator::NoteOff(VoiceInputEvent e, int64_t sampleTime)
 
 void VoiceAllocator::ProcessVoices(sample** inputs, sample** outputs, int nInputs, int nOutputs, int startIndex, int blockSize)
 {
-  for(auto pVoice : mVoicePtrs)
+  // only the voices in the active list are processed
+  for(auto voiceIdx : mActiveVoices)
   {
     // TODO distribute voices across cores
-    if(pVoice->GetBusy())
-    {
-      pVoice->ProcessSamplesAccumulating(inputs, outputs, nInputs, nOutputs, startIndex, blockSize);
-    }
+    mVoicePtrs[voiceIdx]->ProcessSamplesAccumulating(inputs, outputs, nInputs, nOutputs, startIndex, blockSize);
   }
+
+  UpdateActiveVoices([this](int voiceIdx) { return mVoicePtrs[voiceIdx]->GetBusy(); });
 }
@@ -18,6 +18,8 @@
 #include <array>
 #include <vector>
 #include <stdint.h>
+#include <climits>
+#include <memory>
 #include <functional>
 #include <bitset>
 //#include <iostream>
@@ -137,6 +139,43 @@ public:
 
   void ProcessVoices(sample** inputs, sample** outputs, int nInputs, int nOutputs, int startIndex, int blockSize);
 
+  /** @return The indices of the voices that have been started and were still busy at the end of the last processed block */
+  const std::vector<int>& GetActiveVoices() const { return mActiveVoices; }
+
+  /** @return The number of voices in the active voice list */
+  int NActiveVoices() const { return static_cast<int>(mActiveVoices.size()); }
+
+  /** Add all voices to the active voice list, so that they are processed (and polled) at least once.
+   * Used by MidiSynth::SetVoicesActive() for voices that make sound without being started by a note on */
+  void ActivateAllVoices()
+  {
+    for(int i=0; i<static_cast<int>(mVoicePtrs.size()); ++i)
+    {
+      ActivateVoice(i);
+    }
+  }
+
+  /** Remove the voices that are no longer busy from the active voice list. Call after processing the voices.
+   * @param isBusy A function or lambda taking a voice index, returning \c true if the voice is still busy.
+   * This is a template so that MidiSynth variants that know the concrete voice type can avoid the virtual SynthVoice::GetBusy() call */
+  template<typename F>
+  void UpdateActiveVoices(F&& isBusy)
+  {
+    int nActive = 0;
+
+    for(int i=0; i<static_cast<int>(mActiveVoices.size()); ++i)
+    {
+      const int voiceIdx = mActiveVoices[i];
+
+      if(isBusy(voiceIdx))
+        mActiveVoices[nActive++] = voiceIdx;
+      else
+        mVoiceIsActive[voiceIdx] = false;
+    }
+
+    mActiveVoices.resize(nActive);
+  }
+
   size_t GetNVoices() const {return mVoicePtrs.size();}
   SynthVoice* GetVoice(int voiceIndex) const {return mVoicePtrs[voiceIndex];}
   void SetPitchOffset(float offset) { mPitchOffset = offset; }
@@ -156,6 +195,15 @@ private:
   void StopVoice(int voiceIdx, int sampleOffset);
   void StopVoices(VoiceBitsArray voices, int sampleOffset);
 
+  void ActivateVoice(int voiceIdx)
+  {
+    if(!mVoiceIsActive[voiceIdx])
+    {
+      mVoiceIsActive[voiceIdx] = true;
+      mActiveVoices.push_back(voiceIdx);
+    }
+  }
+
   void CalcGlideTimesInSamples();
   void ClearVoiceInputs(SynthVoice* pVoice);
   int FindFreeVoiceIndex(int startIndex) const;
@@ -167,6 +215,8 @@ private:
   IPlugQueue<VoiceInputEvent> mInputQueue{1024};
 
   std::vector<SynthVoice*> mVoicePtrs;
+  std::vector<int> mActiveVoices; // compact list of the voices that need processing, so that we don't poll every voice
+  std::vector<bool> mVoiceIsActive;
   std::vector<std::unique_ptr<VoiceControlRamps>> mVoiceGlides;
   std::vector<int> mHeldKeys; // The currently physically held keys on the keyboard
   std::vector<int> mSustainedNotes; // Any notes that are sustained, including those that are physically held
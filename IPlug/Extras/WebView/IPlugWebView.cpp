@@ -158,8 +158,14 @@ void IWebView::EvaluateJavaScript(const char* scriptStr, completionHandlerFunc f
 {
   if (mWebViewWnd)
   {
-    WCHAR scriptWide[IPLUG_WIN_MAX_WIDE_PATH]; // TODO: error check/size
-    UTF8ToUTF16(scriptWide, scriptStr, IPLUG_WIN_MAX_WIDE_PATH); // TODO: error check/size
+    // sized to the script, as a WebViewMsgBatch with a large message (e.g. a spectrum) is much longer than a path
+    const int wideLen = MultiByteToWideChar(CP_UTF8, 0, scriptStr, -1, NULL, 0);
+    WCHAR* scriptWide = wideLen > 0 ? mScriptWide.ResizeOK(wideLen, false) : nullptr;
+
+    if (!scriptWide)
+      return;
+
+    UTF8ToUTF16(scriptWide, scriptStr, wideLen);
 
     mWebViewWnd->ExecuteScript(scriptWide, Callback<ICoreWebView2ExecuteScriptCompletedHandler>(
       [func](HRESULT errorCode, LPCWSTR resultObjectAsJson) -> HRESULT {
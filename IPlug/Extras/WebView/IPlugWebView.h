@@ -23,6 +23,7 @@
   #define PLATFORM_RECT CGRect
   #define MAKERECT CGRectMake
 #elif defined OS_WIN
+  #include "heapbuf.h"
   #include <wrl.h>
   #include <wil/com.h>
   #include "WebView2.h"
@@ -93,6 +94,7 @@ private:
   EventRegistrationToken mNavigationCompletedToken;
   WDL_String mDLLPath;
   WDL_String mTmpPath;
+  WDL_TypedBuf<WCHAR> mScriptWide; // EvaluateJavaScript()'s UTF-16 copy of the script, kept at the size of the longest script so far
   HMODULE mDLLHandle = nullptr;
 #endif
 };
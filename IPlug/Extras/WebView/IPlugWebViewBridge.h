@@ -0,0 +1,498 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+#pragma once
+
+/**
+ * @file
+ * @brief The protocol between WebViewEditorDelegate and the script in the web view: WebViewMsgBatch coalesces the messages to the UI and
+ * encodes them as one binary payload per idle tick, and WebViewMsgReader reads the JSON messages from the UI without allocating
+ *
+ * Neither class depends on a platform web view, so they can be tested and benchmarked on their own.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "IPlugPlatform.h"
+
+#include "heapbuf.h"
+#include "wdl_base64.h"
+
+BEGIN_IPLUG_NAMESPACE
+
+/** The types of the records in a WebViewMsgBatch payload. All numbers are little-endian */
+enum EWebViewMsgType : uint8_t
+{
+  kWebViewParamValue = 1, // int32 paramIdx, float64 value (SPVFD)
+  kWebViewControlValue,   // int32 ctrlTag, float32 normalizedValue (SCVFD)
+  kWebViewControlMsg,     // int32 ctrlTag, int32 msgTag, int32 dataSize, dataSize bytes (SCMFD)
+  kWebViewArbitraryMsg    // int32 msgTag, int32 dataSize, dataSize bytes (SAMFD)
+};
+
+/** Collects the messages that an editor delegate sends to a web view UI between idle ticks, and encodes them as one script call, e.g. IPlugBridge("AQEAAAAA...");
+ * The payload is a version byte followed by EWebViewMsgType records, base64 encoded once for the whole batch.
+ * Parameter and control values are state, so only the latest value of each is sent, and intermediate values are dropped. Control and arbitrary messages may be events,
+ * so they are all sent, in the order they were added, after the values.
+ * Memory is kept between flushes, so once the buffers have grown to fit a busy tick, adding and flushing do not allocate. Main thread only */
+class WebViewMsgBatch
+{
+public:
+  static constexpr uint8_t kVersion = 1;
+  static constexpr int kDefaultMaxScriptLength = 4000; // keeps the scripts of a busy tick short, IWebView::EvaluateJavaScript() itself takes scripts of any length
+
+  WebViewMsgBatch(int nParams = 0, int maxScriptLength = kDefaultMaxScriptLength)
+  {
+    Resize(nParams);
+    SetMaxScriptLength(maxScriptLength);
+  }
+
+  WebViewMsgBatch(const WebViewMsgBatch&) = delete;
+  WebViewMsgBatch& operator=(const WebViewMsgBatch&) = delete;
+
+  /** Allocate the parameter values, clearing the batch
+   * @param nParams The number of parameters. Parameter indexes above this grow the buffers when they are added */
+  void Resize(int nParams)
+  {
+    mParamValues.Resize(nParams);
+    mParamPending.Resize(nParams);
+    memset(mParamPending.Get(), 0, nParams * sizeof(bool));
+    mPendingParams.Resize(nParams, false); // so that a tick that sends every parameter doesn't allocate
+    mPendingParams.Resize(0, false);
+    mControlValues.Resize(0, false);
+    mMsgs.Resize(0, false);
+  }
+
+  /** Batches bigger than this are split into several scripts, between records. A single message bigger than this still gets a whole script of its own, it is never split
+   * @param maxScriptLength The maximum length of each script in characters */
+  void SetMaxScriptLength(int maxScriptLength)
+  {
+    static constexpr int kNWrapperChars = 16; // IPlugBridge("");
+    mMaxPayloadSize = std::max(((maxScriptLength - kNWrapperChars) / 4) * 3, 64);
+  }
+
+  /** Discard the batch */
+  void Clear()
+  {
+    for (auto i = 0; i < mPendingParams.GetSize(); i++)
+      mParamPending.Get()[mPendingParams.Get()[i]] = false;
+
+    mPendingParams.Resize(0, false);
+    mControlValues.Resize(0, false);
+    mMsgs.Resize(0, false);
+  }
+
+  bool Empty() const { return !mPendingParams.GetSize() && !mControlValues.GetSize() && !mMsgs.GetSize(); }
+
+  /** Add a parameter value, replacing any value of the same parameter already in the batch */
+  void AddParamValue(int paramIdx, double value)
+  {
+    if (paramIdx < 0)
+      return;
+
+    if (paramIdx >= mParamValues.GetSize())
+    {
+      const int oldSize = mParamPending.GetSize();
+      mParamValues.Resize(paramIdx + 1);
+      mParamPending.Resize(paramIdx + 1);
+      memset(mParamPending.Get() + oldSize, 0, (paramIdx + 1 - oldSize) * sizeof(bool));
+    }
+
+    mParamValues.Get()[paramIdx] = value;
+
+    if (!mParamPending.Get()[paramIdx])
+    {
+      mParamPending.Get()[paramIdx] = true;
+      mPendingParams.Add(paramIdx);
+    }
+  }
+
+  /** Add a control value, replacing any value for the same control already in the batch. There are usually only a few tagged controls, so they are searched linearly */
+  void AddControlValue(int ctrlTag, double normalizedValue)
+  {
+    ControlValue* pValues = mControlValues.Get();
+
+    for (auto i = 0; i < mControlValues.GetSize(); i++)
+    {
+      if (pValues[i].mCtrlTag == ctrlTag)
+      {
+        pValues[i].mValue = normalizedValue;
+        return;
+      }
+    }
+
+    mControlValues.Add({ ctrlTag, normalizedValue });
+  }
+
+  /** Add a message for a control. The data is copied */
+  void AddControlMsg(int ctrlTag, int msgTag, int dataSize, const void* pData)
+  {
+    dataSize = pData ? std::max(dataSize, 0) : 0;
+    uint8_t* pRecord = AddMsgRecord(kWebViewControlMsg, 12 + dataSize);
+    pRecord = PutInt32(pRecord, ctrlTag);
+    pRecord = PutInt32(pRecord, msgTag);
+    pRecord = PutInt32(pRecord, dataSize);
+
+    if (dataSize > 0)
+      memcpy(pRecord, pData, dataSize);
+  }
+
+  /** Add a message for the UI. The data is copied */
+  void AddArbitraryMsg(int msgTag, int dataSize, const void* pData)
+  {
+    dataSize = pData ? std::max(dataSize, 0) : 0;
+    uint8_t* pRecord = AddMsgRecord(kWebViewArbitraryMsg, 8 + dataSize);
+    pRecord = PutInt32(pRecord, msgTag);
+    pRecord = PutInt32(pRecord, dataSize);
+
+    if (dataSize > 0)
+      memcpy(pRecord, pData, dataSize);
+  }
+
+  /** Encode the batch and clear it
+   * @param scriptFunc A function taking (const char* script), called with each script to run in the web view, usually just once. The script is only valid during the call
+   * @return The number of scripts */
+  template <typename ScriptFunc>
+  int Flush(ScriptFunc&& scriptFunc)
+  {
+    if (Empty())
+      return 0;
+
+    int nScripts = 0;
+    mPayload.Resize(0, false);
+    mPayload.Add(kVersion);
+
+    // starts a new script if the next record won't fit in this one
+    auto reserve = [&](int recordSize) {
+      if (mPayload.GetSize() > 1 && mPayload.GetSize() + recordSize > mMaxPayloadSize)
+      {
+        EncodeScript(scriptFunc);
+        nScripts++;
+        mPayload.Resize(1, false);
+      }
+
+      const int size = mPayload.GetSize();
+      return mPayload.ResizeOK(size + recordSize, false) + size;
+    };
+
+    for (auto i = 0; i < mPendingParams.GetSize(); i++)
+    {
+      const int paramIdx = mPendingParams.Get()[i];
+      uint8_t* pRecord = reserve(13);
+      *pRecord++ = kWebViewParamValue;
+      pRecord = PutInt32(pRecord, paramIdx);
+      PutFloat64(pRecord, mParamValues.Get()[paramIdx]);
+    }
+
+    for (auto i = 0; i < mControlValues.GetSize(); i++)
+    {
+      uint8_t* pRecord = reserve(9);
+      *pRecord++ = kWebViewControlValue;
+      pRecord = PutInt32(pRecord, mControlValues.Get()[i].mCtrlTag);
+      PutFloat32(pRecord, static_cast<float>(mControlValues.Get()[i].mValue));
+    }
+
+    // the messages are already encoded, so they are copied a record at a time
+    for (auto pos = 0; pos < mMsgs.GetSize();)
+    {
+      const uint8_t* pMsg = mMsgs.Get() + pos;
+      const int headerSize = pMsg[0] == kWebViewControlMsg ? 13 : 9;
+      const int recordSize = headerSize + GetInt32(pMsg + headerSize - 4);
+      memcpy(reserve(recordSize), pMsg, recordSize);
+      pos += recordSize;
+    }
+
+    EncodeScript(scriptFunc);
+    Clear();
+
+    return nScripts + 1;
+  }
+
+private:
+  struct ControlValue
+  {
+    int mCtrlTag;
+    double mValue;
+  };
+
+  uint8_t* AddMsgRecord(uint8_t type, int size)
+  {
+    const int pos = mMsgs.GetSize();
+    uint8_t* pRecord = mMsgs.ResizeOK(pos + 1 + size, false) + pos;
+    *pRecord = type;
+    return pRecord + 1;
+  }
+
+  template <typename ScriptFunc>
+  void EncodeScript(ScriptFunc& scriptFunc)
+  {
+    static constexpr char kPrefix[] = "IPlugBridge(\"";
+    static constexpr char kSuffix[] = "\");";
+    static constexpr int kPrefixLen = sizeof(kPrefix) - 1;
+
+    const int payloadSize = mPayload.GetSize();
+    const int base64Size = ((payloadSize + 2) / 3) * 4;
+    char* pScript = mScript.ResizeOK(kPrefixLen + base64Size + sizeof(kSuffix), false);
+    memcpy(pScript, kPrefix, kPrefixLen);
+    wdl_base64encode(mPayload.Get(), pScript + kPrefixLen, payloadSize);
+    memcpy(pScript + kPrefixLen + base64Size, kSuffix, sizeof(kSuffix));
+    scriptFunc(static_cast<const char*>(pScript));
+  }
+
+  static uint8_t* PutInt32(uint8_t* p, int32_t value)
+  {
+    const uint32_t bits = static_cast<uint32_t>(value);
+
+    for (auto i = 0; i < 4; i++)
+      p[i] = static_cast<uint8_t>(bits >> (8 * i));
+
+    return p + 4;
+  }
+
+  static int32_t GetInt32(const uint8_t* p)
+  {
+    return static_cast<int32_t>(p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24));
+  }
+
+  static uint8_t* PutFloat32(uint8_t* p, float value)
+  {
+    uint32_t bits;
+    memcpy(&bits, &value, 4);
+    return PutInt32(p, static_cast<int32_t>(bits));
+  }
+
+  static uint8_t* PutFloat64(uint8_t* p, double value)
+  {
+    uint64_t bits;
+    memcpy(&bits, &value, 8);
+
+    for (auto i = 0; i < 8; i++)
+      p[i] = static_cast<uint8_t>(bits >> (8 * i));
+
+    return p + 8;
+  }
+
+  WDL_TypedBuf<double> mParamValues;
+  WDL_TypedBuf<bool> mParamPending;
+  WDL_TypedBuf<int> mPendingParams; // in the order they were first added
+  WDL_TypedBuf<ControlValue> mControlValues;
+  WDL_TypedBuf<uint8_t> mMsgs; // encoded records
+  WDL_TypedBuf<uint8_t> mPayload;
+  WDL_TypedBuf<char> mScript;
+  int mMaxPayloadSize = 0;
+};
+
+/** Reads the JSON messages that the script in the web view posts with IPlugSendMsg(), e.g. {"msg":"SPVFUI","paramIdx":1,"value":0.5}, straight from the string,
+ * without building a DOM or allocating. It finds members by name, wherever they are, so it is only meant for the protocol's flat objects of numbers and strings */
+class WebViewMsgReader
+{
+public:
+  WebViewMsgReader(const char* json)
+  : mJSON(json ? json : "")
+  {
+  }
+
+  /** @return \c true if the message's "msg" member is the string msg, e.g. "SPVFUI" */
+  bool IsMsg(const char* msg) const
+  {
+    const char* pValue = FindValue("msg");
+
+    if (!pValue || *pValue != '"')
+      return false;
+
+    const size_t len = strlen(msg);
+    return !strncmp(pValue + 1, msg, len) && pValue[len + 1] == '"';
+  }
+
+  /** @return The value of a number member, or defaultValue if there isn't one */
+  double GetDouble(const char* key, double defaultValue = 0.) const
+  {
+    const char* pValue = FindValue(key);
+    double value;
+    return pValue && ParseNumber(pValue, value) ? value : defaultValue;
+  }
+
+  /** @return The value of a number member as an int, or defaultValue if there isn't one */
+  int GetInt(const char* key, int defaultValue = 0) const
+  {
+    const double value = GetDouble(key, static_cast<double>(defaultValue));
+    return value > -2147483648. && value < 2147483648. ? static_cast<int>(value) : defaultValue;
+  }
+
+  /** Decode a base64 string member
+   * @param data Filled with the decoded bytes. Only allocates if it isn't already big enough
+   * @return The number of bytes, 0 if there isn't a string member of that name */
+  int GetBase64Data(const char* key, WDL_TypedBuf<uint8_t>& data) const
+  {
+    data.Resize(0, false);
+    const char* pValue = FindValue(key);
+
+    if (!pValue || *pValue != '"')
+      return 0;
+
+    const char* pEnd = SkipString(pValue);
+    uint8_t* pData = data.ResizeOK(static_cast<int>(((pEnd - pValue) / 4) * 3 + 3), false);
+
+    if (!pData)
+      return 0;
+
+    int size = 0;
+    uint32_t accum = 0;
+    int nBits = 0;
+
+    // JSON may escape '/' as "\/", so backslashes are skipped along with anything else outside the alphabet
+    for (const char* p = pValue + 1; p < pEnd - 1 && *p != '='; p++)
+    {
+      const int digit = Base64Digit(*p);
+
+      if (digit < 0)
+        continue;
+
+      accum = (accum << 6) | digit;
+      nBits += 6;
+
+      if (nBits >= 8)
+      {
+        nBits -= 8;
+        pData[size++] = static_cast<uint8_t>(accum >> nBits);
+      }
+    }
+
+    data.Resize(size, false);
+    return size;
+  }
+
+private:
+  /** @return The first character of the value of the member called key, or nullptr */
+  const char* FindValue(const char* key) const
+  {
+    const size_t keyLen = strlen(key);
+
+    // strings are skipped whole, so text inside a string value can't be mistaken for a key
+    for (const char* p = strchr(mJSON, '"'); p; p = strchr(p, '"'))
+    {
+      const char* pEnd = SkipString(p);
+
+      if (static_cast<size_t>(pEnd - p) == keyLen + 2 && !strncmp(p + 1, key, keyLen))
+      {
+        const char* pColon = SkipWhitespace(pEnd);
+
+        if (*pColon == ':')
+          return SkipWhitespace(pColon + 1);
+      }
+
+      p = pEnd;
+    }
+
+    return nullptr;
+  }
+
+  /** @return The character after the closing quote of the string starting at p, or the end of the JSON if it isn't closed */
+  static const char* SkipString(const char* p)
+  {
+    for (p++; *p; p++)
+    {
+      if (*p == '\\' && p[1])
+        p++;
+      else if (*p == '"')
+        return p + 1;
+    }
+
+    return p;
+  }
+
+  static const char* SkipWhitespace(const char* p)
+  {
+    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')
+      p++;
+
+    return p;
+  }
+
+  /** Parses a JSON number independently of the C locale. Numbers with up to 15 significant digits and exponents up to 22, which covers most of what JavaScript produces, are correctly rounded, others are within an ulp or so */
+  static bool ParseNumber(const char* p, double& value)
+  {
+    static constexpr double kPow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                         1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+    static constexpr uint64_t kMaxMantissa = 1000000000000000000ull; // digits beyond this are beyond double precision
+    const bool negative = *p == '-';
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    int nDigits = 0;
+
+    if (negative)
+      p++;
+
+    for (; *p >= '0' && *p <= '9'; p++, nDigits++)
+    {
+      if (mantissa < kMaxMantissa)
+        mantissa = mantissa * 10 + (*p - '0');
+      else
+        exponent++;
+    }
+
+    if (*p == '.')
+    {
+      for (p++; *p >= '0' && *p <= '9'; p++, nDigits++)
+      {
+        if (mantissa < kMaxMantissa)
+        {
+          mantissa = mantissa * 10 + (*p - '0');
+          exponent--;
+        }
+      }
+    }
+
+    if (!nDigits)
+      return false;
+
+    if (*p == 'e' || *p == 'E')
+    {
+      p++;
+      const bool negativeExponent = *p == '-';
+
+      if (*p == '-' || *p == '+')
+        p++;
+
+      int e = 0;
+
+      for (; *p >= '0' && *p <= '9'; p++)
+        e = std::min(e * 10 + (*p - '0'), 10000);
+
+      exponent += negativeExponent ? -e : e;
+    }
+
+    if (exponent >= -22 && exponent <= 22)
+      value = exponent < 0 ? mantissa / kPow10[-exponent] : mantissa * kPow10[exponent];
+    else
+      value = mantissa * std::pow(10., exponent);
+
+    if (negative)
+      value = -value;
+
+    return true;
+  }
+
+  static int Base64Digit(char c)
+  {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+' || c == '-') return 62;
+    if (c == '/' || c == '_') return 63;
+    return -1;
+  }
+
+  const char* mJSON;
+};
+
+END_IPLUG_NAMESPACE
@@ -17,6 +17,7 @@ using namespace iplug;
 WebViewEditorDelegate::WebViewEditorDelegate(int nParams)
   : IEditorDelegate(nParams)
   , IWebView()
+  , mMsgBatch(nParams)
 {
 }
 
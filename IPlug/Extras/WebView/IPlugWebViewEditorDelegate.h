@@ -12,8 +12,7 @@
 
 #include "IPlugEditorDelegate.h"
 #include "IPlugWebView.h"
-#include "wdl_base64.h"
-#include "json.hpp"
+#include "IPlugWebViewBridge.h"
 #include <functional>
 
 BEGIN_IPLUG_NAMESPACE
@@ -32,63 +31,76 @@ public:
   void CloseWindow() override
   {
     CloseWebView();
+    mMsgBatch.Clear();
   }
 
+  // messages to the web view are batched, and sent by FlushMessagesFromDelegate() as one script call per idle tick, see IPlugWebViewBridge.h
   void SendControlValueFromDelegate(int ctrlTag, double normalizedValue) override
   {
-    WDL_String str;
-    str.SetFormatted(50, "SCVFD(%i, %f)", ctrlTag, normalizedValue);
-    EvaluateJavaScript(str.Get());
+    mMsgBatch.AddControlValue(ctrlTag, normalizedValue);
   }
 
   void SendControlMsgFromDelegate(int ctrlTag, int msgTag, int dataSize, const void* pData) override
   {
-    WDL_String str;
-    WDL_TypedBuf<char> base64;
-    int sizeOfBase64 = static_cast<int>(4. * std::ceil((static_cast<double>(dataSize)/3.)));
-    base64.Resize(sizeOfBase64);
-    wdl_base64encode(reinterpret_cast<const unsigned char*>(pData), base64.GetFast(), dataSize);
-    str.SetFormatted(50, "SCMFD(%i, %i, %i, %s)", ctrlTag, msgTag, dataSize, base64.GetFast());
-    EvaluateJavaScript(str.Get());
+    mMsgBatch.AddControlMsg(ctrlTag, msgTag, dataSize, pData);
   }
 
   void SendParameterValueFromDelegate(int paramIdx, double value, bool normalized) override
   {
-    WDL_String str;
-    str.SetFormatted(50, "SPVFD(%i, %f)", paramIdx, value);
-    EvaluateJavaScript(str.Get());
+    mMsgBatch.AddParamValue(paramIdx, value);
   }
 
   void SendArbitraryMsgFromDelegate(int msgTag, int dataSize, const void* pData) override
   {
-    WDL_String str;
-    WDL_TypedBuf<char> base64;
-    int sizeOfBase64 = static_cast<int>(4. * std::ceil((static_cast<double>(dataSize)/3.)));
-    base64.Resize(sizeOfBase64);
-    wdl_base64encode(reinterpret_cast<const unsigned char*>(pData), base64.GetFast(), dataSize);
-    str.SetFormatted(50, "SAMFD(%i, %i, %s)", msgTag, dataSize, base64.GetFast());
-    EvaluateJavaScript(str.Get());
+    mMsgBatch.AddArbitraryMsg(msgTag, dataSize, pData);
+  }
+
+  void FlushMessagesFromDelegate() override
+  {
+    mMsgBatch.Flush([this](const char* script) { EvaluateJavaScript(script); });
   }
 
   void OnMessageFromWebView(const char* jsonStr) override
   {
-    auto json = nlohmann::json::parse(jsonStr, nullptr, false);
-    
-    if(json["msg"] == "SPVFUI")
+    const WebViewMsgReader msg(jsonStr);
+
+    if (msg.IsMsg("SPVFUI"))
     {
-      SendParameterValueFromUI(json["paramIdx"], json["value"]);
+      const int paramIdx = msg.GetInt("paramIdx", kNoParameter);
+
+      if (paramIdx > kNoParameter && paramIdx < NParams())
+        SendParameterValueFromUI(paramIdx, msg.GetDouble("value"));
     }
-    else if (json["msg"] == "BPCFUI")
+    else if (msg.IsMsg("BPCFUI"))
     {
-      BeginInformHostOfParamChangeFromUI(json["paramIdx"]);
+      const int paramIdx = msg.GetInt("paramIdx", kNoParameter);
+
+      if (paramIdx > kNoParameter && paramIdx < NParams())
+        BeginInformHostOfParamChangeFromUI(paramIdx);
     }
-    else if (json["msg"] == "EPCFUI")
+    else if (msg.IsMsg("EPCFUI"))
     {
-      EndInformHostOfParamChangeFromUI(json["paramIdx"]);
+      const int paramIdx = msg.GetInt("paramIdx", kNoParameter);
+
+      if (paramIdx > kNoParameter && paramIdx < NParams())
+        EndInformHostOfParamChangeFromUI(paramIdx);
     }
-    else if (json["msg"] == "SAMFUI")
+    else if (msg.IsMsg("SAMFUI"))
     {
-      SendArbitraryMsgFromUI(json["msgTag"], json["ctrlTag"], json["dataSize"], /*dataSize > 0 ? json["data"] :*/ nullptr);
+      const int dataSize = msg.GetBase64Data("data", mDataFromUI);
+      SendArbitraryMsgFromUI(msg.GetInt("msgTag", kNoTag), msg.GetInt("ctrlTag", kNoTag), dataSize, dataSize > 0 ? mDataFromUI.Get() : nullptr);
+    }
+    else if (msg.IsMsg("SMMFUI"))
+    {
+      const IMidiMsg midiMsg(0, static_cast<uint8_t>(msg.GetInt("statusByte")), static_cast<uint8_t>(msg.GetInt("dataByte1")), static_cast<uint8_t>(msg.GetInt("dataByte2")));
+      SendMidiMsgFromUI(midiMsg);
+    }
+    else if (msg.IsMsg("SSMFUI"))
+    {
+      const int dataSize = msg.GetBase64Data("data", mDataFromUI);
+
+      if (dataSize > 0)
+        SendSysexMsgFromUI(ISysEx(0, mDataFromUI.Get(), dataSize));
     }
   }
 
@@ -111,6 +123,10 @@ public:
   
 protected:
   std::function<void()> mEditorInitFunc = nullptr;
+
+private:
+  WebViewMsgBatch mMsgBatch;
+  WDL_TypedBuf<uint8_t> mDataFromUI;
 };
 
 END_IPLUG_NAMESPACE
@@ -23,6 +23,7 @@ using namespace iplug;
 WebViewEditorDelegate::WebViewEditorDelegate(int nParams)
 : IEditorDelegate(nParams)
 , IWebView()
+, mMsgBatch(nParams)
 {
 }
 
@@ -38,6 +38,7 @@ IPlugAPIBase::IPlugAPIBase(Config c, EAPI plugAPI)
   mStateChunks = c.plugDoesChunks;
   mAPI = plugAPI;
   mBundleID.Set(c.bundleID);
+  mParamChangeFromProcessor.Resize(c.nParams);
 
   Trace(TRACELOC, "%s:%s", c.pluginName, CurrentTime());
   
@@ -140,26 +141,25 @@ void IPlugAPIBase::DirtyParametersFromUI()
 
 void IPlugAPIBase::SendParameterValueFromAPI(int paramIdx, double value, bool normalized)
 {
-  //TODO: Can we assume that no host is stupid enough to try and set parameters on multiple threads at the same time?
-  // If that is the case then we need a MPSPC queue not SPSC
+  // the queue only keeps the latest value of each parameter, and is safe to push to from several threads
   if (normalized)
     value = GetParam(paramIdx)->FromNormalized(value);
   
-  mParamChangeFromProcessor.Push(ParamTuple { paramIdx, value } );
+  mParamChangeFromProcessor.Push(paramIdx, value);
 }
 
 void IPlugAPIBase::OnTimer(Timer& t)
 {
+  TRACE_IDLE_SCOPE;
+
   if(HasUI())
   {
     // in VST3, parameter changes are managed by the host
   #if !defined VST3C_API && !defined VST3P_API && !defined VST3_API
-    while(mParamChangeFromProcessor.ElementsAvailable())
-    {
-      ParamTuple p;
-      mParamChangeFromProcessor.Pop(p);
-      SendParameterValueFromDelegate(p.idx, p.value, false); // TODO:  if the parameter hasn't changed maybe we shouldn't do anything?
-    }
+    // only the parameters that changed since the last tick, once each, with their latest values
+    mParamChangeFromProcessor.Drain([this](int paramIdx, double value) {
+      SendParameterValueFromDelegate(paramIdx, value, false);
+    });
     
     while (mMidiMsgsFromProcessor.ElementsAvailable())
     {
@@ -195,6 +195,7 @@ void IPlugAPIBase::OnTimer(Timer& t)
   }
   
   OnIdle();
+  FlushMessagesFromDelegate();
 }
 
 void IPlugAPIBase::SendMidiMsgFromUI(const IMidiMsg& msg)
@@ -24,6 +24,7 @@
 #include "IPlugUtilities.h"
 #include "IPlugParameter.h"
 #include "IPlugQueue.h"
+#include "IPlugCoalescingQueue.h"
 #include "IPlugTimer.h"
 
 /**
@@ -214,7 +215,7 @@ protected:
   WDL_String mParamDisplayStr;
   std::unique_ptr<Timer> mTimer;
   
-  IPlugQueue<ParamTuple> mParamChangeFromProcessor {PARAM_TRANSFER_SIZE};
+  IPlugCoalescingQueue<double> mParamChangeFromProcessor; // the latest (non-normalized) value of each parameter changed by the host, to send to the editor on the next timer tick
   IPlugQueue<IMidiMsg> mMidiMsgsFromEditor {MIDI_TRANSFER_SIZE}; // a queue of midi messages generated in the editor by clicking keyboard UI etc
   IPlugQueue<IMidiMsg> mMidiMsgsFromProcessor {MIDI_TRANSFER_SIZE}; // a queue of MIDI messages received (potentially on the high priority thread), by the processor to send to the editor
   IPlugQueue<SysExData> mSysExDataFromEditor {SYSEX_TRANSFER_SIZE}; // a queue of SYSEX data to send to the processor
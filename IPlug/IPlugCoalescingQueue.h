@@ -0,0 +1,145 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+#pragma once
+
+/**
+ * @file
+ * @copydoc IPlugCoalescingQueue
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "IPlugPlatform.h"
+
+BEGIN_IPLUG_NAMESPACE
+
+/** A lock-free, latest-value-wins transport for a fixed number of indexed values (e.g. parameters), from any thread to one consumer thread.
+ * Each index has an atomic slot for its value and a bit in a "dirty" bitset. Push() stores the value and then sets the bit, Drain() atomically takes each word of the bitset
+ * and calls a function for each index that was set, with the latest value. Unlike an IPlugQueue, pushes never fail (nothing is dropped when there's a burst of changes),
+ * and the consumer's work depends on the number of distinct indices that changed since the last Drain(), not the number of changes.
+ * Intermediate values are not delivered, so only use it where the latest value is all that matters.
+ * @tparam T The value type, which should be lock-free as a std::atomic (e.g. double or float) */
+template<typename T>
+class IPlugCoalescingQueue final
+{
+public:
+  /** @param size The number of indices */
+  IPlugCoalescingQueue(int size = 0)
+  {
+    Resize(size);
+  }
+
+  IPlugCoalescingQueue(const IPlugCoalescingQueue&) = delete;
+  IPlugCoalescingQueue& operator=(const IPlugCoalescingQueue&) = delete;
+
+  /** Set the number of indices. This allocates and clears the dirty bits, so it's not thread safe
+   * @param size The number of indices */
+  void Resize(int size)
+  {
+    mSize = size > 0 ? size : 0;
+    mNWords = (mSize + kBitsPerWord - 1) / kBitsPerWord;
+    mSlots.reset(mSize ? new std::atomic<T>[mSize] : nullptr);
+    mDirty.reset(mNWords ? new std::atomic<uint64_t>[mNWords] : nullptr);
+
+    for (auto i = 0; i < mSize; i++)
+      mSlots[i].store(T(), std::memory_order_relaxed);
+
+    for (auto w = 0; w < mNWords; w++)
+      mDirty[w].store(0, std::memory_order_relaxed);
+  }
+
+  int GetSize() const { return mSize; }
+
+  /** Store a value, replacing any value that hasn't been drained yet. Wait-free, and can be called from several threads at once
+   * @param idx The index (0 - GetSize()-1)
+   * @param value The value */
+  void Push(int idx, T value)
+  {
+    if (idx < 0 || idx >= mSize)
+      return;
+
+    mSlots[idx].store(value, std::memory_order_relaxed);
+    mDirty[idx / kBitsPerWord].fetch_or(uint64_t(1) << (idx % kBitsPerWord), std::memory_order_release);
+  }
+
+  /** @return \c true if any index has been pushed since the last Drain() */
+  bool HasChanges() const
+  {
+    for (auto w = 0; w < mNWords; w++)
+    {
+      if (mDirty[w].load(std::memory_order_relaxed))
+        return true;
+    }
+
+    return false;
+  }
+
+  /** Call a function with the latest value of every index that was pushed since the last Drain(). Should only be called from one thread
+   * @param func A function taking (int idx, T value)
+   * @return The number of indices visited */
+  template<typename F>
+  int Drain(F&& func)
+  {
+    int nChanged = 0;
+
+    for (auto w = 0; w < mNWords; w++)
+    {
+      if (!mDirty[w].load(std::memory_order_relaxed))
+        continue;
+
+      // take the word's dirty bits, any push after this will set them again, and will be picked up by the next Drain()
+      uint64_t bits = mDirty[w].exchange(0, std::memory_order_acquire);
+
+      while (bits)
+      {
+        const int idx = (w * kBitsPerWord) + CountTrailingZeros(bits);
+        func(idx, mSlots[idx].load(std::memory_order_relaxed));
+        bits &= bits - 1;
+        nChanged++;
+      }
+    }
+
+    return nChanged;
+  }
+
+private:
+  static inline int CountTrailingZeros(uint64_t bits)
+  {
+#if defined _MSC_VER && defined _WIN64
+    unsigned long idx;
+    _BitScanForward64(&idx, bits);
+    return (int) idx;
+#elif defined _MSC_VER
+    unsigned long idx;
+    if (_BitScanForward(&idx, (unsigned long) bits))
+      return (int) idx;
+    _BitScanForward(&idx, (unsigned long) (bits >> 32));
+    return (int) idx + 32;
+#else
+    return __builtin_ctzll(bits);
+#endif
+  }
+
+  static constexpr int kBitsPerWord = 64;
+
+  std::unique_ptr<std::atomic<T>[]> mSlots;
+  std::unique_ptr<std::atomic<uint64_t>[]> mDirty;
+  int mSize = 0;
+  int mNWords = 0;
+};
+
+END_IPLUG_NAMESPACE
@@ -0,0 +1,181 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+#pragma once
+
+/**
+ * @file
+ * @brief A DSP load meter, that keeps statistics of the time taken to process each block as a fraction of the block's real-time budget (nFrames / sample rate)
+ *
+ * IPlugProcessor times every ProcessBuffers() call with it once IPlugProcessor::SetDSPLoadMetering() is enabled, see IPlugProcessor::GetDSPLoadMeter(). The audio thread is the only writer,
+ * and the statistics and histogram can be read from any thread (e.g. by an IDSPLoadControl on the UI thread) without locking.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "IPlugPlatform.h"
+
+BEGIN_IPLUG_NAMESPACE
+
+/** A summary of the blocks measured by a DSPLoadMeter since it was last reset. Loads are fractions of the real-time budget, so a load above 1 is an overrun */
+struct DSPLoadStats
+{
+  double mMean = 0.;
+  double mP99 = 0.; // to the histogram's resolution, DSPLoadMeter::kBinWidth
+  double mMax = 0.;
+  double mLast = 0.; // the load of the last block
+  int64_t mNBlocks = 0;
+  int64_t mNOverruns = 0;
+};
+
+/** Keeps a histogram and running statistics of the DSP load of each block. Recording a block costs two clock reads and a handful of relaxed atomic loads and stores, with no locks or read-modify-writes,
+ * because there is only one writer (the audio thread). A reader may see a block counted in some statistics but not yet in others, which doesn't matter for display or for adapting quality */
+class DSPLoadMeter
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr int kNumBins = 201; // 1% wide bins from 0 to 200%, loads above that are counted in the last bin
+  static constexpr double kBinWidth = 0.01;
+
+  DSPLoadMeter()
+  {
+    Clear();
+  }
+
+  DSPLoadMeter(const DSPLoadMeter&) = delete;
+  DSPLoadMeter& operator=(const DSPLoadMeter&) = delete;
+
+  /** Record the load of a block. Audio thread only
+   * @param start When processing of the block started
+   * @param nFrames The number of frames in the block
+   * @param sampleRate The sample rate
+   * @return The load of the block */
+  double AddBlock(Clock::time_point start, int nFrames, double sampleRate)
+  {
+    const double processSecs = std::chrono::duration<double>(Clock::now() - start).count();
+    const double load = nFrames > 0 ? processSecs * sampleRate / nFrames : 0.;
+    AddLoad(load);
+    return load;
+  }
+
+  /** Record the load of a block. Audio thread only
+   * @param load The time taken to process the block, as a fraction of its duration */
+  void AddLoad(double load)
+  {
+    if (mResetRequested.load(std::memory_order_acquire))
+    {
+      Clear();
+      mResetRequested.store(false, std::memory_order_release);
+    }
+
+    const int bin = load < (kNumBins - 1) * kBinWidth ? (int) (load * (1. / kBinWidth)) : kNumBins - 1;
+    Increment(mBins[bin]);
+    Increment(mNBlocks);
+
+    if (load > 1.)
+      Increment(mNOverruns);
+
+    mSumLoad.store(mSumLoad.load(std::memory_order_relaxed) + load, std::memory_order_relaxed);
+    mLastLoad.store((float) load, std::memory_order_relaxed);
+
+    if (load > mMaxLoad.load(std::memory_order_relaxed))
+      mMaxLoad.store((float) load, std::memory_order_relaxed);
+  }
+
+  /** Ask the audio thread to clear the statistics before it records the next block. Can be called from any thread */
+  void Reset() const { mResetRequested.store(true, std::memory_order_release); }
+
+  /** @return The statistics since the last reset. Can be called from any thread */
+  DSPLoadStats GetStats() const
+  {
+    DSPLoadStats stats;
+    stats.mNBlocks = mNBlocks.load(std::memory_order_relaxed);
+    stats.mNOverruns = mNOverruns.load(std::memory_order_relaxed);
+    stats.mLast = mLastLoad.load(std::memory_order_relaxed);
+    stats.mMax = mMaxLoad.load(std::memory_order_relaxed);
+
+    if (stats.mNBlocks > 0)
+    {
+      stats.mMean = mSumLoad.load(std::memory_order_relaxed) / stats.mNBlocks;
+      stats.mP99 = GetPercentile(0.99);
+    }
+
+    return stats;
+  }
+
+  /** @param fraction The fraction of blocks, e.g. 0.99 for the 99th percentile
+   * @return The load that the fraction of blocks were at or below, rounded up to a bin edge. Can be called from any thread */
+  double GetPercentile(double fraction) const
+  {
+    uint32_t counts[kNumBins];
+    const int64_t total = GetHistogram(counts);
+    const double target = fraction * total;
+    int64_t sum = 0;
+
+    for (auto i = 0; i < kNumBins; i++)
+    {
+      sum += counts[i];
+
+      if (sum > 0 && sum >= target)
+        return (i + 1) * kBinWidth;
+    }
+
+    return 0.;
+  }
+
+  /** Copy the histogram. Can be called from any thread
+   * @param counts An array of kNumBins counts, bin i counting the blocks with loads from i * kBinWidth up to (i + 1) * kBinWidth
+   * @return The sum of the counts */
+  int64_t GetHistogram(uint32_t* counts) const
+  {
+    int64_t total = 0;
+
+    for (auto i = 0; i < kNumBins; i++)
+    {
+      counts[i] = mBins[i].load(std::memory_order_relaxed);
+      total += counts[i];
+    }
+
+    return total;
+  }
+
+private:
+  template <typename T>
+  static void Increment(std::atomic<T>& counter)
+  {
+    // only the audio thread writes, so there's no need for an atomic read-modify-write
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  void Clear()
+  {
+    for (auto& bin : mBins)
+      bin.store(0, std::memory_order_relaxed);
+
+    mNBlocks.store(0, std::memory_order_relaxed);
+    mNOverruns.store(0, std::memory_order_relaxed);
+    mSumLoad.store(0., std::memory_order_relaxed);
+    mLastLoad.store(0.f, std::memory_order_relaxed);
+    mMaxLoad.store(0.f, std::memory_order_relaxed);
+  }
+
+  std::atomic<uint32_t> mBins[kNumBins];
+  std::atomic<int64_t> mNBlocks{0};
+  std::atomic<int64_t> mNOverruns{0};
+  std::atomic<double> mSumLoad{0.};
+  std::atomic<float> mLastLoad{0.f};
+  std::atomic<float> mMaxLoad{0.f};
+  mutable std::atomic<bool> mResetRequested{false}; // a request, so that readers holding a const meter can reset it
+};
+
+END_IPLUG_NAMESPACE
@@ -224,6 +224,11 @@ public:
    * @param normalized \c true if value is normalised */
   virtual void SendParameterValueFromDelegate(int paramIdx, double value, bool normalized) { OnParamChangeUI(paramIdx, EParamSource::kDelegate); } // TODO: normalised?
 
+  /** FlushMessagesFromDelegate
+   * Called on the main thread at the end of every idle timer tick, after the parameter changes, MIDI and SysEx from the processor have been sent and OnIdle() has been called.
+   * Editor delegates that batch the messages they send to the user interface, such as WebViewEditorDelegate, send the batch here */
+  virtual void FlushMessagesFromDelegate() {}
+
 #pragma mark - Methods for sending values FROM the user interface
   // The following methods are called from the user interface in order to set or query values of parameters in the class implementing IEditorDelegate
   
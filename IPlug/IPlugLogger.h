@@ -17,6 +17,8 @@
  * To trace some arbitrary data:                 Trace(TRACELOC, "%s:%d", myStr, myInt);
  * To simply create a trace entry in the log:    TRACE
  * No need to wrap tracer calls in #ifdef TRACER_BUILD because Trace is a no-op unless TRACER_BUILD is defined.
+ *
+ * Trace() is slow (it formats and writes a line under a lock), for timing measurements use the scoped macros in IPlugTracer.h, e.g. TRACE_PROCESS_SCOPE;
  */
 
 #include <cstdio>
@@ -648,3 +650,5 @@ static const char* VSTOpcodeStr(int opCode) { return ""; }
 #endif // !TRACER_BUILD
 
 END_IPLUG_NAMESPACE
+
+#include "IPlugTracer.h"
@@ -15,6 +15,7 @@
 
 #include <cstdio>
 #include <algorithm>
+#include <typeinfo>
 
 #include "IPlugParameter.h"
 #include "IPlugLogger.h"
@@ -168,6 +169,32 @@ void IParam::InitDouble(const char* name, double defaultVal, double minVal, doub
     
   mShape = std::unique_ptr<Shape>(shape.Clone());
   mShape->Init(*this);
+  InitShapeID();
+}
+
+void IParam::InitShapeID()
+{
+  const Shape& shape = *mShape;
+
+  // only the exact built-in types can be inlined, a derived struct may override the virtual methods
+  if (typeid(shape) == typeid(ShapeLinear))
+  {
+    mShapeID = EShapeID::kShapeLinear;
+  }
+  else if (typeid(shape) == typeid(ShapePowCurve))
+  {
+    mShapeID = EShapeID::kShapePowCurve;
+    mShapeExponent = static_cast<const ShapePowCurve&>(shape).mShape;
+    mShapeInvExponent = 1.0 / mShapeExponent;
+  }
+  else if (typeid(shape) == typeid(ShapeExp))
+  {
+    mShapeID = EShapeID::kShapeExp;
+    mShapeMul = static_cast<const ShapeExp&>(shape).mMul;
+    mShapeAdd = static_cast<const ShapeExp&>(shape).mAdd;
+  }
+  else
+    mShapeID = EShapeID::kShapeCustom;
 }
 
 void IParam::InitFrequency(const char *name, double defaultVal, double minVal, double maxVal, double step, int flags, const char *group)
@@ -259,6 +286,85 @@ void IParam::SetDisplayPrecision(int precision)
   mDisplayPrecision = precision;
 }
 
+void IParam::ToNormalized(const double* pValues, double* pNormalized, int nValues) const
+{
+  const double min = mMin;
+  const double max = mMax;
+  const double rangeRecip = 1.0 / (mMax - mMin);
+
+  if (mFlags & kFlagStepped)
+  {
+    for (auto i = 0; i < nValues; i++)
+      pNormalized[i] = Constrain(pValues[i]);
+  }
+  else
+  {
+    for (auto i = 0; i < nValues; i++)
+      pNormalized[i] = Clip(pValues[i], min, max);
+  }
+
+  switch (mShapeID)
+  {
+    case EShapeID::kShapeLinear:
+      for (auto i = 0; i < nValues; i++)
+        pNormalized[i] = (pNormalized[i] - min) * rangeRecip;
+      break;
+    case EShapeID::kShapePowCurve:
+      for (auto i = 0; i < nValues; i++)
+        pNormalized[i] = std::pow((pNormalized[i] - min) * rangeRecip, mShapeInvExponent);
+      break;
+    case EShapeID::kShapeExp:
+      for (auto i = 0; i < nValues; i++)
+        pNormalized[i] = (std::log(pNormalized[i]) - mShapeAdd) / mShapeMul;
+      break;
+    default:
+      for (auto i = 0; i < nValues; i++)
+        pNormalized[i] = mShape->ValueToNormalized(pNormalized[i], *this);
+      break;
+  }
+
+  for (auto i = 0; i < nValues; i++)
+    pNormalized[i] = Clip(pNormalized[i], 0., 1.);
+}
+
+void IParam::FromNormalized(const double* pNormalized, double* pValues, int nValues) const
+{
+  const double min = mMin;
+  const double max = mMax;
+  const double range = mMax - mMin;
+
+  switch (mShapeID)
+  {
+    case EShapeID::kShapeLinear:
+      for (auto i = 0; i < nValues; i++)
+        pValues[i] = min + pNormalized[i] * range;
+      break;
+    case EShapeID::kShapePowCurve:
+      for (auto i = 0; i < nValues; i++)
+        pValues[i] = min + std::pow(pNormalized[i], mShapeExponent) * range;
+      break;
+    case EShapeID::kShapeExp:
+      for (auto i = 0; i < nValues; i++)
+        pValues[i] = std::exp(mShapeAdd + pNormalized[i] * mShapeMul);
+      break;
+    default:
+      for (auto i = 0; i < nValues; i++)
+        pValues[i] = mShape->NormalizedToValue(pNormalized[i], *this);
+      break;
+  }
+
+  if (mFlags & kFlagStepped)
+  {
+    for (auto i = 0; i < nValues; i++)
+      pValues[i] = Constrain(pValues[i]);
+  }
+  else
+  {
+    for (auto i = 0; i < nValues; i++)
+      pValues[i] = Clip(pValues[i], min, max);
+  }
+}
+
 void IParam::GetDisplay(double value, bool normalized, WDL_String& str, bool withDisplayText) const
 {
   if (normalized) value = FromNormalized(value);
@@ -288,20 +394,11 @@ void IParam::GetDisplay(double value, bool normalized, WDL_String& str, bool wit
   // Squash all zeros to positive
   if (!displayValue) displayValue = 0.0;
 
-  if (mDisplayPrecision == 0)
-  {
-    str.SetFormatted(MAX_PARAM_DISPLAY_LEN, "%d", static_cast<int>(round(displayValue)));
-  }
-  else if ((mFlags & kFlagSignDisplay) && displayValue)
-  {
-    char fmt[16];
-    sprintf(fmt, "%%+.%df", mDisplayPrecision);
-    str.SetFormatted(MAX_PARAM_DISPLAY_LEN, fmt, displayValue);
-  }
-  else
-  {
-    str.SetFormatted(MAX_PARAM_DISPLAY_LEN, "%.*f", mDisplayPrecision, displayValue);
-  }
+  // FormatFixed avoids the printf machinery, since this is called a lot when hosts/UIs query parameter displays
+  char buf[MAX_PARAM_DISPLAY_LEN];
+  const bool forceSign = mDisplayPrecision > 0 && (mFlags & kFlagSignDisplay) && displayValue;
+  FormatFixed(buf, MAX_PARAM_DISPLAY_LEN, displayValue, mDisplayPrecision, forceSign);
+  str.Set(buf);
 }
 
 const char* IParam::GetName() const
@@ -126,6 +126,10 @@ public:
     double mAdd = 1.0;
   };
 
+  /** Identifies the built-in Shape types. For these IParam inlines the shaping math in ToNormalized()/FromNormalized(),
+   * rather than calling through the virtual Shape methods. Shapes derived from these are treated as kShapeCustom */
+  enum class EShapeID { kShapeLinear, kShapePowCurve, kShapeExp, kShapeCustom };
+
 #pragma mark -
 
   IParam();
@@ -274,7 +278,7 @@ public:
    * @return The corresponding normalized value, for this parameter */
   inline double ToNormalized(double nonNormalizedValue) const
   {
-    return Clip(mShape->ValueToNormalized(Constrain(nonNormalizedValue), *this), 0., 1.);
+    return Clip(ShapeValueToNormalized(Constrain(nonNormalizedValue)), 0., 1.);
   }
 
   /** Convert a normalized value to real value for this parameter
@@ -282,9 +286,21 @@ public:
    * @return The corresponding real value, for this parameter */
   inline double FromNormalized(double normalizedValue) const
   {
-    return Constrain(mShape->NormalizedToValue(normalizedValue, *this));
+    return Constrain(ShapeNormalizedToValue(normalizedValue));
   }
 
+  /** Convert an array of real values to normalized values for this parameter. The shape is only dispatched once, so the loops can be vectorized
+   * @param pValues Pointer to nValues real input values
+   * @param pNormalized Pointer to an array of nValues to fill with the normalized values (may be the same as pValues)
+   * @param nValues The number of values to convert */
+  void ToNormalized(const double* pValues, double* pNormalized, int nValues) const;
+
+  /** Convert an array of normalized values to real values for this parameter. The shape is only dispatched once, so the loops can be vectorized
+   * @param pNormalized Pointer to nValues normalized input values in the range 0. to 1.
+   * @param pValues Pointer to an array of nValues to fill with the real values (may be the same as pNormalized)
+   * @param nValues The number of values to convert */
+  void FromNormalized(const double* pNormalized, double* pValues, int nValues) const;
+
   /** Sets the parameter value
    * @param value Value to be set. Will be stepped and clamped between \c mMin and \c mMax */
   void Set(double value) { mValue.store(Constrain(value)); }
@@ -420,6 +436,10 @@ public:
    * @note This is only used for AU plugins to determine the mapping of parameters
    * @return EDisplayType */
   EDisplayType DisplayType() const { return mShape->GetDisplayType(); }
+
+  /** Get the parameter's shape ID
+   * @return EShapeID The kind of built-in shape, or EShapeID::kShapeCustom */
+  EShapeID ShapeID() const { return mShapeID; }
   
   /** Returns the parameter's default value
    * @param normalized Should the returned value be the default as a normalized or real value
@@ -478,6 +498,33 @@ public:
   /** Helper to print the parameter details to debug console in debug builds */
   void PrintDetails() const;
 private:
+  /** Shape a real value to a normalized value, without constraining/clipping */
+  inline double ShapeValueToNormalized(double value) const
+  {
+    switch (mShapeID)
+    {
+      case EShapeID::kShapeLinear: return (value - mMin) / (mMax - mMin);
+      case EShapeID::kShapePowCurve: return std::pow((value - mMin) / (mMax - mMin), mShapeInvExponent);
+      case EShapeID::kShapeExp: return (std::log(value) - mShapeAdd) / mShapeMul;
+      default: return mShape->ValueToNormalized(value, *this);
+    }
+  }
+
+  /** Shape a normalized value to a real value, without constraining */
+  inline double ShapeNormalizedToValue(double normalizedValue) const
+  {
+    switch (mShapeID)
+    {
+      case EShapeID::kShapeLinear: return mMin + normalizedValue * (mMax - mMin);
+      case EShapeID::kShapePowCurve: return mMin + std::pow(normalizedValue, mShapeExponent) * (mMax - mMin);
+      case EShapeID::kShapeExp: return std::exp(mShapeAdd + normalizedValue * mShapeMul);
+      default: return mShape->NormalizedToValue(normalizedValue, *this);
+    }
+  }
+
+  /** Cache the values needed for the inline shaping, called after mShape is initialized */
+  void InitShapeID();
+
   /** A DisplayText is used to link a certain real value of the parameter with a CString. For example -70 on a decibel gain parameter could instead read "-inf" */
   struct DisplayText
   {
@@ -500,6 +547,11 @@ private:
   char mParamGroup[MAX_PARAM_GROUP_LEN];
   
   std::unique_ptr<Shape> mShape;
+  EShapeID mShapeID = EShapeID::kShapeLinear;
+  double mShapeExponent = 1.0; // ShapePowCurve
+  double mShapeInvExponent = 1.0; // ShapePowCurve
+  double mShapeMul = 1.0; // ShapeExp
+  double mShapeAdd = 1.0; // ShapeExp
   DisplayFunc mDisplayFunction = nullptr;
 
   WDL_TypedBuf<DisplayText> mDisplayTexts;
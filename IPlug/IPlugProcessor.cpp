@@ -13,6 +13,8 @@
  * @brief IPlugProcessor implementation.
  */
 
+#include <chrono>
+
 #include "IPlugProcessor.h"
 
 #ifdef OS_WIN
@@ -35,6 +37,8 @@ IPlugProcessor::IPlugProcessor(const Config& config, EAPI plugAPI)
 
   mScratchData[ERoute::kInput].Resize(totalNInChans);
   mScratchData[ERoute::kOutput].Resize(totalNOutChans);
+  mHostData[ERoute::kInput].Resize(totalNInChans);
+  mHostData[ERoute::kOutput].Resize(totalNOutChans);
 
   sample** ppInData = mScratchData[ERoute::kInput].Get();
 
@@ -88,6 +92,20 @@ void IPlugProcessor::ProcessBlock(sample** inputs, sample** outputs, int nFrames
   }
 }
 
+void IPlugProcessor::ProcessBlockHostPrecision(PLUG_SAMPLE_SRC** inputs, PLUG_SAMPLE_SRC** outputs, int nFrames)
+{
+  const int nIn = mChannelData[ERoute::kInput].GetSize();
+  const int nOut = mChannelData[ERoute::kOutput].GetSize();
+
+  for (int i = 0; i < nOut; ++i)
+  {
+    if (i < nIn)
+      memcpy(outputs[i], inputs[i], nFrames * sizeof(PLUG_SAMPLE_SRC));
+    else
+      memset(outputs[i], 0, nFrames * sizeof(PLUG_SAMPLE_SRC));
+  }
+}
+
 void IPlugProcessor::ProcessMidiMsg(const IMidiMsg& msg)
 {
   SendMidiMsg(msg);
@@ -469,7 +487,13 @@ void IPlugProcessor::AttachBuffers(ERoute direction, int idx, int n, PLUG_SAMPLE
       if (direction == ERoute::kInput)
       {
         PLUG_SAMPLE_DST* pScratch = pChannel->mScratchBuf.Get();
-        CastCopy(pScratch, *(ppData++), nFrames);
+
+        // when processing at the host's precision, the input is only converted if it turns out to be needed, see ConvertHostInputs()
+        if (mProcessHostPrecision)
+          pChannel->mIncomingData = *(ppData++);
+        else
+          CastCopy(pScratch, *(ppData++), nFrames);
+
         *(pChannel->mData) = pScratch;
       }
       else // output
@@ -491,15 +515,39 @@ void IPlugProcessor::PassThroughBuffers(PLUG_SAMPLE_DST type, int nFrames)
 
 void IPlugProcessor::PassThroughBuffers(PLUG_SAMPLE_SRC type, int nFrames)
 {
+  if (mProcessHostPrecision)
+    ConvertHostInputs(nFrames);
+
   // for PLUG_SAMPLE_SRC bit buffers, first run the delay (if mLatency) on the PLUG_SAMPLE_DST IPlug buffers
   PassThroughBuffers(PLUG_SAMPLE_DST(0.), nFrames);
+  ConvertHostOutputs(nFrames);
+}
+
+void IPlugProcessor::ConvertHostInputs(int nFrames)
+{
+  int i, n = MaxNChannels(ERoute::kInput);
+  IChannelData<>** ppInChannel = mChannelData[ERoute::kInput].GetList();
+
+  for (i = 0; i < n; ++i, ++ppInChannel)
+  {
+    IChannelData<>* pInChannel = *ppInChannel;
 
+    if (pInChannel->mConnected)
+    {
+      CastCopy(*(pInChannel->mData), pInChannel->mIncomingData, nFrames);
+    }
+  }
+}
+
+void IPlugProcessor::ConvertHostOutputs(int nFrames)
+{
   int i, n = MaxNChannels(ERoute::kOutput);
   IChannelData<>** ppOutChannel = mChannelData[ERoute::kOutput].GetList();
 
   for (i = 0; i < n; ++i, ++ppOutChannel)
   {
     IChannelData<>* pOutChannel = *ppOutChannel;
+
     if (pOutChannel->mConnected)
     {
       CastCopy(pOutChannel->mIncomingData, *(pOutChannel->mData), nFrames);
@@ -507,30 +555,177 @@ void IPlugProcessor::PassThroughBuffers(PLUG_SAMPLE_SRC type, int nFrames)
   }
 }
 
+template <typename T>
+bool IPlugProcessor::InputsAreSilent(T** ppInData, int nFrames) const
+{
+  if (mInputsSilentFromHost)
+    return true;
+
+  const int nIn = MaxNChannels(ERoute::kInput);
+  const T threshold = static_cast<T>(mSilenceThreshold.load(std::memory_order_relaxed));
+
+  for (auto c = 0; c < nIn; c++)
+  {
+    if (!mChannelData[ERoute::kInput].Get(c)->mConnected)
+      continue;
+
+    const T* pData = ppInData[c];
+
+    // in chunks with no early exit inside, so that the compiler can vectorize the comparisons
+    for (auto s = 0; s < nFrames; s += 64)
+    {
+      const int n = std::min(64, nFrames - s);
+      int loud = 0;
+
+      for (auto i = 0; i < n; i++)
+        loud |= std::abs(pData[s + i]) > threshold;
+
+      if (loud)
+        return false;
+    }
+  }
+
+  return true;
+}
+
+bool IPlugProcessor::UpdateSilence(bool inputsSilent, int nFrames)
+{
+  mInputsSilentFromHost = false;
+
+  const bool restart = mSilenceRestart.exchange(false, std::memory_order_relaxed);
+
+  if (!inputsSilent || restart)
+  {
+    mNSilentFrames = 0;
+    return false;
+  }
+
+  const bool skip = mTailSize >= 0 && mNSilentFrames >= static_cast<int64_t>(mTailSize) + mLatency;
+  mNSilentFrames += nFrames;
+  return skip;
+}
+
+void IPlugProcessor::UpdateQualityTier()
+{
+  EQualityTier tier;
+
+  if (mRenderingOffline)
+    tier = (EQualityTier) mOfflineQualityTier.load(std::memory_order_relaxed);
+  else if (mAdaptiveQuality.load(std::memory_order_relaxed))
+    tier = std::min(mQualityGovernor.GetTier(), (EQualityTier) mRealtimeQualityTier.load(std::memory_order_relaxed));
+  else
+    tier = (EQualityTier) mRealtimeQualityTier.load(std::memory_order_relaxed);
+
+  if (tier != mQualityTier)
+  {
+    mQualityTier = tier;
+
+    for (auto i = 0; i < mQualityTierListeners.GetSize(); i++)
+      mQualityTierListeners.Get(i)->OnQualityTierChanged(tier);
+
+    OnQualityTierChanged(tier);
+  }
+}
+
+bool IPlugProcessor::MeasuringDSPLoad() const
+{
+  // offline rendering has no deadline, so there's nothing to measure the load against
+  return !mRenderingOffline && (mDSPLoadMetering.load(std::memory_order_relaxed) || mAdaptiveQuality.load(std::memory_order_relaxed));
+}
+
+void IPlugProcessor::EndDSPLoadMeasurement(DSPLoadMeter::Clock::time_point start, int nFrames)
+{
+  const double load = mDSPLoadMeter.AddBlock(start, nFrames, mSampleRate);
+
+  if (mAdaptiveQuality.load(std::memory_order_relaxed))
+    mQualityGovernor.Update(load, nFrames / mSampleRate, (EQualityTier) mRealtimeQualityTier.load(std::memory_order_relaxed));
+}
+
 void IPlugProcessor::ProcessBuffers(PLUG_SAMPLE_DST type, int nFrames)
 {
-  ProcessBlock(mScratchData[ERoute::kInput].Get(), mScratchData[ERoute::kOutput].Get(), nFrames);
+  TRACE_PROCESS_SCOPE;
+
+  const bool measureLoad = MeasuringDSPLoad();
+  const auto start = measureLoad ? DSPLoadMeter::Clock::now() : DSPLoadMeter::Clock::time_point();
+
+  sample** ppInData = mScratchData[ERoute::kInput].Get();
+  sample** ppOutData = mScratchData[ERoute::kOutput].Get();
+
+  UpdateQualityTier();
+
+  mOutputsSilent = mSilenceSkipping.load(std::memory_order_relaxed) && UpdateSilence(InputsAreSilent(ppInData, nFrames), nFrames);
+
+  if (mOutputsSilent)
+  {
+    const int nOut = MaxNChannels(ERoute::kOutput);
+
+    for (auto c = 0; c < nOut; c++)
+      memset(ppOutData[c], 0, nFrames * sizeof(sample));
+
+    mNSkippedBlocks.fetch_add(1, std::memory_order_relaxed);
+  }
+  else
+    ProcessBlock(ppInData, ppOutData, nFrames);
+
+  if (measureLoad)
+    EndDSPLoadMeasurement(start, nFrames);
 }
 
 void IPlugProcessor::ProcessBuffers(PLUG_SAMPLE_SRC type, int nFrames)
 {
-  ProcessBuffers((PLUG_SAMPLE_DST) 0, nFrames);
-  int i, n = MaxNChannels(ERoute::kOutput);
-  IChannelData<>** ppOutChannel = mChannelData[ERoute::kOutput].GetList();
+  if (!mProcessHostPrecision)
+  {
+    ProcessBuffers((PLUG_SAMPLE_DST) 0, nFrames);
+    ConvertHostOutputs(nFrames);
+    return;
+  }
 
-  for (i = 0; i < n; ++i, ++ppOutChannel)
+  TRACE_PROCESS_SCOPE;
+
+  const bool measureLoad = MeasuringDSPLoad();
+  const auto start = measureLoad ? DSPLoadMeter::Clock::now() : DSPLoadMeter::Clock::time_point();
+
+  // the host's buffers, or zeroed host precision scratch buffers for unconnected channels
+  for (auto direction : { ERoute::kInput, ERoute::kOutput })
   {
-    IChannelData<>* pOutChannel = *ppOutChannel;
+    int i, n = MaxNChannels(direction);
+    PLUG_SAMPLE_SRC** ppData = mHostData[direction].Get();
 
-    if (pOutChannel->mConnected)
+    for (i = 0; i < n; ++i)
     {
-      CastCopy(pOutChannel->mIncomingData, *(pOutChannel->mData), nFrames);
+      IChannelData<>* pChannel = mChannelData[direction].Get(i);
+      ppData[i] = pChannel->mConnected ? pChannel->mIncomingData : pChannel->mHostScratchBuf.Get();
     }
   }
+
+  PLUG_SAMPLE_SRC** ppInData = mHostData[ERoute::kInput].Get();
+  PLUG_SAMPLE_SRC** ppOutData = mHostData[ERoute::kOutput].Get();
+
+  UpdateQualityTier();
+
+  mOutputsSilent = mSilenceSkipping.load(std::memory_order_relaxed) && UpdateSilence(InputsAreSilent(ppInData, nFrames), nFrames);
+
+  if (mOutputsSilent)
+  {
+    const int nOut = MaxNChannels(ERoute::kOutput);
+
+    for (auto c = 0; c < nOut; c++)
+      memset(ppOutData[c], 0, nFrames * sizeof(PLUG_SAMPLE_SRC));
+
+    mNSkippedBlocks.fetch_add(1, std::memory_order_relaxed);
+  }
+  else
+    ProcessBlockHostPrecision(ppInData, ppOutData, nFrames);
+
+  if (measureLoad)
+    EndDSPLoadMeasurement(start, nFrames);
 }
 
 void IPlugProcessor::ProcessBuffersAccumulating(int nFrames)
 {
+  if (mProcessHostPrecision)
+    ConvertHostInputs(nFrames);
+
   ProcessBuffers((PLUG_SAMPLE_DST) 0, nFrames);
   int i, n = MaxNChannels(ERoute::kOutput);
   IChannelData<>** ppOutChannel = mChannelData[ERoute::kOutput].GetList();
@@ -588,5 +783,40 @@ void IPlugProcessor::SetBlockSize(int blockSize)
     }
 
     mBlockSize = blockSize;
+    ResizeHostScratchBuffers();
+  }
+}
+
+void IPlugProcessor::SetProcessHostPrecision(bool enable)
+{
+  mProcessHostPrecision = enable;
+  ResizeHostScratchBuffers();
+}
+
+void IPlugProcessor::AddQualityTierListener(IQualityTierListener* pListener)
+{
+  if (mQualityTierListeners.Find(pListener) < 0)
+    mQualityTierListeners.Add(pListener);
+
+  pListener->OnQualityTierChanged(mQualityTier);
+}
+
+void IPlugProcessor::ResizeHostScratchBuffers()
+{
+  // not needed unless processing at the host's precision, so they take no memory by default
+  const int size = mProcessHostPrecision ? mBlockSize : 0;
+
+  for (auto direction : { ERoute::kInput, ERoute::kOutput })
+  {
+    int i, n = MaxNChannels(direction);
+
+    for (i = 0; i < n; ++i)
+    {
+      IChannelData<>* pChannel = mChannelData[direction].Get(i);
+      pChannel->mHostScratchBuf.Resize(size);
+
+      if (size)
+        memset(pChannel->mHostScratchBuf.Get(), 0, size * sizeof(PLUG_SAMPLE_SRC));
+    }
   }
 }
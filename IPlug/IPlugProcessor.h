@@ -10,6 +10,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <cstdint>
 #include <ctime>
@@ -25,6 +26,8 @@
 #include "IPlugConstants.h"
 #include "IPlugStructs.h"
 #include "IPlugUtilities.h"
+#include "IPlugQuality.h"
+#include "IPlugDSPLoadMeter.h"
 #include "NChanDelay.h"
 
 /**
@@ -61,6 +64,21 @@ public:
    * @param nFrames The block size for this block: number of samples per channel.*/
   virtual void ProcessBlock(sample** inputs, sample** outputs, int nFrames);
 
+  /** Override this as well as ProcessBlock() to process the host's buffers directly when the host's sample type (PLUG_SAMPLE_SRC) is not the plug-in's \c sample type,
+   * e.g. a host running 32 bit audio when \c sample is double. Otherwise every input is converted to \c sample before ProcessBlock() and every output converted back after it.
+   * It is only called if SetProcessHostPrecision(true) was called in the plug-in's constructor. The simplest way to implement both is with a template method that they both call, e.g.
+   * @code
+   * template <typename T> void DoProcess(T** inputs, T** outputs, int nFrames);
+   * void ProcessBlock(sample** inputs, sample** outputs, int nFrames) override { DoProcess(inputs, outputs, nFrames); }
+   * void ProcessBlockHostPrecision(PLUG_SAMPLE_SRC** inputs, PLUG_SAMPLE_SRC** outputs, int nFrames) override { DoProcess(inputs, outputs, nFrames); }
+   * @endcode
+   * The same guarantees apply as for ProcessBlock(): there are valid pointers for all the channels, and the unconnected inputs are full of zeros.
+   * THIS METHOD IS CALLED BY THE HIGH PRIORITY AUDIO THREAD - You should be careful not to do any unbounded, blocking operations such as file I/O which could cause audio dropouts
+   * @param inputs Two-dimensional array containing the non-interleaved input buffers of audio samples for all channels
+   * @param outputs Two-dimensional array for audio output (non-interleaved).
+   * @param nFrames The block size for this block: number of samples per channel.*/
+  virtual void ProcessBlockHostPrecision(PLUG_SAMPLE_SRC** inputs, PLUG_SAMPLE_SRC** outputs, int nFrames);
+
   /** Override this method to handle incoming MIDI messages. The method is called prior to ProcessBlock().
    * You can use IMidiQueue in combination with this method in order to queue the message and process at the appropriate time in ProcessBlock()
    * THIS METHOD IS CALLED BY THE HIGH PRIORITY AUDIO THREAD - You should be careful not to do any unbounded, blocking operations such as file I/O which could cause audio dropouts
@@ -80,6 +98,11 @@ public:
    * @param active \c true if the host has activated the plug-in */
   virtual void OnActivate(bool active) { TRACE }
 
+  /** Override this method to change the plug-in's DSP when the quality tier changes, see SetRealtimeQualityTier(). It is called on the audio thread, before the ProcessBlock() that should use the new tier,
+   * after the listeners added with AddQualityTierListener() have been told. You should not allocate or do anything blocking here
+   * @param tier The tier for the next block */
+  virtual void OnQualityTierChanged(EQualityTier tier) {}
+
 #pragma mark - Methods you can call - some of which have custom implementations in the API classes, some implemented in IPlugProcessor.cpp
 
   /** Send a single MIDI message // TODO: info about what thread should this be called on or not called on!
@@ -109,12 +132,34 @@ public:
   /** @return The tail size in samples (useful for reverberation plug-ins, that may need to decay after the transport stops or an audio item ends) */
   int GetTailSize() { return mTailSize; }
 
+  /** @return \c true if silence skipping is enabled, see SetSilenceSkipping() */
+  bool GetSilenceSkipping() const { return mSilenceSkipping.load(std::memory_order_relaxed); }
+
+  /** @return The number of blocks for which ProcessBlock() was skipped because the inputs were silent and the tail had finished, since the plug-in was created. Can be called from any thread */
+  int GetNSkippedBlocks() const { return mNSkippedBlocks.load(std::memory_order_relaxed); }
+
+  /** @return \c true if ProcessBlock() was skipped for the last block and the outputs were zeroed, so the host can be told that they are silent */
+  bool GetOutputsSilent() const { return mOutputsSilent; }
+
   /** @return \c true if the plugin is currently bypassed */
   bool GetBypassed() const { return mBypassed; }
 
   /** @return \c true if the plugin is currently rendering off-line */
   bool GetRenderingOffline() const { return mRenderingOffline; };
 
+  /** @return The quality tier of the current block, which only changes between blocks, see SetRealtimeQualityTier() */
+  EQualityTier GetQualityTier() const { return mQualityTier; }
+
+  /** @return The smoothed DSP load measured by the quality governor, if adaptive quality is enabled. Can be called from any thread */
+  double GetQualityGovernorLoad() const { return mQualityGovernor.GetLoad(); }
+
+  /** @return The meter that times every ProcessBuffers() call, while DSP load metering is enabled and the host isn't rendering offline. Its statistics can be read from any thread,
+   * e.g. with GetDSPLoadMeter().GetStats(), to display them (see IDSPLoadControl) or to adapt the plug-in's quality */
+  const DSPLoadMeter& GetDSPLoadMeter() const { return mDSPLoadMeter; }
+
+  /** Clear the DSP load statistics, before the audio thread records the next block. Can be called from any thread */
+  void ResetDSPLoadMeter() { mDSPLoadMeter.Reset(); }
+
 #pragma mark -
   /** @return The number of samples elapsed since start of project timeline. */
   double GetSamplePos() const { return mTimeInfo.mSamplePos; }
@@ -234,6 +279,63 @@ public:
    * @param tailSize the new tailsize in samples*/
   void SetTailSize(int tailSize) { mTailSize = tailSize; }
 
+  /** Skip ProcessBlock() when the inputs are silent and have been for longer than the tail size plus the latency, zeroing the outputs instead and reporting them as silent to hosts that accept it (VST3, AUv2).
+   * The inputs are silent if the host says so (VST3 silence flags), otherwise they are checked for samples above the threshold. A tail size < 0 (e.g. 0xffffffff for VST3's infinite tail) means never skip.
+   * This is off by default, because a plug-in that makes sound without audio input (an instrument, or an effect with a generator) must call WakeFromSilence() whenever it is triggered, e.g. from ProcessMidiMsg(),
+   * which is still called while processing is being skipped. Can be called from any thread, the tail is restarted at the start of the next block
+   * @param enable \c true to skip processing silence
+   * @param threshold Input samples with an absolute value at or below this are considered silent */
+  void SetSilenceSkipping(bool enable, double threshold = 0.)
+  {
+    mSilenceThreshold.store(threshold, std::memory_order_relaxed);
+    mSilenceSkipping.store(enable, std::memory_order_relaxed);
+    mSilenceRestart.store(true, std::memory_order_relaxed);
+  }
+
+  /** Call this in the plug-in's constructor if it implements ProcessBlockHostPrecision(), so that it is called instead of ProcessBlock() when the host's sample type is not the plug-in's.
+   * The host's buffers are then passed straight through, with no conversion, except when bypassed with latency (the latency delay is in \c sample precision) and for VST2's deprecated accumulating process call
+   * @param enable \c true to call ProcessBlockHostPrecision() */
+  void SetProcessHostPrecision(bool enable);
+
+  /** @return \c true if ProcessBlockHostPrecision() is called when the host's sample type is not the plug-in's, see SetProcessHostPrecision() */
+  bool GetProcessHostPrecision() const { return mProcessHostPrecision; }
+
+  /** Time every ProcessBuffers() call with the DSP load meter, see GetDSPLoadMeter(). It is disabled by default, as the two clock reads and the histogram update cost around 100 ns per block,
+   * so enable it when the statistics are shown or used (adaptive quality times the blocks whether it is enabled or not). Can be called from any thread
+   * @param enable \c true to measure the DSP load */
+  void SetDSPLoadMetering(bool enable) { mDSPLoadMetering.store(enable, std::memory_order_relaxed); }
+
+  /** Set the quality tier used when the host is playing in real time. Can be called from any thread, e.g. from OnParamChange() for a quality parameter.
+   * The tier changes at the start of the next block, when OnQualityTierChanged() is called and the listeners are told
+   * @param tier The tier, or the highest tier if adaptive quality is enabled. kQualityNormal by default */
+  void SetRealtimeQualityTier(EQualityTier tier) { mRealtimeQualityTier.store(tier, std::memory_order_relaxed); }
+
+  /** Set the quality tier used when the host is rendering offline, where there's no deadline to meet. Can be called from any thread
+   * @param tier The tier, kQualityOffline by default */
+  void SetOfflineQualityTier(EQualityTier tier) { mOfflineQualityTier.store(tier, std::memory_order_relaxed); }
+
+  /** Let the quality governor lower the real-time tier when processing takes too large a fraction of the block's duration, and raise it again when the load drops.
+   * Each block is timed while this is enabled, even if DSP load metering is disabled. Can be called from any thread. The governor's thresholds and times can be set with GetQualityGovernor() in the plug-in's constructor
+   * @param enable \c true to adapt the real-time tier to the load */
+  void SetAdaptiveQuality(bool enable) { mAdaptiveQuality.store(enable, std::memory_order_relaxed); }
+
+  /** @return \c true if the real-time tier is adapted to the load, see SetAdaptiveQuality() */
+  bool GetAdaptiveQuality() const { return mAdaptiveQuality.load(std::memory_order_relaxed); }
+
+  /** @return The governor that chooses the real-time tier when adaptive quality is enabled. Only configure it when the audio thread isn't running, e.g. in the plug-in's constructor */
+  QualityGovernor& GetQualityGovernor() { return mQualityGovernor; }
+
+  /** Add a DSP component to be told when the quality tier changes. It is told the current tier straight away.
+   * Call this when the audio thread isn't running, e.g. in the plug-in's constructor or OnReset(), and remove the listener before it is destroyed if it doesn't live as long as the plug-in
+   * @param pListener The listener, which the plug-in does not own */
+  void AddQualityTierListener(IQualityTierListener* pListener);
+
+  /** @param pListener A listener added with AddQualityTierListener(), that should no longer be told about changes */
+  void RemoveQualityTierListener(IQualityTierListener* pListener) { mQualityTierListeners.DeletePtr(pListener); }
+
+  /** Restart the tail, so that ProcessBlock() is called for at least the tail size plus the latency from now, even if the inputs stay silent. Call it from the audio thread, e.g. when a note is received */
+  void WakeFromSilence() { mNSilentFrames = 0; }
+
   /** A static method to parse the config.h channel I/O string.
    * @param IOStr Space separated cstring list of I/O configurations for this plug-in in the format ninchans-noutchans.
    * A hypen character \c(-) deliminates input-output. Supports multiple buses, which are indicated using a period \c(.) character.
@@ -261,6 +363,8 @@ protected:
   void ProcessBuffers(PLUG_SAMPLE_DST type, int nFrames);
   void ProcessBuffersAccumulating(int nFrames); // only for VST2 deprecated method single precision
   void ZeroScratchBuffers();
+  /** Called by API classes whose host says which inputs are silent (e.g. VST3 silence flags) before ProcessBuffers(), to save checking the input samples for the next block */
+  void SetInputsSilentFromHost(bool silent) { mInputsSilentFromHost = silent; }
   void SetSampleRate(double sampleRate) { mSampleRate = sampleRate; }
   void SetBlockSize(int blockSize);
   void SetBypassed(bool bypassed) { mBypassed = bypassed; }
@@ -269,6 +373,25 @@ protected:
   const WDL_String& GetChannelLabel(ERoute direction, int idx) { return mChannelData[direction].Get(idx)->mLabel; }
 
 private:
+  /** @return \c true if the connected inputs are silent for this block, from the host's flags or by checking the samples */
+  template <typename T>
+  bool InputsAreSilent(T** ppInData, int nFrames) const;
+  /** Update the silence count for this block
+   * @return \c true if ProcessBlock() should be skipped */
+  bool UpdateSilence(bool inputsSilent, int nFrames);
+  /** Allocate the host precision scratch buffers for unconnected channels, when processing at the host's precision */
+  void ResizeHostScratchBuffers();
+  /** Convert the host's inputs to \c sample, for when they were attached without conversion but need to be processed at \c sample precision */
+  void ConvertHostInputs(int nFrames);
+  /** Convert the outputs back to the host's sample type */
+  void ConvertHostOutputs(int nFrames);
+  /** Choose the quality tier for the next block, and tell the listeners and OnQualityTierChanged() if it has changed */
+  void UpdateQualityTier();
+  /** @return \c true if this block should be timed, for the DSP load meter or the quality governor */
+  bool MeasuringDSPLoad() const;
+  /** Record the load of a block that started processing at start, in the DSP load meter and the quality governor */
+  void EndDSPLoadMeasurement(DSPLoadMeter::Clock::time_point start, int nFrames);
+
   /** See EIPlugPluginTypes */
   EIPlugPluginType mPlugType;
   /** \c true if the plug-in accepts MIDI input */
@@ -289,10 +412,44 @@ private:
   bool mBypassed = false;
   /** \c true if the plug-in is rendering off-line*/
   bool mRenderingOffline = false;
+  /** \c true if ProcessBlock() is skipped for silent input, after the tail */
+  std::atomic<bool> mSilenceSkipping{false};
+  /** Input samples at or below this level are silent */
+  std::atomic<double> mSilenceThreshold{0.};
+  /** Set by SetSilenceSkipping(), so that the audio thread restarts the tail by resetting mNSilentFrames */
+  std::atomic<bool> mSilenceRestart{false};
+  /** \c true if the host said that the inputs for the next block are silent */
+  bool mInputsSilentFromHost = false;
+  /** \c true if the last block was skipped, and its outputs zeroed */
+  bool mOutputsSilent = false;
+  /** The number of frames of silent input processed since the input was last not silent */
+  int64_t mNSilentFrames = 0;
+  /** The number of blocks skipped */
+  std::atomic<int> mNSkippedBlocks{0};
+  /** \c true if ProcessBlockHostPrecision() is called on the host's buffers when the host's sample type is not the plug-in's */
+  bool mProcessHostPrecision = false;
+  /** The quality tier of the current block */
+  EQualityTier mQualityTier = kQualityNormal;
+  /** The quality tier requested for real-time processing */
+  std::atomic<int> mRealtimeQualityTier{kQualityNormal};
+  /** The quality tier requested for offline rendering */
+  std::atomic<int> mOfflineQualityTier{kQualityOffline};
+  /** \c true if the quality governor chooses the real-time tier */
+  std::atomic<bool> mAdaptiveQuality{false};
+  /** Lowers the real-time tier when the load is too high */
+  QualityGovernor mQualityGovernor;
+  /** \c true if every block is timed with the DSP load meter */
+  std::atomic<bool> mDSPLoadMetering{false};
+  /** The load of each block, as a fraction of its real-time budget */
+  DSPLoadMeter mDSPLoadMeter;
+  /** DSP components to tell about quality tier changes, not owned */
+  WDL_PtrList<IQualityTierListener> mQualityTierListeners;
   /** A list of IOConfig structures populated by ParseChannelIOStr in the IPlugProcessor constructor */
   WDL_PtrList<IOConfig> mIOConfigs;
   /* Manages pointers to the actual data for each channel */
   WDL_TypedBuf<sample*> mScratchData[2];
+  /* Manages pointers to the host's data for each channel, when processing at the host's precision */
+  WDL_TypedBuf<PLUG_SAMPLE_SRC*> mHostData[2];
   /* A list of IChannelData structures corresponding to every input/output channel */
   WDL_PtrList<IChannelData<>> mChannelData[2];
 protected: // these members are protected because they need to be access by the API classes, and don't want a setter/getter
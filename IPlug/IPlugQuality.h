@@ -0,0 +1,157 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+#pragma once
+
+/**
+ * @file
+ * @brief Quality tiers, for DSP that can trade CPU for quality, and the governor that lowers the real-time tier when the load is too high
+ *
+ * IPlugProcessor decides the tier for each block, before ProcessBlock(): the offline tier while the host renders offline, otherwise the real-time tier,
+ * or a lower one if adaptive quality is enabled and the QualityGovernor says the deadline is at risk. Components that implement IQualityTierListener
+ * (OverSampler, SVF, QualityResampler) can be registered with IPlugProcessor::AddQualityTierListener(), so they are told about a change on the audio thread,
+ * at a block boundary, between two calls to ProcessBlock().
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#include "IPlugPlatform.h"
+
+BEGIN_IPLUG_NAMESPACE
+
+#define QUALITY_TIERS_VA_LIST "Low", "Normal", "High", "Offline"
+
+/** @enum EQualityTier
+ * How much CPU DSP should spend on quality, from lowest to highest
+ */
+enum EQualityTier
+{
+  kQualityLow = 0,
+  kQualityNormal,
+  kQualityHigh,
+  kQualityOffline, // for offline rendering, no real-time deadline
+  kNumQualityTiers
+};
+
+static const char* QualityTierStrs[kNumQualityTiers] = { QUALITY_TIERS_VA_LIST };
+
+/** An interface for DSP components that change their processing with the quality tier */
+class IQualityTierListener
+{
+public:
+  virtual ~IQualityTierListener() {}
+
+  /** Called on the audio thread, between blocks, when the tier changes. Must not allocate or block
+   * @param tier The tier for the next block */
+  virtual void OnQualityTierChanged(EQualityTier tier) = 0;
+};
+
+/** Chooses the real-time quality tier from the DSP load of each block (the time spent processing it, as a fraction of its duration).
+ * The load is smoothed, and the tier is lowered by one step when the smoothed load is above the upper threshold or a block overruns its deadline,
+ * then raised by one step again, up to the requested tier, once the load has stayed below the lower threshold for a while.
+ * If a raised tier has to be lowered again soon after, the wait before the next raise is doubled, so that the governor doesn't keep switching between two tiers.
+ * It is not thread safe, IPlugProcessor updates it on the audio thread, apart from GetLoad(), which can be called from any thread */
+class QualityGovernor
+{
+public:
+  QualityGovernor() = default;
+
+  /** @param lowerAbove The smoothed load above which the tier is lowered
+   * @param raiseBelow The smoothed load below which the tier can be raised */
+  void SetThresholds(double lowerAbove = 0.8, double raiseBelow = 0.5)
+  {
+    mLowerAbove = lowerAbove;
+    mRaiseBelow = std::min(raiseBelow, lowerAbove);
+  }
+
+  /** @param smoothingSecs The time constant of the load smoothing
+   * @param lowerHoldSecs The minimum time between two steps down, so that the load at the new tier can be measured before lowering it again
+   * @param raiseHoldSecs How long the load must stay below the lower threshold before a step up */
+  void SetTimes(double smoothingSecs = 0.1, double lowerHoldSecs = 0.05, double raiseHoldSecs = 2.)
+  {
+    mSmoothingSecs = std::max(smoothingSecs, 0.001);
+    mLowerHoldSecs = lowerHoldSecs;
+    mRaiseHoldSecs = mBaseRaiseHoldSecs = raiseHoldSecs;
+  }
+
+  /** Start again at a tier, forgetting the load history
+   * @param tier The tier to start at */
+  void Reset(EQualityTier tier = kQualityHigh)
+  {
+    mTier = tier;
+    mLoad.store(0., std::memory_order_relaxed);
+    mSecsSinceChange = 0.;
+    mSecsBelow = 0.;
+    mRaiseHoldSecs = mBaseRaiseHoldSecs;
+    mLastChangeWasRaise = false;
+  }
+
+  /** Update the governor with the load of the last block
+   * @param load The time taken to process the block, as a fraction of the block's duration
+   * @param blockSecs The duration of the block in seconds
+   * @param maxTier The highest tier to use, i.e. the requested real-time tier
+   * @return The tier for the next block */
+  EQualityTier Update(double load, double blockSecs, EQualityTier maxTier)
+  {
+    double smoothedLoad = mLoad.load(std::memory_order_relaxed);
+    smoothedLoad += (load - smoothedLoad) * (1. - std::exp(-blockSecs / mSmoothingSecs));
+    mLoad.store(smoothedLoad, std::memory_order_relaxed);
+    mSecsSinceChange += blockSecs;
+    mSecsBelow = smoothedLoad < mRaiseBelow ? mSecsBelow + blockSecs : 0.;
+
+    if (mTier > maxTier)
+      SetTier(maxTier, false);
+    else if ((smoothedLoad > mLowerAbove || load > 1.) && mTier > kQualityLow && mSecsSinceChange >= mLowerHoldSecs)
+    {
+      // the tier that was just raised to is too expensive, wait longer before trying it again
+      if (mLastChangeWasRaise && mSecsSinceChange < mRaiseHoldSecs)
+        mRaiseHoldSecs = std::min(mRaiseHoldSecs * 2., kMaxRaiseHoldSecs);
+
+      SetTier((EQualityTier) (mTier - 1), false);
+    }
+    else if (mTier < maxTier && mSecsBelow >= mRaiseHoldSecs)
+      SetTier((EQualityTier) (mTier + 1), true);
+
+    return mTier;
+  }
+
+  /** @return The tier chosen by the last Update() */
+  EQualityTier GetTier() const { return mTier; }
+
+  /** @return The smoothed load. Can be called from any thread */
+  double GetLoad() const { return mLoad.load(std::memory_order_relaxed); }
+
+private:
+  static constexpr double kMaxRaiseHoldSecs = 30.;
+
+  void SetTier(EQualityTier tier, bool raise)
+  {
+    mTier = tier;
+    mSecsSinceChange = 0.;
+    mSecsBelow = 0.;
+    mLastChangeWasRaise = raise;
+  }
+
+  EQualityTier mTier = kQualityHigh;
+  std::atomic<double> mLoad{0.}; // written on the audio thread, read by the UI
+  double mLowerAbove = 0.8;
+  double mRaiseBelow = 0.5;
+  double mSmoothingSecs = 0.1;
+  double mLowerHoldSecs = 0.05;
+  double mBaseRaiseHoldSecs = 2.;
+  double mRaiseHoldSecs = 2.;
+  double mSecsSinceChange = 0.;
+  double mSecsBelow = 0.;
+  bool mLastChangeWasRaise = false;
+};
+
+END_IPLUG_NAMESPACE
@@ -472,8 +472,9 @@ struct IChannelData
 {
   bool mConnected = false;
   TOUT** mData = nullptr; // If this is for an input channel, points into IPlugProcessor::mInData, if it's for an output channel points into IPlugProcessor::mOutData
-  TIN* mIncomingData = nullptr;
+  TIN* mIncomingData = nullptr; // The host's buffer, when the host's sample type is not the plug-in's
   WDL_TypedBuf<TOUT> mScratchBuf;
+  WDL_TypedBuf<TIN> mHostScratchBuf; // Stands in for the host's buffer when the channel is not connected, only allocated if the plug-in processes at the host's precision
   WDL_String mLabel;
 };
 
@@ -143,4 +143,270 @@ void Timer_impl::TimerProc(void* userData)
   Timer_impl* itimer = (Timer_impl*) userData;
   itimer->mTimerFunc(*itimer);
 }
+#elif defined OS_LINUX
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+BEGIN_IPLUG_NAMESPACE
+
+/** The process wide epoll set of timerfds that drives all the Timer_impls. It doesn't have a thread of its own, the epoll fd is watched by the
+ * host or app main loop, which calls DispatchTimers() when it is readable, so the callbacks happen on the main thread like on the other platforms */
+class TimerLoop
+{
+public:
+  static TimerLoop& Get()
+  {
+    static TimerLoop sLoop;
+    return sLoop;
+  }
+
+  bool Add(Timer_impl* pTimer)
+  {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
+
+    if (mEpollFD < 0)
+      return false;
+
+    Group* pGroup = nullptr;
+
+    for (auto& group : mGroups)
+    {
+      if (group->mIntervalMs == pTimer->mIntervalMs)
+        pGroup = group.get();
+    }
+
+    if (!pGroup)
+    {
+      const int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+      if (fd < 0)
+        return false;
+
+      mGroups.push_back(std::make_unique<Group>());
+      pGroup = mGroups.back().get();
+      pGroup->mFD = fd;
+      pGroup->mIntervalMs = pTimer->mIntervalMs;
+
+      epoll_event event = {};
+      event.events = EPOLLIN;
+      event.data.ptr = pGroup;
+      epoll_ctl(mEpollFD, EPOLL_CTL_ADD, fd, &event);
+    }
+
+    if (pGroup->mTimers.empty())
+    {
+      // an absolute schedule, so the lateness of every tick can be measured against when it was due
+      const int64_t intervalNs = (int64_t) std::max<uint32_t>(pGroup->mIntervalMs, 1) * 1000000;
+      pGroup->mNextDueNs = NowNs() + intervalNs;
+      pGroup->mLastTickNs = -1;
+
+      itimerspec spec = {};
+      spec.it_value = ToTimespec(pGroup->mNextDueNs);
+      spec.it_interval = ToTimespec(intervalNs);
+      timerfd_settime(pGroup->mFD, TFD_TIMER_ABSTIME, &spec, nullptr);
+    }
+
+    pGroup->mTimers.push_back(pTimer);
+
+    return true;
+  }
+
+  void Remove(Timer_impl* pTimer)
+  {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
+
+    for (auto& group : mGroups)
+    {
+      auto it = std::find(group->mTimers.begin(), group->mTimers.end(), pTimer);
+
+      if (it == group->mTimers.end())
+        continue;
+
+      group->mTimers.erase(it);
+
+      // the group and its timerfd are kept for reuse, but disarmed so the loop sleeps
+      if (group->mTimers.empty())
+      {
+        itimerspec spec = {};
+        timerfd_settime(group->mFD, 0, &spec, nullptr);
+      }
+
+      return;
+    }
+  }
+
+  std::recursive_mutex& GetMutex() { return mMutex; }
+
+  int GetFD() const { return mEpollFD; }
+
+  /** Reads the timerfds that have expired without blocking, and calls back their timers */
+  void DispatchTimers()
+  {
+    epoll_event events[16];
+    int nEvents = 0;
+
+    do
+    {
+      nEvents = mEpollFD < 0 ? 0 : epoll_wait(mEpollFD, events, 16, 0);
+
+      for (auto e = 0; e < nEvents; e++)
+        Dispatch(static_cast<Group*>(events[e].data.ptr));
+    }
+    while (nEvents == 16);
+  }
+
+private:
+  struct Group
+  {
+    int mFD = -1;
+    uint32_t mIntervalMs = 0;
+    int64_t mNextDueNs = 0;
+    int64_t mLastTickNs = -1;
+    std::vector<Timer_impl*> mTimers;
+  };
+
+  TimerLoop()
+  {
+    mEpollFD = epoll_create1(EPOLL_CLOEXEC);
+  }
+
+  ~TimerLoop()
+  {
+    for (auto& group : mGroups)
+      close(group->mFD);
+
+    if (mEpollFD >= 0)
+      close(mEpollFD);
+  }
+
+  static int64_t NowNs()
+  {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((int64_t) ts.tv_sec * 1000000000) + ts.tv_nsec;
+  }
+
+  static timespec ToTimespec(int64_t ns)
+  {
+    timespec ts;
+    ts.tv_sec = (time_t) (ns / 1000000000);
+    ts.tv_nsec = (long) (ns % 1000000000);
+    return ts;
+  }
+
+  void Dispatch(Group* pGroup)
+  {
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
+
+    uint64_t nExpirations = 0;
+
+    if (read(pGroup->mFD, &nExpirations, sizeof(nExpirations)) != sizeof(nExpirations) || !nExpirations || pGroup->mTimers.empty())
+      return;
+
+    const int64_t now = NowNs();
+    const int64_t intervalNs = (int64_t) std::max<uint32_t>(pGroup->mIntervalMs, 1) * 1000000;
+    const int64_t dueNs = pGroup->mNextDueNs + ((int64_t) (nExpirations - 1) * intervalNs);
+    const double intervalMs = pGroup->mLastTickNs < 0 ? -1. : (now - pGroup->mLastTickNs) / 1e6;
+    const double latenessMs = std::max<int64_t>(now - dueNs, 0) / 1e6;
+
+    pGroup->mNextDueNs = dueNs + intervalNs;
+    pGroup->mLastTickNs = now;
+
+    // a callback can stop timers (including itself), so work on a copy and skip any that have gone
+    mDispatching = pGroup->mTimers;
+
+    for (auto* pTimer : mDispatching)
+    {
+      if (std::find(pGroup->mTimers.begin(), pGroup->mTimers.end(), pTimer) != pGroup->mTimers.end())
+        pTimer->Tick(intervalMs, latenessMs, nExpirations - 1);
+    }
+  }
+
+  std::recursive_mutex mMutex;
+  std::vector<std::unique_ptr<Group>> mGroups;
+  std::vector<Timer_impl*> mDispatching;
+  int mEpollFD = -1;
+};
+
+END_IPLUG_NAMESPACE
+
+Timer* Timer::Create(ITimerFunction func, uint32_t intervalMs)
+{
+  return new Timer_impl(func, intervalMs);
+}
+
+Timer_impl::Timer_impl(ITimerFunction func, uint32_t intervalMs)
+: mTimerFunc(func)
+, mIntervalMs(intervalMs)
+{
+  mRunning = TimerLoop::Get().Add(this);
+}
+
+Timer_impl::~Timer_impl()
+{
+  Stop();
+}
+
+int Timer_impl::GetRunLoopFD()
+{
+  return TimerLoop::Get().GetFD();
+}
+
+void Timer_impl::DispatchTimers()
+{
+  TimerLoop::Get().DispatchTimers();
+}
+
+void Timer_impl::Stop()
+{
+  if (mRunning)
+  {
+    TimerLoop::Get().Remove(this);
+    mRunning = false;
+  }
+}
+
+bool Timer_impl::GetStats(TimerStats& stats) const
+{
+  std::lock_guard<std::recursive_mutex> lock(TimerLoop::Get().GetMutex());
+  stats = mStats;
+  stats.mJitterMs = mStats.mNTicks > 2 ? std::sqrt(mIntervalM2 / (double) (mStats.mNTicks - 2)) : 0.;
+  return true;
+}
+
+void Timer_impl::ResetStats()
+{
+  std::lock_guard<std::recursive_mutex> lock(TimerLoop::Get().GetMutex());
+  mStats = TimerStats();
+  mIntervalM2 = 0.;
+}
+
+void Timer_impl::Tick(double intervalMs, double latenessMs, uint64_t nMissed)
+{
+  mStats.mNTicks++;
+  mStats.mNMissed += nMissed;
+  mStats.mMaxLatenessMs = std::max(mStats.mMaxLatenessMs, latenessMs);
+
+  // the first tick after a reset has no interval to measure, so the interval stats cover mNTicks - 1 values
+  if (intervalMs >= 0. && mStats.mNTicks > 1)
+  {
+    const double n = (double) (mStats.mNTicks - 1);
+    const double delta = intervalMs - mStats.mMeanIntervalMs;
+    mStats.mMeanIntervalMs += delta / n;
+    mIntervalM2 += delta * (intervalMs - mStats.mMeanIntervalMs);
+    mStats.mMinIntervalMs = n > 1. ? std::min(mStats.mMinIntervalMs, intervalMs) : intervalMs;
+    mStats.mMaxIntervalMs = std::max(mStats.mMaxIntervalMs, intervalMs);
+  }
+
+  mTimerFunc(*this);
+}
 #endif
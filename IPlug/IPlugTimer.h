@@ -35,6 +35,18 @@
 
 BEGIN_IPLUG_NAMESPACE
 
+/** Measurements of how regularly a timer has been called back, since it was created or since Timer::ResetStats() */
+struct TimerStats
+{
+  uint64_t mNTicks = 0; // the number of callbacks
+  uint64_t mNMissed = 0; // the number of intervals that were skipped because a callback was more than an interval late
+  double mMeanIntervalMs = 0.; // the mean time between callbacks
+  double mMinIntervalMs = 0.;
+  double mMaxIntervalMs = 0.;
+  double mJitterMs = 0.; // the standard deviation of the time between callbacks
+  double mMaxLatenessMs = 0.; // the longest time between when a callback was due and when it happened
+};
+
 /** Base class for timer */
 struct Timer
 {
@@ -47,6 +59,14 @@ struct Timer
   static Timer* Create(ITimerFunction func, uint32_t intervalMs);
   virtual ~Timer() {};
   virtual void Stop() = 0;
+
+  /** Get the timer's jitter statistics, if the platform implementation measures them (currently only Linux)
+   * @param stats Filled with the statistics
+   * @return \c true if stats was filled */
+  virtual bool GetStats(TimerStats&) const { return false; }
+
+  /** Start measuring the statistics from scratch */
+  virtual void ResetStats() {}
 };
 
 #if defined OS_MAC || defined OS_IOS
@@ -95,7 +115,42 @@ private:
   long ID = 0;
   ITimerFunction mTimerFunc;
 };
-#elif
+#elif defined OS_LINUX
+class TimerLoop;
+
+/** Timers run on a timerfd each, gathered in a shared epoll set. Timers with the same interval share one timerfd, so they tick together and cost one wake-up.
+ * There is no timer thread: the host or app main loop watches GetRunLoopFD() and calls DispatchTimers() when it is readable, so the callbacks happen on the main thread */
+class Timer_impl : public Timer
+{
+public:
+  Timer_impl(ITimerFunction func, uint32_t intervalMs);
+  ~Timer_impl();
+  void Stop() override;
+
+  /** @return A file descriptor that becomes readable when a timer is due, for the main loop to watch, e.g. with Steinberg::Linux::IRunLoop::registerEventHandler() or poll() */
+  static int GetRunLoopFD();
+
+  /** Calls back the timers that are due, without blocking. This must be called on the main thread, when GetRunLoopFD() is readable */
+  static void DispatchTimers();
+  bool GetStats(TimerStats& stats) const override;
+  void ResetStats() override;
+
+private:
+  /** Called by DispatchTimers() for every tick of the timer's timerfd, with the loop's lock held
+   * @param intervalMs The time since the last tick, or < 0 for the first tick
+   * @param latenessMs The time since the tick was due
+   * @param nMissed The number of ticks that were skipped */
+  void Tick(double intervalMs, double latenessMs, uint64_t nMissed);
+
+  ITimerFunction mTimerFunc;
+  uint32_t mIntervalMs;
+  bool mRunning = false;
+  TimerStats mStats;
+  double mIntervalM2 = 0.; // running sum of squared differences from the mean (Welford), for the jitter
+
+  friend class TimerLoop;
+};
+#else
   #error NOT IMPLEMENTED
 #endif
 
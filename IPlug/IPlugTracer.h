@@ -0,0 +1,335 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+#pragma once
+
+/**
+ * @file
+ * @brief A low overhead binary event tracer that writes the Chrome trace event format, for profiling timing problems
+ *
+ * Unlike Trace(), which formats and writes a line of text under a lock, the macros below only write a fixed-size record into a ring buffer that belongs to the
+ * calling thread, so they can be used on the audio thread and in draw/idle code without changing the timing that is being measured.
+ * A background thread drains the rings and writes the events to $HOME/IPlugTrace.json (see TRACEFILE), which can be opened in chrome://tracing or https://ui.perfetto.dev
+ *
+ * To time a block of code:                      TRACE_SCOPE("MyName");
+ * To time a function:                          TRACE_PROCESS_SCOPE; TRACE_DRAW_SCOPE; or TRACE_IDLE_SCOPE; (named after the function, in a category that can be filtered)
+ * To mark a point in time:                      TRACE_INSTANT("MyName");
+ * To plot a value:                              TRACE_COUNTER("MyName", value);
+ * To name the calling thread in the trace:      TRACE_THREAD_NAME("Audio");
+ *
+ * Names and categories must be string literals (or other strings that outlive the tracer), because only the pointers are stored.
+ * Like Trace(), the macros are no-ops unless TRACER_BUILD is defined.
+ */
+
+#if defined TRACER_BUILD
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "IPlugPlatform.h"
+
+#ifndef TRACEFILE
+  #define TRACEFILE "IPlugTrace.json"
+#endif
+
+#ifndef TRACE_RING_SIZE
+  #define TRACE_RING_SIZE 16384 // events per thread, must be a power of two
+#endif
+
+BEGIN_IPLUG_NAMESPACE
+
+/** One trace event, as written by the thread that produced it */
+struct TraceRecord
+{
+  int64_t mTime; // nanoseconds since the tracer started
+  int64_t mDuration; // nanoseconds, for complete ('X') events
+  const char* mName;
+  const char* mCategory;
+  double mValue; // for counter ('C') events
+  char mPhase; // the Chrome trace event phase: 'X', 'i', 'C' or 'M' (thread name)
+};
+
+/** A single producer, single consumer ring of TraceRecords, owned by one thread. When it is full, events are dropped and counted rather than blocking the producer */
+class TraceRing
+{
+public:
+  TraceRing(int threadOrdinal)
+  : mThreadOrdinal(threadOrdinal)
+  {
+    static_assert((TRACE_RING_SIZE & (TRACE_RING_SIZE - 1)) == 0, "TRACE_RING_SIZE must be a power of two");
+  }
+
+  /** Producer (owning thread) only */
+  inline void Push(const TraceRecord& record)
+  {
+    const uint32_t write = mWrite.load(std::memory_order_relaxed);
+
+    if (write - mRead.load(std::memory_order_acquire) >= TRACE_RING_SIZE)
+    {
+      mNDropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    mRecords[write & (TRACE_RING_SIZE - 1)] = record;
+    mWrite.store(write + 1, std::memory_order_release);
+  }
+
+  /** Consumer (writer thread) only
+   * @return The number of records popped */
+  template<typename F>
+  int Drain(F&& func)
+  {
+    const uint32_t read = mRead.load(std::memory_order_relaxed);
+    const uint32_t write = mWrite.load(std::memory_order_acquire);
+
+    for (uint32_t i = read; i != write; i++)
+      func(mRecords[i & (TRACE_RING_SIZE - 1)]);
+
+    mRead.store(write, std::memory_order_release);
+    return (int) (write - read);
+  }
+
+  int GetThreadOrdinal() const { return mThreadOrdinal; }
+  uint32_t GetNDropped() const { return mNDropped.load(std::memory_order_relaxed); }
+
+private:
+  TraceRecord mRecords[TRACE_RING_SIZE];
+  std::atomic<uint32_t> mWrite{0};
+  std::atomic<uint32_t> mNDropped{0};
+  char mPad[64]; // keeps the consumer's index off the producer's cache line
+  std::atomic<uint32_t> mRead{0};
+  const int mThreadOrdinal;
+};
+
+/** The process wide tracer. Created on first use, which also opens the trace file and starts the writer thread.
+ * Each thread gets a TraceRing the first time it records an event (this allocates, so call TRACE_THREAD_NAME() early, e.g. in OnReset(), to keep it off the first audio block).
+ * Rings are never freed until the tracer is destroyed, so events from threads that have exited are still written */
+class Tracer
+{
+public:
+  static Tracer& Get()
+  {
+    static Tracer sTracer;
+    return sTracer;
+  }
+
+  Tracer(const Tracer&) = delete;
+  Tracer& operator=(const Tracer&) = delete;
+
+  /** @return The time in nanoseconds since the tracer started */
+  inline int64_t Now() const
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - mStartTime).count();
+  }
+
+  inline void Record(char phase, const char* name, const char* category, int64_t time, int64_t duration = 0, double value = 0.)
+  {
+    GetThreadRing().Push({time, duration, name, category, value, phase});
+  }
+
+  /** @return The total number of events that were dropped because a thread's ring was full */
+  uint32_t GetNDropped()
+  {
+    std::lock_guard<std::mutex> lock(mRingsMutex);
+    uint32_t nDropped = 0;
+
+    for (auto& ring : mRings)
+      nDropped += ring->GetNDropped();
+
+    return nDropped;
+  }
+
+  /** Write all the pending events now, from the calling thread. The writer thread calls this periodically
+   * @return The number of events written */
+  int Flush()
+  {
+    std::lock_guard<std::mutex> fileLock(mFileMutex);
+
+    if (!mFP)
+      return 0;
+
+    // the rings mutex is only held to copy the list of rings, so a thread recording its first event never waits for the file to be written.
+    // rings are never freed and only this (serialized) function drains them, so they can be drained after the lock is released
+    {
+      std::lock_guard<std::mutex> ringsLock(mRingsMutex);
+      mRingsToFlush.clear();
+
+      for (auto& ring : mRings)
+        mRingsToFlush.push_back(ring.get());
+    }
+
+    int nEvents = 0;
+
+    for (auto* ring : mRingsToFlush)
+    {
+      const int tid = ring->GetThreadOrdinal();
+      nEvents += ring->Drain([this, tid](const TraceRecord& r) { WriteEvent(r, tid); });
+    }
+
+    if (nEvents)
+      fflush(mFP);
+
+    return nEvents;
+  }
+
+private:
+  Tracer()
+  : mStartTime(std::chrono::steady_clock::now())
+  {
+    char path[1024];
+#ifdef OS_WIN
+    snprintf(path, sizeof(path), "%s\\%s", getenv("USERPROFILE") ? getenv("USERPROFILE") : "C:", TRACEFILE);
+#else
+    snprintf(path, sizeof(path), "%s/%s", getenv("HOME") ? getenv("HOME") : ".", TRACEFILE);
+#endif
+    mFP = fopen(path, "w");
+
+    if (mFP)
+    {
+      // the JSON array format doesn't require the closing bracket, so the file is still valid if the process doesn't exit cleanly
+      fputs("[\n", mFP);
+      mRunning = true;
+      mThread = std::thread(&Tracer::ThreadProc, this);
+    }
+  }
+
+  ~Tracer()
+  {
+    if (mRunning)
+    {
+      mRunning = false;
+      mThread.join();
+    }
+
+    Flush();
+
+    if (mFP)
+    {
+      fputs("{}]\n", mFP);
+      fclose(mFP);
+      mFP = nullptr;
+    }
+  }
+
+  TraceRing& GetThreadRing()
+  {
+    static thread_local TraceRing* tRing = nullptr;
+
+    if (!tRing)
+    {
+      std::lock_guard<std::mutex> lock(mRingsMutex);
+      mRings.push_back(std::make_unique<TraceRing>((int) mRings.size()));
+      tRing = mRings.back().get();
+    }
+
+    return *tRing;
+  }
+
+  void WriteEvent(const TraceRecord& r, int tid)
+  {
+    const double ts = r.mTime / 1000.; // microseconds
+
+    switch (r.mPhase)
+    {
+      case 'X':
+        fprintf(mFP, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d},\n", r.mName, r.mCategory, ts, r.mDuration / 1000., tid);
+        break;
+      case 'i':
+        fprintf(mFP, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":1,\"tid\":%d},\n", r.mName, r.mCategory, ts, tid);
+        break;
+      case 'C':
+        fprintf(mFP, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"tid\":%d,\"args\":{\"value\":%.17g}},\n", r.mName, r.mCategory, ts, tid, r.mValue);
+        break;
+      case 'M':
+        fprintf(mFP, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}},\n", tid, r.mName);
+        break;
+      default:
+        break;
+    }
+  }
+
+  void ThreadProc()
+  {
+    while (mRunning)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      Flush();
+    }
+  }
+
+  const std::chrono::steady_clock::time_point mStartTime;
+  std::vector<std::unique_ptr<TraceRing>> mRings;
+  std::mutex mRingsMutex; // only taken when a thread first records an event, and briefly by the writer
+  std::mutex mFileMutex; // serializes Flush()
+  std::vector<TraceRing*> mRingsToFlush; // guarded by mFileMutex
+  FILE* mFP = nullptr;
+  std::thread mThread;
+  std::atomic<bool> mRunning{false};
+};
+
+/** Records a complete ('X') event covering its lifetime */
+class TraceScope
+{
+public:
+  TraceScope(const char* name, const char* category)
+  : mName(name)
+  , mCategory(category)
+  , mStart(Tracer::Get().Now())
+  {
+  }
+
+  ~TraceScope()
+  {
+    Tracer& tracer = Tracer::Get();
+    tracer.Record('X', mName, mCategory, mStart, tracer.Now() - mStart);
+  }
+
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+  const char* mName;
+  const char* mCategory;
+  const int64_t mStart;
+};
+
+END_IPLUG_NAMESPACE
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+
+#define TRACE_SCOPE_CAT(name, category) iplug::TraceScope TRACE_CONCAT(traceScope, __LINE__)(name, category)
+#define TRACE_SCOPE(name) TRACE_SCOPE_CAT(name, "user")
+#define TRACE_PROCESS_SCOPE TRACE_SCOPE_CAT(__FUNCTION__, "process")
+#define TRACE_DRAW_SCOPE TRACE_SCOPE_CAT(__FUNCTION__, "draw")
+#define TRACE_IDLE_SCOPE TRACE_SCOPE_CAT(__FUNCTION__, "idle")
+#define TRACE_INSTANT(name) do { iplug::Tracer& t = iplug::Tracer::Get(); t.Record('i', name, "user", t.Now()); } while(0)
+#define TRACE_COUNTER(name, value) do { iplug::Tracer& t = iplug::Tracer::Get(); t.Record('C', name, "counter", t.Now(), 0, (double) (value)); } while(0)
+#define TRACE_THREAD_NAME(name) do { iplug::Tracer& t = iplug::Tracer::Get(); t.Record('M', name, "", t.Now()); } while(0)
+
+#else // TRACER_BUILD
+
+#define TRACE_SCOPE_CAT(name, category)
+#define TRACE_SCOPE(name)
+#define TRACE_PROCESS_SCOPE
+#define TRACE_DRAW_SCOPE
+#define TRACE_IDLE_SCOPE
+#define TRACE_INSTANT(name) do {} while(0)
+#define TRACE_COUNTER(name, value) do {} while(0)
+#define TRACE_THREAD_NAME(name) do {} while(0)
+
+#endif // !TRACER_BUILD
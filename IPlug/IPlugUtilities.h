@@ -23,6 +23,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <limits>
 #include <cctype>
 
 #include "wdlstring.h"
@@ -137,12 +138,12 @@ static inline void GetVersionStr(int version, WDL_String& str)
   str.SetFormatted(MAX_VERSION_STR_LEN, "v%d.%d.%d", ver, rmaj, rmin);
 }
 
-/** /todo  
- * @tparam SRC 
- * @tparam DEST 
- * @param pDest /todo
- * @param pSrc /todo
- * @param n /todo */
+/** Copy an array of values, converting them to another type, e.g. for converting between the host's and the plug-in's sample types
+ * @tparam SRC The type to convert from
+ * @tparam DEST The type to convert to
+ * @param pDest The destination array, which must not overlap pSrc
+ * @param pSrc The source array
+ * @param n The number of values to copy */
 template <class SRC, class DEST>
 void CastCopy(DEST* pDest, SRC* pSrc, int n)
 {
@@ -152,6 +153,84 @@ void CastCopy(DEST* pDest, SRC* pSrc, int n)
   }
 }
 
+/** A fast, non-allocating alternative to snprintf(pBuf, bufLen, "%.*f", precision, value), used for parameter displays.
+ * Unlike printf, values half way between two representations are rounded away from zero (as round() does, so 2.5 is "3" and 0.05 is "0.1" at a precision of 1),
+ * judged on the decimal value rather than its nearest binary approximation, and negative values that round to zero are formatted without the "-".
+ * Falls back to snprintf for non-finite values and values too large to have any digits to round. Digits after the 19th decimal place are always 0
+ * @param pBuf The buffer to write to, which will be null terminated
+ * @param bufLen The size of pBuf in bytes
+ * @param value The value to format
+ * @param precision The number of digits after the decimal point, up to 40
+ * @param forceSign If \c true positive values are prefixed with "+", like "%+.*f"
+ * @return The number of characters written, excluding the null terminator */
+static inline int FormatFixed(char* pBuf, int bufLen, double value, int precision, bool forceSign = false)
+{
+  static const double pow10[] = { 1., 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19 };
+  static constexpr int kMaxPrecision = 19; // so that the scaled value fits a uint64_t
+
+  if (bufLen <= 0)
+    return 0;
+
+  precision = std::min(std::max(precision, 0), 40);
+
+  const double absValue = std::fabs(value);
+  const int roundedPrecision = std::min(precision, kMaxPrecision);
+  const double scaledValue = absValue * pow10[roundedPrecision];
+
+  // from 2^52 up every double is an integer, so there is nothing to round
+  if (!std::isfinite(value) || scaledValue >= 4503599627370496.)
+  {
+    const int len = std::min(snprintf(pBuf, bufLen, forceSign ? "%+.*f" : "%.*f", precision, value), bufLen - 1);
+
+    if (len > 0 && pBuf[0] == '-' && strspn(pBuf + 1, "0.") == static_cast<size_t>(len - 1))
+    {
+      memmove(pBuf, pBuf + 1, len);
+      return len - 1;
+    }
+
+    return len;
+  }
+
+  // a decimal tie like 1.005 is stored as 1.00499999..., so anything within rounding error of half way is rounded up
+  const double floorValue = std::floor(scaledValue);
+  const bool roundUp = scaledValue - floorValue >= 0.5 - scaledValue * 4. * std::numeric_limits<double>::epsilon();
+  const uint64_t scaled = static_cast<uint64_t>(floorValue) + (roundUp ? 1 : 0);
+  uint64_t intPart = scaled / static_cast<uint64_t>(pow10[roundedPrecision]);
+  uint64_t fracPart = scaled % static_cast<uint64_t>(pow10[roundedPrecision]);
+
+  char tmp[64];
+  int pos = sizeof(tmp);
+
+  for (auto i = roundedPrecision; i < precision; i++)
+    tmp[--pos] = '0';
+
+  for (auto i = 0; i < roundedPrecision; i++)
+  {
+    tmp[--pos] = '0' + static_cast<char>(fracPart % 10);
+    fracPart /= 10;
+  }
+
+  if (precision > 0)
+    tmp[--pos] = '.';
+
+  do
+  {
+    tmp[--pos] = '0' + static_cast<char>(intPart % 10);
+    intPart /= 10;
+  } while (intPart);
+
+  if (value < 0. && scaled) // values that round to zero are never displayed as "-0"
+    tmp[--pos] = '-';
+  else if (forceSign)
+    tmp[--pos] = '+';
+
+  const int len = std::min(static_cast<int>(sizeof(tmp)) - pos, bufLen - 1);
+  memcpy(pBuf, tmp + pos, len);
+  pBuf[len] = '\0';
+
+  return len;
+}
+
 /** /todo  
  * @param cDest /todo
  * @param cSrc /todo */
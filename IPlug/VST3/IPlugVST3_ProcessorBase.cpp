@@ -347,6 +347,11 @@ void IPlugVST3ProcessorBase::ProcessParameterChanges(ProcessData& data, IPlugQue
   }
 }
 
+static uint64 AllChannelsMask(int32 nChans)
+{
+  return nChans >= 64 ? ~uint64(0) : (uint64(1) << nChans) - 1;
+}
+
 void IPlugVST3ProcessorBase::ProcessAudio(ProcessData& data, ProcessSetup& setup, const BusList& ins, const BusList& outs)
 {
   int32 sampleSize = setup.symbolicSampleSize;
@@ -407,6 +412,20 @@ void IPlugVST3ProcessorBase::ProcessAudio(ProcessData& data, ProcessSetup& setup
     }
     else
     {
+      if (GetSilenceSkipping())
+      {
+        // the host's silence flags save checking the input samples
+        bool inputsSilent = true;
+
+        for (int inBus = 0; inBus < data.numInputs && (inBus == 0 || mSidechainActive); inBus++)
+        {
+          const uint64 allChans = AllChannelsMask(data.inputs[inBus].numChannels);
+          inputsSilent &= (data.inputs[inBus].silenceFlags & allChans) == allChans;
+        }
+
+        SetInputsSilentFromHost(data.numInputs && inputsSilent);
+      }
+
 #ifdef PARAMS_MUTEX
       mPlug.mParams_mutex.Enter();
 #endif
@@ -417,6 +436,12 @@ void IPlugVST3ProcessorBase::ProcessAudio(ProcessData& data, ProcessSetup& setup
 #ifdef PARAMS_MUTEX
       mPlug.mParams_mutex.Leave();
 #endif
+
+      if (GetSilenceSkipping())
+      {
+        for (int outBus = 0; outBus < data.numOutputs; outBus++)
+          data.outputs[outBus].silenceFlags = GetOutputsSilent() ? AllChannelsMask(data.outputs[outBus].numChannels) : 0;
+      }
     }
   }
 }
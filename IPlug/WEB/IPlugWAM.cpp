@@ -73,12 +73,9 @@ void IPlugWAM::onProcess(WAM::AudioBus* pAudio, void* pData)
 
 void IPlugWAM::OnEditorIdleTick()
 {
-  while(mParamChangeFromProcessor.ElementsAvailable())
-  {
-    ParamTuple p;
-    mParamChangeFromProcessor.Pop(p);
-    SendParameterValueFromDelegate(p.idx, p.value, false);
-  }
+  mParamChangeFromProcessor.Drain([this](int paramIdx, double value) {
+    SendParameterValueFromDelegate(paramIdx, value, false);
+  });
 
   while (mMidiMsgsFromProcessor.ElementsAvailable())
   {
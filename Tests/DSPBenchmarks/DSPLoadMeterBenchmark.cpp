@@ -0,0 +1,83 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+// The cost per block of the DSPLoadMeter that IPlugProcessor uses to time every ProcessBuffers() call when SetDSPLoadMetering() is enabled: reading the clock before the block,
+// then reading it again and updating the histogram and statistics after it. Also prints the statistics the meter gathered, for a block that
+// does a variable amount of work. See README.md for build instructions
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "IPlugPlatform.h"
+#include "IPlugDSPLoadMeter.h"
+
+using namespace iplug;
+
+static constexpr int kBlockSize = 64;
+static constexpr double kSampleRate = 48000.;
+static constexpr int kNBlocks = 5000000;
+
+int main()
+{
+  std::vector<float> buffer(kBlockSize, 0.5f);
+  DSPLoadMeter meter;
+
+  printf("DSPLoadMeterBenchmark: %i blocks\n", kNBlocks);
+
+  // the clock reads alone, which are most of the cost
+  auto start = std::chrono::steady_clock::now();
+  int64_t sum = 0;
+
+  for (auto b = 0; b < kNBlocks; b++)
+  {
+    const auto blockStart = DSPLoadMeter::Clock::now();
+    sum += (DSPLoadMeter::Clock::now() - blockStart).count();
+  }
+
+  const double clockNs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e9 / kNBlocks;
+  printf("%-28s %8.1f ns/block\n", "two clock reads", clockNs);
+
+  start = std::chrono::steady_clock::now();
+
+  for (auto b = 0; b < kNBlocks; b++)
+  {
+    const auto blockStart = DSPLoadMeter::Clock::now();
+    meter.AddBlock(blockStart, kBlockSize, kSampleRate);
+  }
+
+  const double meterNs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e9 / kNBlocks;
+  printf("%-28s %8.1f ns/block\n", "clock reads + AddBlock()", meterNs);
+
+  // a block that does 1 to 64 passes over the buffer, to give the histogram a spread
+  uint32_t rand = 1;
+  meter.Reset();
+
+  for (auto b = 0; b < kNBlocks / 50; b++)
+  {
+    rand = rand * 1664525 + 1013904223;
+    const int nPasses = 1 + ((rand >> 8) & 63);
+    const auto blockStart = DSPLoadMeter::Clock::now();
+
+    for (auto p = 0; p < nPasses; p++)
+    {
+      for (auto s = 0; s < kBlockSize; s++)
+        buffer[s] = buffer[s] * 0.999f + 0.0005f;
+    }
+
+    meter.AddBlock(blockStart, kBlockSize, kSampleRate);
+  }
+
+  const DSPLoadStats stats = meter.GetStats();
+  printf("%lld blocks: mean %.3f%%, p99 %.0f%%, max %.2f%%, %lld overruns\n", (long long) stats.mNBlocks, stats.mMean * 100., stats.mP99 * 100., stats.mMax * 100., (long long) stats.mNOverruns);
+  printf("(checksum %g %lld)\n", buffer[kBlockSize - 1], (long long) (sum & 1));
+
+  return 0;
+}
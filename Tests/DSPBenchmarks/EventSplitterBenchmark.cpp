@@ -0,0 +1,191 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+// Sample accurate MIDI handling by checking an IMidiQueue every sample (as IPlugDrumSynth used to), compared with EventSplitter, which calls the DSP
+// with the spans of samples between events, with and without a minimum sub-block size, and with splitting into fixed chunks (as MidiSynth does).
+// The DSP is a saturator with a gain per channel on 8 channels, set from the velocity of note ons, for different numbers of notes per block.
+// See README.md for build instructions
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "IPlugPlatform.h"
+#include "IPlugMidi.h"
+#include "EventSplitter.h"
+
+using namespace iplug;
+
+static constexpr int kNChannels = 8;
+static constexpr int kBlockSize = 512;
+static constexpr int kNBlocks = 20000;
+static constexpr int kChunkSize = 16;
+
+// a rational approximation of tanh, to give the DSP some arithmetic
+static inline float Saturate(float x)
+{
+  const float x2 = x * x;
+  return x * (27.f + x2) / (27.f + 9.f * x2);
+}
+
+struct SaturatorDSP
+{
+  float mGain[kNChannels] = {};
+
+  void OnMidi(const IMidiMsg& msg)
+  {
+    if (msg.StatusMsg() == IMidiMsg::kNoteOn)
+      mGain[msg.NoteNumber() % kNChannels] = msg.Velocity() / 127.f;
+  }
+
+  void Process(float** inputs, float** outputs, int nFrames)
+  {
+    for (auto c = 0; c < kNChannels; c++)
+    {
+      const float gain = mGain[c];
+
+      for (auto s = 0; s < nFrames; s++)
+        outputs[c][s] = Saturate(inputs[c][s] * gain);
+    }
+  }
+};
+
+static void AddNotes(int nNotes, uint32_t& rand, std::vector<IMidiMsg>& msgs)
+{
+  msgs.clear();
+
+  for (auto n = 0; n < nNotes; n++)
+  {
+    rand = rand * 1664525 + 1013904223;
+    IMidiMsg msg;
+    msg.MakeNoteOnMsg((rand >> 8) & 127, 1 + ((rand >> 16) & 126), (rand >> 20) % kBlockSize);
+    msgs.push_back(msg);
+  }
+}
+
+template <typename F>
+static double Time(const char* name, int nNotes, F&& processBlock, double baseline)
+{
+  uint32_t rand = 1;
+  std::vector<IMidiMsg> msgs;
+  const auto start = std::chrono::steady_clock::now();
+
+  for (auto b = 0; b < kNBlocks; b++)
+  {
+    AddNotes(nNotes, rand, msgs);
+    processBlock(msgs);
+  }
+
+  const double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  const double ns = (time * 1e9) / ((double) kNBlocks * kBlockSize * kNChannels);
+
+  if (baseline > 0.)
+    printf("  %-34s %8.3f ns/sample/channel %8.2fx\n", name, ns, baseline / ns);
+  else
+    printf("  %-34s %8.3f ns/sample/channel\n", name, ns);
+
+  return ns;
+}
+
+int main()
+{
+  std::vector<std::vector<float>> in(kNChannels, std::vector<float>(kBlockSize, 0.25f)), out(kNChannels, std::vector<float>(kBlockSize));
+  std::vector<float*> inPtrs, outPtrs;
+
+  for (auto c = 0; c < kNChannels; c++)
+  {
+    inPtrs.push_back(in[c].data());
+    outPtrs.push_back(out[c].data());
+  }
+
+  printf("EventSplitterBenchmark: %i channels, %i frame blocks, speed up relative to checking every sample\n", kNChannels, kBlockSize);
+
+  for (auto nNotes : { 0, 4, 32, 128 })
+  {
+    printf("%i notes per block\n", nNotes);
+
+    SaturatorDSP dsp;
+    IMidiQueue queue(kBlockSize);
+    EventSplitter<float> splitter(kBlockSize, kNChannels, kNChannels);
+
+    const double perSample = Time("per sample IMidiQueue::Peek()", nNotes, [&](const std::vector<IMidiMsg>& msgs) {
+      for (auto& msg : msgs)
+        queue.Add(msg);
+
+      for (auto s = 0; s < kBlockSize; s++)
+      {
+        while (!queue.Empty() && queue.Peek().mOffset <= s)
+        {
+          dsp.OnMidi(queue.Peek());
+          queue.Remove();
+        }
+
+        for (auto c = 0; c < kNChannels; c++)
+          outPtrs[c][s] = Saturate(inPtrs[c][s] * dsp.mGain[c]);
+      }
+
+      queue.Flush(kBlockSize);
+    }, 0.);
+
+    Time("fixed 16 frame chunks", nNotes, [&](const std::vector<IMidiMsg>& msgs) {
+      for (auto& msg : msgs)
+        queue.Add(msg);
+
+      float* chunkIn[kNChannels];
+      float* chunkOut[kNChannels];
+
+      for (auto s = 0; s < kBlockSize; s += kChunkSize)
+      {
+        while (!queue.Empty() && queue.Peek().mOffset < s + kChunkSize)
+        {
+          dsp.OnMidi(queue.Peek());
+          queue.Remove();
+        }
+
+        for (auto c = 0; c < kNChannels; c++)
+        {
+          chunkIn[c] = inPtrs[c] + s;
+          chunkOut[c] = outPtrs[c] + s;
+        }
+
+        dsp.Process(chunkIn, chunkOut, kChunkSize);
+      }
+
+      queue.Flush(kBlockSize);
+    }, perSample);
+
+    for (auto minSubBlockSize : { 1, 16 })
+    {
+      splitter.SetMinSubBlockSize(minSubBlockSize);
+
+      char name[64];
+      snprintf(name, sizeof(name), "EventSplitter, min sub-block %i", minSubBlockSize);
+
+      Time(name, nNotes, [&](const std::vector<IMidiMsg>& msgs) {
+        for (auto& msg : msgs)
+          splitter.AddMidiMsg(msg);
+
+        splitter.ProcessBlock(inPtrs.data(), outPtrs.data(), kBlockSize,
+                              [&](float** subIn, float** subOut, int nFrames) { dsp.Process(subIn, subOut, nFrames); },
+                              [&](const IMidiMsg& msg) { dsp.OnMidi(msg); });
+      }, perSample);
+    }
+  }
+
+  // so the work can't be optimized away
+  double sum = 0.;
+
+  for (auto c = 0; c < kNChannels; c++)
+    sum += out[c][kBlockSize - 1];
+
+  printf("(checksum %g)\n", sum);
+
+  return 0;
+}
@@ -0,0 +1,126 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+// Compares the CPU cost per channel of FDNReverb with WDL_ReverbEngine (one engine per stereo pair) for 1 - 16 channels
+// See README.md for build instructions
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "IPlugPlatform.h"
+#include "verbengine.h"
+#include "FDNReverb.h"
+
+using namespace iplug;
+
+static constexpr int kBlockSize = 512;
+static constexpr int kNBlocks = 2000;
+static constexpr double kSampleRate = 48000.;
+
+struct Buffers
+{
+  Buffers(int nChans)
+  : mData(nChans * kBlockSize * 2)
+  {
+    for (auto c = 0; c < nChans; c++)
+    {
+      mInputs.push_back(mData.data() + (c * kBlockSize));
+      mOutputs.push_back(mData.data() + ((nChans + c) * kBlockSize));
+    }
+  }
+
+  void FillNoise(uint32_t& seed)
+  {
+    for (auto ptr : mInputs)
+    {
+      for (auto s = 0; s < kBlockSize; s++)
+      {
+        seed = seed * 1664525 + 1013904223;
+        ptr[s] = ((double) (seed >> 8) / (double) (1 << 24)) - 0.5;
+      }
+    }
+  }
+
+  std::vector<double> mData;
+  std::vector<double*> mInputs;
+  std::vector<double*> mOutputs;
+};
+
+template <typename F>
+static double NsPerSamplePerChannel(int nChans, F&& processBlock)
+{
+  Buffers bufs(nChans);
+  uint32_t seed = 1;
+  bufs.FillNoise(seed);
+
+  double sum = 0.;
+  const auto start = std::chrono::high_resolution_clock::now();
+
+  for (auto b = 0; b < kNBlocks; b++)
+  {
+    processBlock(bufs.mInputs.data(), bufs.mOutputs.data());
+    sum += bufs.mOutputs[0][0];
+  }
+
+  const auto end = std::chrono::high_resolution_clock::now();
+  const double ns = std::chrono::duration<double, std::nano>(end - start).count();
+
+  if (sum == 12345.) // keep the optimiser honest
+    printf(" ");
+
+  return ns / ((double) kNBlocks * kBlockSize * nChans);
+}
+
+int main()
+{
+  printf("%-8s %-22s %-22s %-22s\n", "chans", "WDL_ReverbEngine ns", "FDNReverb (hadamard)", "FDNReverb (householder)");
+
+  for (auto nChans : {1, 2, 4, 6, 8, 12, 16})
+  {
+    const int nPairs = (nChans + 1) / 2;
+    std::vector<WDL_ReverbEngine> wdlEngines(nPairs);
+    for (auto& e : wdlEngines)
+    {
+      e.SetSampleRate(kSampleRate);
+      e.SetRoomSize(0.8);
+      e.SetDampening(0.3);
+      e.Reset(true);
+    }
+
+    const double wdlNs = NsPerSamplePerChannel(nChans, [&](double** inputs, double** outputs) {
+      for (auto p = 0; p < nPairs; p++)
+      {
+        const int l = p * 2;
+        const int r = std::min(l + 1, nChans - 1); // for odd channel counts the last engine processes a duplicated mono channel
+        wdlEngines[p].ProcessSampleBlock(inputs[l], inputs[r], outputs[l], outputs[r], kBlockSize);
+      }
+    });
+
+    FDNReverb<double> fdn(nChans, kSampleRate);
+    fdn.SetDecayTime(2.);
+    fdn.SetDampening(0.3);
+
+    const double fdnHadamardNs = NsPerSamplePerChannel(nChans, [&](double** inputs, double** outputs) {
+      fdn.ProcessBlock(inputs, outputs, kBlockSize);
+    });
+
+    fdn.SetMixMatrix(FDNReverb<double>::EMixMatrix::kHouseholder);
+    fdn.Reset();
+
+    const double fdnHouseholderNs = NsPerSamplePerChannel(nChans, [&](double** inputs, double** outputs) {
+      fdn.ProcessBlock(inputs, outputs, kBlockSize);
+    });
+
+    printf("%-8i %-22.2f %-22.2f %-22.2f\n", nChans, wdlNs, fdnHadamardNs, fdnHouseholderNs);
+  }
+
+  return 0;
+}
@@ -0,0 +1,99 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+// Throughput of the STFT engine for FFT sizes from 256 to 16384, with 4x overlap and a simple spectral gate as the spectrum function.
+// Reports the CPU time per sample per channel and how many times faster than realtime that is at 48kHz, and the worst block time on the audio thread,
+// with the FFTs computed in ProcessBlock() and on the worker thread. The blocks are processed back to back rather than in realtime, so with the worker thread
+// the audio thread often has to wait for it, and the throughput is about the same, the worker pays off in the worst block time when the audio thread has the time between blocks.
+// See README.md for build instructions
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "IPlugPlatform.h"
+#include "STFT.h"
+
+using namespace iplug;
+
+static constexpr int kBlockSize = 128;
+static constexpr int kNChans = 2;
+static constexpr double kSampleRate = 48000.;
+static constexpr double kSecondsOfAudio = 20.;
+
+static void Run(int fftSize, bool workerThread)
+{
+  STFT<double> stft(fftSize, fftSize / 4, kNChans);
+
+  stft.SetSpectrumFunc([](WDL_FFT_COMPLEX** spectra, int nChans, int nBins) {
+    for (auto c = 0; c < nChans; c++)
+    {
+      for (auto k = 0; k < nBins; k++)
+      {
+        WDL_FFT_COMPLEX& bin = spectra[c][k];
+
+        if ((bin.re * bin.re) + (bin.im * bin.im) < 1e-3f)
+          bin.re = bin.im = 0.f;
+      }
+    }
+  });
+
+  stft.SetWorkerThread(workerThread);
+
+  std::vector<std::vector<double>> buffers(kNChans, std::vector<double>(kBlockSize));
+  std::vector<double*> ptrs;
+
+  for (auto& buffer : buffers)
+    ptrs.push_back(buffer.data());
+
+  const int nBlocks = (int) (kSecondsOfAudio * kSampleRate / kBlockSize);
+  double totalTime = 0.;
+  double maxTime = 0.;
+  uint32_t rand = 1;
+
+  for (auto b = 0; b < nBlocks; b++)
+  {
+    for (auto& buffer : buffers)
+    {
+      for (auto& s : buffer)
+      {
+        rand = rand * 1664525 + 1013904223;
+        s = ((rand >> 8) / 16777216.) - 0.5;
+      }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    stft.ProcessBlock(ptrs.data(), ptrs.data(), kBlockSize);
+    const double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    totalTime += time;
+    maxTime = std::max(maxTime, time);
+  }
+
+  const double nsPerSample = (totalTime * 1e9) / ((double) nBlocks * kBlockSize * kNChans);
+  const double realtime = kSecondsOfAudio / totalTime;
+
+  printf("%6i point FFT, %-8s %8.2f ns/sample/channel %8.0fx realtime %8.1f us/block max (latency %i)\n",
+         fftSize, workerThread ? "worker" : "inline", nsPerSample, realtime, maxTime * 1e6, stft.GetLatency());
+}
+
+int main()
+{
+  printf("STFTBenchmark: %i channels, %i frame blocks, 4x overlap\n", kNChans, kBlockSize);
+
+  for (auto fftSize : { 256, 1024, 4096, 16384 })
+  {
+    Run(fftSize, false);
+    Run(fftSize, true);
+  }
+
+  return 0;
+}
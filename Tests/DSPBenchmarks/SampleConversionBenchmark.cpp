@@ -0,0 +1,156 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+// The cost of IPlugProcessor's conversion between a 32 bit host and double precision processing, on a 64 channel bus.
+// A simple gain is processed through IPlugProcessor as an API class drives it, with SetProcessHostPrecision() off (ProcessBlock() on converted buffers)
+// and on (ProcessBlockHostPrecision() on the host's buffers), processing and bypassed, where the host precision inputs have to be converted by ConvertHostInputs().
+// The outputs of each pair are checked to be the same. See README.md for build instructions
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "IPlugPlatform.h"
+#include "IPlugProcessor.h"
+
+using namespace iplug;
+
+static constexpr int kNChannels = 64;
+static constexpr int kBlockSize = 256;
+static constexpr int kNBlocks = 20000;
+
+template <typename T>
+static void Gain(T** inputs, T** outputs, int nFrames)
+{
+  for (auto c = 0; c < kNChannels; c++)
+  {
+    for (auto s = 0; s < nFrames; s++)
+      outputs[c][s] = inputs[c][s] * T(0.5);
+  }
+}
+
+static Config MakeConfig()
+{
+  return Config(0, 0, "64-64", "SampleConversionBenchmark", "", "", 0, 0, 0, 0, false, false, false, false, 0, false, 0, 0, false, 0, 0, 0, 0, "");
+}
+
+class BenchmarkProcessor final : public IPlugProcessor
+{
+public:
+  BenchmarkProcessor(bool processHostPrecision)
+  : IPlugProcessor(MakeConfig(), kAPIVST3)
+  {
+    SetProcessHostPrecision(processHostPrecision);
+    SetSampleRate(48000.);
+    SetBlockSize(kBlockSize);
+    SetChannelConnections(ERoute::kInput, 0, kNChannels, true);
+    SetChannelConnections(ERoute::kOutput, 0, kNChannels, true);
+  }
+
+  void ProcessBlock(sample** inputs, sample** outputs, int nFrames) override { Gain(inputs, outputs, nFrames); }
+  void ProcessBlockHostPrecision(PLUG_SAMPLE_SRC** inputs, PLUG_SAMPLE_SRC** outputs, int nFrames) override { Gain(inputs, outputs, nFrames); }
+  bool SendMidiMsg(const IMidiMsg&) override { return false; }
+
+  /** Process a block of the host's buffers, as the VST3 API class does */
+  void ProcessHostBlock(PLUG_SAMPLE_SRC** inputs, PLUG_SAMPLE_SRC** outputs, int nFrames, bool bypassed)
+  {
+    AttachBuffers(ERoute::kInput, 0, kNChannels, inputs, nFrames);
+    AttachBuffers(ERoute::kOutput, 0, kNChannels, outputs, nFrames);
+
+    if (bypassed)
+      PassThroughBuffers((PLUG_SAMPLE_SRC) 0., nFrames);
+    else
+      ProcessBuffers((PLUG_SAMPLE_SRC) 0., nFrames);
+  }
+};
+
+struct HostBuffers
+{
+  std::vector<std::vector<PLUG_SAMPLE_SRC>> mIn, mOut;
+  std::vector<PLUG_SAMPLE_SRC*> mInPtrs, mOutPtrs;
+
+  HostBuffers()
+  : mIn(kNChannels, std::vector<PLUG_SAMPLE_SRC>(kBlockSize))
+  , mOut(kNChannels, std::vector<PLUG_SAMPLE_SRC>(kBlockSize))
+  {
+    uint32_t rand = 1;
+
+    for (auto c = 0; c < kNChannels; c++)
+    {
+      for (auto& s : mIn[c])
+      {
+        rand = rand * 1664525 + 1013904223;
+        s = ((rand >> 8) / (PLUG_SAMPLE_SRC) 16777216.) - (PLUG_SAMPLE_SRC) 0.5;
+      }
+
+      mInPtrs.push_back(mIn[c].data());
+      mOutPtrs.push_back(mOut[c].data());
+    }
+  }
+};
+
+static double Time(const char* name, BenchmarkProcessor& processor, bool bypassed, HostBuffers& buffers, double baseline)
+{
+  const auto start = std::chrono::steady_clock::now();
+
+  for (auto b = 0; b < kNBlocks; b++)
+    processor.ProcessHostBlock(buffers.mInPtrs.data(), buffers.mOutPtrs.data(), kBlockSize, bypassed);
+
+  const double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  const double ns = (time * 1e9) / ((double) kNBlocks * kBlockSize * kNChannels);
+
+  if (baseline > 0.)
+    printf("%-44s %8.3f ns/sample/channel %8.2fx\n", name, ns, ns / baseline);
+  else
+    printf("%-44s %8.3f ns/sample/channel\n", name, ns);
+
+  return ns;
+}
+
+static bool SameOutputs(const HostBuffers& a, const HostBuffers& b)
+{
+  for (auto c = 0; c < kNChannels; c++)
+  {
+    if (a.mOut[c] != b.mOut[c])
+      return false;
+  }
+
+  return true;
+}
+
+int main()
+{
+  // made first, as they print the parsed channel I/O in debug builds
+  BenchmarkProcessor convertingProcessor(false), hostPrecisionProcessor(true);
+  HostBuffers converted, hostPrecision, bypassedConverted, bypassedHostPrecision;
+  int nFailures = 0;
+
+  printf("SampleConversionBenchmark: %i channels, %i frame blocks, %i bit host buffers\n", kNChannels, kBlockSize, (int) sizeof(PLUG_SAMPLE_SRC) * 8);
+
+  const double processing = Time("ProcessBlock(), converted", convertingProcessor, false, converted, 0.);
+  Time("ProcessBlockHostPrecision()", hostPrecisionProcessor, false, hostPrecision, processing);
+
+  if (!SameOutputs(converted, hostPrecision))
+  {
+    printf("FAILED: ProcessBlockHostPrecision() outputs differ from ProcessBlock()'s\n");
+    nFailures++;
+  }
+
+  const double bypassed = Time("bypassed, converted", convertingProcessor, true, bypassedConverted, 0.);
+  Time("bypassed, host precision (ConvertHostInputs)", hostPrecisionProcessor, true, bypassedHostPrecision, bypassed);
+
+  if (!SameOutputs(bypassedConverted, bypassedHostPrecision) || bypassedHostPrecision.mOut != bypassedHostPrecision.mIn)
+  {
+    printf("FAILED: bypassed outputs differ from the inputs\n");
+    nFailures++;
+  }
+
+  return nFailures ? 1 : 0;
+}
@@ -0,0 +1,202 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+// Stress test for StreamingSampler: lots of voices, constantly retriggered at different pitches, streaming from local .wav files.
+// The audio thread is paced at kSpeed times realtime, so the streaming thread has to keep up with kSpeed times the disk bandwidth a real session would need.
+// Reports the audio thread CPU time per block, the number of voice blocks that ran out of streamed data, and the memory used, for different preload sizes.
+// By default it writes some test files to the current folder (which will probably be in the OS file cache).
+// To stream from real sample libraries pass a list of .wav files instead, preferably bigger than the RAM, or after flushing the file cache.
+// See README.md for build instructions
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "IPlugPlatform.h"
+#include "Sampler.h"
+
+using namespace iplug;
+
+static constexpr int kBlockSize = 256;
+static constexpr double kSampleRate = 48000.;
+static constexpr double kSpeed = 4.;
+static constexpr double kSecondsOfAudio = 8.;
+static constexpr int kNTestFiles = 8;
+static constexpr double kTestFileSeconds = 20.;
+
+static void WriteLE(FILE* pFile, uint32_t value, int nBytes)
+{
+  for (auto b = 0; b < nBytes; b++)
+    fputc((value >> (b * 8)) & 0xFF, pFile);
+}
+
+// 24 bit stereo, a slowly sweeping sine in each channel plus some noise, so the data isn't trivially compressible
+static bool WriteTestFile(const char* path, int seed)
+{
+  FILE* pFile = fopen(path, "wb");
+
+  if (!pFile)
+    return false;
+
+  const uint32_t nFrames = (uint32_t) (kTestFileSeconds * kSampleRate);
+  const uint32_t dataSize = nFrames * 6;
+
+  fwrite("RIFF", 1, 4, pFile); WriteLE(pFile, 36 + dataSize, 4); fwrite("WAVE", 1, 4, pFile);
+  fwrite("fmt ", 1, 4, pFile); WriteLE(pFile, 16, 4);
+  WriteLE(pFile, 1, 2); WriteLE(pFile, 2, 2); WriteLE(pFile, (uint32_t) kSampleRate, 4); WriteLE(pFile, (uint32_t) kSampleRate * 6, 4); WriteLE(pFile, 6, 2); WriteLE(pFile, 24, 2);
+  fwrite("data", 1, 4, pFile); WriteLE(pFile, dataSize, 4);
+
+  uint32_t rand = 12345 + seed;
+  double phase = 0.;
+  std::vector<unsigned char> frames;
+  frames.reserve(nFrames * 6);
+
+  for (uint32_t s = 0; s < nFrames; s++)
+  {
+    phase += (220. + seed * 55. + (s % 48000) * 0.01) / kSampleRate;
+    rand = rand * 1664525 + 1013904223;
+    const double noise = ((rand >> 8) / 16777216.) - 0.5;
+
+    for (auto c = 0; c < 2; c++)
+    {
+      const double value = 0.5 * std::sin(2. * 3.14159265358979 * phase * (c ? 1.01 : 1.)) + 0.05 * noise;
+      const int32_t i = (int32_t) (value * 8388607.);
+      frames.push_back(i & 0xFF);
+      frames.push_back((i >> 8) & 0xFF);
+      frames.push_back((i >> 16) & 0xFF);
+    }
+  }
+
+  const bool ok = fwrite(frames.data(), 1, frames.size(), pFile) == frames.size();
+  fclose(pFile);
+  return ok;
+}
+
+static void Run(const std::vector<std::string>& paths, int nVoices, int preloadFrames)
+{
+  StreamingSampler::Config config;
+  config.mPreloadFrames = preloadFrames;
+
+  StreamingSampler sampler(nVoices, config);
+  sampler.SetSampleRateAndBlockSize(kSampleRate, kBlockSize);
+  sampler.SetEnvelope(1., 50.);
+
+  // spread the files over the keyboard
+  const int nFiles = static_cast<int>(paths.size());
+  const int keysPerFile = 128 / nFiles > 0 ? 128 / nFiles : 1;
+
+  for (auto f = 0; f < nFiles; f++)
+  {
+    const int loKey = f * keysPerFile;
+    const int hiKey = f == nFiles - 1 ? 127 : loKey + keysPerFile - 1;
+
+    if (!sampler.AddSample(paths[f].c_str(), (loKey + hiKey) / 2, loKey, hiKey))
+    {
+      printf("couldn't load %s\n", paths[f].c_str());
+      return;
+    }
+  }
+
+  sampler.SetStreamingActive(true);
+
+  std::vector<sample> left(kBlockSize), right(kBlockSize);
+  sample* outputs[2] = { left.data(), right.data() };
+
+  const int nBlocks = (int) (kSecondsOfAudio * kSampleRate / kBlockSize);
+  const auto blockPeriod = std::chrono::duration<double>(kBlockSize / (kSampleRate * kSpeed));
+  double totalTime = 0.;
+  double maxTime = 0.;
+  uint32_t rand = 1;
+  int note = 0;
+
+  auto deadline = std::chrono::steady_clock::now();
+
+  for (auto b = 0; b < nBlocks; b++)
+  {
+    // one note on (and one note off) per block, so there are always voices being stolen and started
+    rand = rand * 1664525 + 1013904223;
+    const int key = (rand >> 16) % 128;
+    IMidiMsg msg;
+    msg.MakeNoteOnMsg(key, 100, 0);
+    sampler.ProcessMidiMsg(msg);
+
+    if (b >= nVoices / 2)
+    {
+      msg.MakeNoteOffMsg(note, 0);
+      sampler.ProcessMidiMsg(msg);
+    }
+
+    note = key;
+
+    std::fill(left.begin(), left.end(), 0.);
+    std::fill(right.begin(), right.end(), 0.);
+
+    const auto start = std::chrono::steady_clock::now();
+    sampler.ProcessBlock(nullptr, outputs, 0, 2, kBlockSize);
+    const double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    totalTime += time;
+    maxTime = std::max(maxTime, time);
+
+    deadline += std::chrono::duration_cast<std::chrono::steady_clock::duration>(blockPeriod);
+    std::this_thread::sleep_until(deadline);
+  }
+
+  sampler.SetStreamingActive(false);
+
+  printf("%6i voices, %6i preload frames: %8.1f us/block avg %8.1f us/block max %6u underruns (of %i voice blocks) %8.1f MB\n",
+         nVoices, preloadFrames, (totalTime / nBlocks) * 1e6, maxTime * 1e6, sampler.GetNUnderruns(), nBlocks * nVoices, sampler.GetMemoryUsage() / (1024. * 1024.));
+}
+
+int main(int argc, const char* argv[])
+{
+  std::vector<std::string> paths;
+  bool wroteTestFiles = false;
+
+  for (auto a = 1; a < argc; a++)
+    paths.push_back(argv[a]);
+
+  if (paths.empty())
+  {
+    for (auto f = 0; f < kNTestFiles; f++)
+    {
+      paths.push_back("SamplerStreamingBenchmark_" + std::to_string(f) + ".wav");
+
+      if (!WriteTestFile(paths.back().c_str(), f))
+      {
+        printf("couldn't write %s\n", paths.back().c_str());
+        return 1;
+      }
+    }
+
+    wroteTestFiles = true;
+  }
+
+  printf("SamplerStreamingBenchmark: %i files, %i frame blocks at %g Hz, %g x realtime\n", static_cast<int>(paths.size()), kBlockSize, kSampleRate, kSpeed);
+
+  for (auto nVoices : { 32, 128 })
+  {
+    for (auto preloadFrames : { 1024, 8192, 32768 })
+    {
+      Run(paths, nVoices, preloadFrames);
+    }
+  }
+
+  if (wroteTestFiles)
+  {
+    for (const auto& path : paths)
+      remove(path.c_str());
+  }
+
+  return 0;
+}
@@ -0,0 +1,122 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+// Compares MidiSynth (virtual SynthVoice dispatch, voices allocated separately) with TypedMidiSynth (contiguous voices, static dispatch)
+// with lots of small voices and 32 sample control blocks
+// See README.md for build instructions
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "IPlugPlatform.h"
+#include "MidiSynth.h"
+#include "TypedMidiSynth.h"
+#include "Oscillator.h"
+
+using namespace iplug;
+
+static constexpr int kNVoices = 128;
+static constexpr int kBlockSize = 512;
+static constexpr int kNBlocks = 1000;
+static constexpr double kSampleRate = 48000.;
+
+class BenchVoice final : public SynthVoice
+{
+public:
+  bool GetBusy() const override { return mLevel > 0.0001; }
+
+  void Trigger(double level, bool isRetrigger) override
+  {
+    mOSC.Reset();
+    mLevel = level;
+  }
+
+  void ProcessSamplesAccumulating(sample** inputs, sample** outputs, int nInputs, int nOutputs, int startIdx, int nFrames) override
+  {
+    const double freq = 440. * pow(2., mInputs[kVoiceControlPitch].endValue);
+    mOSC.SetFreqCPS(freq);
+
+    for (auto s = startIdx; s < startIdx + nFrames; s++)
+    {
+      outputs[0][s] += mOSC.Process() * mLevel;
+      mLevel *= 0.99999;
+    }
+  }
+
+  void SetSampleRateAndBlockSize(double sampleRate, int blockSize) override
+  {
+    mOSC.SetSampleRate(sampleRate);
+  }
+
+private:
+  FastSinOscillator<sample> mOSC;
+  double mLevel = 0.;
+};
+
+template <class SYNTH>
+static double NsPerBlock(SYNTH& synth)
+{
+  std::vector<sample> output(kBlockSize);
+  sample* outputs[1] = { output.data() };
+
+  synth.SetSampleRateAndBlockSize(kSampleRate, kBlockSize);
+
+  double sum = 0.;
+  const auto start = std::chrono::high_resolution_clock::now();
+
+  for (auto b = 0; b < kNBlocks; b++)
+  {
+    // keep all the voices playing
+    if (b % 100 == 0)
+    {
+      for (auto k = 0; k < kNVoices; k++)
+      {
+        IMidiMsg msg;
+        msg.MakeNoteOnMsg(k % 128, 100, k % kBlockSize);
+        synth.AddMidiMsgToQueue(msg);
+      }
+    }
+
+    memset(output.data(), 0, kBlockSize * sizeof(sample));
+    synth.ProcessBlock(nullptr, outputs, 0, 1, kBlockSize);
+    sum += output[0];
+  }
+
+  const auto end = std::chrono::high_resolution_clock::now();
+
+  if (sum == 12345.) // keep the optimiser honest
+    printf(" ");
+
+  return std::chrono::duration<double, std::nano>(end - start).count() / kNBlocks;
+}
+
+int main()
+{
+  std::vector<std::unique_ptr<BenchVoice>> voices;
+  MidiSynth virtualSynth(VoiceAllocator::kPolyModePoly, MidiSynth::kDefaultBlockSize);
+
+  for (auto v = 0; v < kNVoices; v++)
+  {
+    voices.emplace_back(new BenchVoice());
+    virtualSynth.AddVoice(voices.back().get(), 0);
+  }
+
+  TypedMidiSynth<BenchVoice> typedSynth(kNVoices, VoiceAllocator::kPolyModePoly, MidiSynth::kDefaultBlockSize);
+
+  const double virtualNs = NsPerBlock(virtualSynth);
+  const double typedNs = NsPerBlock(typedSynth);
+
+  printf("%i voices, %i sample blocks, %i sample control blocks\n", kNVoices, kBlockSize, MidiSynth::kDefaultBlockSize);
+  printf("MidiSynth:           %10.0f ns per block\n", virtualNs);
+  printf("TypedMidiSynth:      %10.0f ns per block\n", typedNs);
+
+  return 0;
+}
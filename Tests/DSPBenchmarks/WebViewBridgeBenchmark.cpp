@@ -0,0 +1,301 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+// The main thread cost of sending an idle tick's messages to a web view UI: formatting one script per message (as WebViewEditorDelegate used to),
+// compared with WebViewMsgBatch, which coalesces them into one binary payload. Each tick sends automated parameters, meters that are updated several
+// times per tick and a scope's control message. Then a 2048 bin spectrum per tick, a single message bigger than the batch's script length, whose scripts are
+// decoded as the web view's IPlugBridge() does, checking that every record arrives whole. Also reading the UI's parameter change messages with nlohmann::json compared with WebViewMsgReader.
+// Script evaluation in the web view is not included, it costs far more per call than any of this. See README.md for build instructions
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "IPlugPlatform.h"
+#include "IPlugWebViewBridge.h"
+#include "wdlstring.h"
+#include "json.hpp"
+
+using namespace iplug;
+
+static constexpr int kNTicks = 20000;
+static constexpr int kNMeters = 8;
+static constexpr int kMeterUpdatesPerTick = 4;
+static constexpr int kScopeSize = 256;
+static constexpr int kSpectrumSize = 2048; // 8192 bytes, more than WebViewMsgBatch::kDefaultMaxScriptLength
+
+struct ScriptCounter
+{
+  int64_t mNScripts = 0;
+  int64_t mNChars = 0;
+
+  void operator()(const char* script)
+  {
+    mNScripts++;
+    mNChars += strlen(script);
+  }
+};
+
+static void LegacySendValue(ScriptCounter& counter, const char* func, int tag, double value)
+{
+  WDL_String str;
+  str.SetFormatted(50, "%s(%i, %f)", func, tag, value);
+  counter(str.Get());
+}
+
+static void LegacySendControlMsg(ScriptCounter& counter, int ctrlTag, int msgTag, int dataSize, const void* pData)
+{
+  WDL_String str;
+  WDL_TypedBuf<char> base64;
+  base64.Resize(((dataSize + 2) / 3) * 4 + 1);
+  wdl_base64encode(reinterpret_cast<const unsigned char*>(pData), base64.Get(), dataSize);
+  str.SetFormatted(50 + base64.GetSize(), "SCMFD(%i, %i, %i, %s)", ctrlTag, msgTag, dataSize, base64.Get());
+  counter(str.Get());
+}
+
+/** Decodes scripts like IPlugBridge() in the IPlugWebUI example's script.js, counting the records that don't fit in their payload and the spectra that don't match */
+struct ScriptChecker
+{
+  const std::vector<float>& mSpectrum;
+  std::vector<unsigned char> mPayload;
+  size_t mMaxScriptLength = 0;
+  int mNSpectra = 0;
+  int mNFailures = 0;
+
+  ScriptChecker(const std::vector<float>& spectrum)
+  : mSpectrum(spectrum)
+  {
+  }
+
+  static int32_t GetInt32(const unsigned char* p)
+  {
+    return static_cast<int32_t>(p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24));
+  }
+
+  void operator()(const char* script)
+  {
+    static constexpr char kPrefix[] = "IPlugBridge(\"";
+    const size_t len = strlen(script);
+    mMaxScriptLength = std::max(mMaxScriptLength, len);
+
+    if (strncmp(script, kPrefix, sizeof(kPrefix) - 1) || strcmp(script + len - 3, "\");"))
+    {
+      mNFailures++;
+      return;
+    }
+
+    mPayload.resize(len);
+    const int size = wdl_base64decode(script + sizeof(kPrefix) - 1, mPayload.data(), (int) mPayload.size());
+    const unsigned char* p = mPayload.data();
+
+    if (size < 1 || p[0] != WebViewMsgBatch::kVersion)
+    {
+      mNFailures++;
+      return;
+    }
+
+    for (int pos = 1; pos < size;)
+    {
+      const uint8_t type = p[pos++];
+      const int headerSize = type == kWebViewParamValue ? 12 : type == kWebViewControlValue ? 8 : type == kWebViewControlMsg ? 12 : type == kWebViewArbitraryMsg ? 8 : -1;
+
+      if (headerSize < 0 || pos + headerSize > size)
+      {
+        mNFailures++;
+        return;
+      }
+
+      const int dataSize = type == kWebViewControlMsg ? GetInt32(p + pos + 8) : type == kWebViewArbitraryMsg ? GetInt32(p + pos + 4) : 0;
+
+      if (dataSize < 0 || pos + headerSize + dataSize > size)
+      {
+        mNFailures++;
+        return;
+      }
+
+      if (type == kWebViewArbitraryMsg)
+      {
+        mNSpectra++;
+
+        if (dataSize != (int) (mSpectrum.size() * sizeof(float)) || memcmp(p + pos + headerSize, mSpectrum.data(), dataSize))
+          mNFailures++;
+      }
+
+      pos += headerSize + dataSize;
+    }
+  }
+};
+
+template <typename F>
+static double Time(const char* name, const ScriptCounter& counter, F&& tick, double baseline)
+{
+  const auto start = std::chrono::steady_clock::now();
+
+  for (auto t = 0; t < kNTicks; t++)
+    tick(t);
+
+  const double us = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e6 / kNTicks;
+
+  printf("  %-22s %8.2f us/tick %6.1f scripts/tick %8.0f chars/tick", name, us, (double) counter.mNScripts / kNTicks, (double) counter.mNChars / kNTicks);
+
+  if (baseline > 0.)
+    printf(" %8.2fx\n", baseline / us);
+  else
+    printf("\n");
+
+  return us;
+}
+
+int main()
+{
+  std::vector<float> scope(kScopeSize);
+
+  printf("WebViewBridgeBenchmark: %i meters updated %i times per tick, a %i sample scope, speed up relative to one script per message\n", kNMeters, kMeterUpdatesPerTick, kScopeSize);
+
+  for (auto nParams : { 0, 16, 128 })
+  {
+    printf("%i automated parameters\n", nParams);
+
+    auto update = [&](int t) {
+      for (auto s = 0; s < kScopeSize; s++)
+        scope[s] = std::sin(0.1f * (s + t));
+    };
+
+    ScriptCounter legacy;
+    const double legacyUs = Time("one script per message", legacy, [&](int t) {
+      update(t);
+
+      for (auto p = 0; p < nParams; p++)
+        LegacySendValue(legacy, "SPVFD", p, 0.001 * ((t + p) % 1000));
+
+      for (auto u = 0; u < kMeterUpdatesPerTick; u++)
+        for (auto m = 0; m < kNMeters; m++)
+          LegacySendValue(legacy, "SCVFD", m, 0.01 * ((t + u + m) % 100));
+
+      LegacySendControlMsg(legacy, kNMeters, 0, kScopeSize * sizeof(float), scope.data());
+    }, 0.);
+
+    ScriptCounter batched;
+    WebViewMsgBatch batch(nParams);
+    Time("WebViewMsgBatch", batched, [&](int t) {
+      update(t);
+
+      for (auto p = 0; p < nParams; p++)
+        batch.AddParamValue(p, 0.001 * ((t + p) % 1000));
+
+      for (auto u = 0; u < kMeterUpdatesPerTick; u++)
+        for (auto m = 0; m < kNMeters; m++)
+          batch.AddControlValue(m, 0.01 * ((t + u + m) % 100));
+
+      batch.AddControlMsg(kNMeters, 0, kScopeSize * sizeof(float), scope.data());
+      batch.Flush(batched);
+    }, legacyUs);
+  }
+
+  std::vector<float> spectrum(kSpectrumSize);
+  int nFailures = 0;
+
+  auto updateSpectrum = [&](int t) {
+    for (auto s = 0; s < kSpectrumSize; s++)
+      spectrum[s] = std::fabs(std::sin(0.01f * s * (1 + t % 7)));
+  };
+
+  printf("a %i bin spectrum (%i bytes) and 16 automated parameters per tick\n", kSpectrumSize, (int) (kSpectrumSize * sizeof(float)));
+
+  {
+    ScriptCounter legacy;
+    const double legacyUs = Time("one script per message", legacy, [&](int t) {
+      updateSpectrum(t);
+
+      for (auto p = 0; p < 16; p++)
+        LegacySendValue(legacy, "SPVFD", p, 0.001 * ((t + p) % 1000));
+
+      LegacySendControlMsg(legacy, kNMeters, 1, kSpectrumSize * sizeof(float), spectrum.data());
+    }, 0.);
+
+    ScriptCounter batched;
+    WebViewMsgBatch batch(16);
+    Time("WebViewMsgBatch", batched, [&](int t) {
+      updateSpectrum(t);
+
+      for (auto p = 0; p < 16; p++)
+        batch.AddParamValue(p, 0.001 * ((t + p) % 1000));
+
+      batch.AddArbitraryMsg(1, kSpectrumSize * sizeof(float), spectrum.data());
+      batch.Flush(batched);
+    }, legacyUs);
+
+    // the spectrum is bigger than a script, so it gets one of its own, which must arrive whole
+    ScriptChecker checker(spectrum);
+    static constexpr int kNCheckedTicks = 100;
+
+    for (auto t = 0; t < kNCheckedTicks; t++)
+    {
+      updateSpectrum(t);
+
+      for (auto p = 0; p < 16; p++)
+        batch.AddParamValue(p, 0.001 * p);
+
+      batch.AddArbitraryMsg(1, kSpectrumSize * sizeof(float), spectrum.data());
+      batch.Flush(checker);
+    }
+
+    printf("  %i ticks decoded, longest script %i chars, %i spectra received\n", kNCheckedTicks, (int) checker.mMaxScriptLength, checker.mNSpectra);
+
+    if (checker.mNFailures || checker.mNSpectra != kNCheckedTicks)
+    {
+      printf("FAILED: %i records were cut short or corrupted\n", checker.mNFailures + kNCheckedTicks - checker.mNSpectra);
+      nFailures++;
+    }
+  }
+
+  // messages from the UI, as WKWebView delivers them
+  static constexpr int kNMsgs = 1000000;
+  char json[128];
+  double jsonSum = 0.;
+  double readerSum = 0.;
+
+  printf("reading %i parameter changes from the UI\n", kNMsgs);
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (auto i = 0; i < kNMsgs; i++)
+  {
+    snprintf(json, sizeof(json), "{\n  \"msg\" : \"SPVFUI\",\n  \"paramIdx\" : %i,\n  \"value\" : 0.%i\n}", i & 63, i % 1000);
+    const auto msg = nlohmann::json::parse(json, nullptr, false);
+
+    if (msg["msg"] == "SPVFUI")
+      jsonSum += msg["paramIdx"].get<int>() + msg["value"].get<double>();
+  }
+
+  const double jsonNs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e9 / kNMsgs;
+  printf("  %-22s %8.1f ns/msg (including formatting)\n", "nlohmann::json", jsonNs);
+
+  start = std::chrono::steady_clock::now();
+
+  for (auto i = 0; i < kNMsgs; i++)
+  {
+    snprintf(json, sizeof(json), "{\n  \"msg\" : \"SPVFUI\",\n  \"paramIdx\" : %i,\n  \"value\" : 0.%i\n}", i & 63, i % 1000);
+    const WebViewMsgReader msg(json);
+
+    if (msg.IsMsg("SPVFUI"))
+      readerSum += msg.GetInt("paramIdx") + msg.GetDouble("value");
+  }
+
+  const double readerNs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e9 / kNMsgs;
+  printf("  %-22s %8.1f ns/msg (including formatting) %8.2fx\n", "WebViewMsgReader", readerNs, jsonNs / readerNs);
+
+  // the two readers should agree
+  printf("(checksums %.17g %.17g)\n", jsonSum, readerSum);
+
+  return nFailures ? 1 : 0;
+}
@@ -3,10 +3,17 @@
 
 #include "IControls.h"
 
+#include <chrono>
+#include <cmath>
+#include <string>
+
 IGraphicsStressTest::IGraphicsStressTest(const InstanceInfo& info)
 : Plugin(info, MakeConfig(kNumParams, 1))
 {
   GetParam(0)->InitGain("Dummy");
+
+  for (int i = 0; i < kNumBenchmarkParams; i++)
+    GetParam(kParamBenchmarkFirst + i)->InitDouble(("Benchmark " + std::to_string(i)).c_str(), 0., 0., 1., 0.01);
   
 #if IPLUG_EDITOR
   mMakeGraphicsFunc = [&]() {
@@ -22,6 +29,207 @@ void IGraphicsStressTest::OnParentWindowResize(int width, int height)
     GetUI()->Resize(width, height, 1.f, false);
 }
 
+void IGraphicsStressTest::RunParamFanOutBenchmark()
+{
+  class BenchmarkControl : public IControl
+  {
+  public:
+    BenchmarkControl(int paramIdx)
+    : IControl(IRECT(), paramIdx)
+    {
+      Hide(true);
+    }
+
+    void Draw(IGraphics& g) override {}
+  };
+
+  IGraphics* pGraphics = GetUI();
+  const int firstIdx = pGraphics->NControls();
+
+  for (int i = 0; i < kNumBenchmarkControls; i++)
+    pGraphics->AttachControl(new BenchmarkControl(kParamBenchmarkFirst + (i % kNumBenchmarkParams)));
+
+  const int nRounds = 100;
+  using Clock = std::chrono::high_resolution_clock;
+
+  // what IGEditorDelegate::SendParameterValueFromDelegate() used to do: search every value of every control
+  auto start = Clock::now();
+  for (int r = 0; r < nRounds; r++)
+  {
+    for (int p = kParamBenchmarkFirst; p < kNumParams; p++)
+    {
+      const double value = (double) r / nRounds;
+
+      for (int c = 0; c < pGraphics->NControls(); c++)
+      {
+        IControl* pControl = pGraphics->GetControl(c);
+
+        for (int v = 0; v < pControl->NVals(); v++)
+        {
+          if (pControl->GetParamIdx(v) == p)
+            pControl->SetValueFromDelegate(value, v);
+        }
+      }
+    }
+  }
+  const double searchTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+  // using the parameter to control index
+  start = Clock::now();
+  for (int r = 0; r < nRounds; r++)
+  {
+    for (int p = kParamBenchmarkFirst; p < kNumParams; p++)
+      SendParameterValueFromDelegate(p, (double) r / nRounds, true);
+  }
+  const double indexTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+  pGraphics->RemoveControls(firstIdx);
+
+  const double nUpdates = (double) nRounds * kNumBenchmarkParams;
+  mBenchmarkResult.SetFormatted(256, "%i params, %i controls: search %.2f us/param, index %.2f us/param",
+                                kNumBenchmarkParams, kNumBenchmarkControls, (searchTime / nUpdates) * 1e6, (indexTime / nUpdates) * 1e6);
+  DBGMSG("%s\n", mBenchmarkResult.Get());
+}
+
+#ifdef IGRAPHICS_HEADLESS
+void IGraphicsStressTest::OnUIOpen()
+{
+  RunHeadlessBenchmark();
+}
+
+void IGraphicsStressTest::RunHeadlessBenchmark()
+{
+  IGraphicsHeadless* pGraphics = dynamic_cast<IGraphicsHeadless*>(GetUI());
+
+  if (!pGraphics)
+    return;
+
+  static const char* testNames[] = {"Start", "DrawRect", "FillRect", "DrawRoundRect", "FillRoundRect", "DrawEllipse", "FillEllipse", "DrawArc", "FillArc", "DrawLine", "DrawDottedLine", "DrawFittedBitmap", "DrawSVG"};
+  const int nFrames = 120;
+
+  printf("IGraphicsStressTest: %s, %i x %i, %i things, %i frames per test\n", pGraphics->GetDrawingAPIStr(), pGraphics->Width(), pGraphics->Height(), mNumberOfThings, nFrames);
+
+  for (int test = 1; test < kTestParamFanOut; test++)
+  {
+    mKindOfThing = test;
+
+    // redraw everything every frame, so each frame draws mNumberOfThings new things
+    pGraphics->ClearScript();
+    for (int frame = 0; frame < nFrames; frame++)
+    {
+      IHeadlessEvent event;
+      event.mFrame = frame;
+      event.mType = IHeadlessEvent::EType::SetAllDirty;
+      pGraphics->AddEvent(event);
+    }
+
+    WDL_String path;
+#ifdef IGRAPHICS_HEADLESS_SNAPSHOTS
+    path.SetFormatted(256, "IGraphicsStressTest_%s_", testNames[test]);
+    pGraphics->Run(nFrames, path.Get(), nFrames);
+#else
+    pGraphics->Run(nFrames);
+#endif
+
+    int nDrawnFrames;
+    double meanMs, p95Ms, maxMs;
+    pGraphics->GetFrameTimingSummary(nDrawnFrames, meanMs, p95Ms, maxMs);
+    printf("%-20s %8.3f ms mean %8.3f ms p95 %8.3f ms max (%i frames)\n", testNames[test], meanMs, p95Ms, maxMs, nDrawnFrames);
+
+    path.SetFormatted(256, "IGraphicsStressTest_%s.csv", testNames[test]);
+    pGraphics->WriteFrameTimingsCSV(path.Get());
+  }
+
+#ifdef IGRAPHICS_AGG
+  // how the AGG tile rasterizer scales with the number of threads, on FillEllipse and DrawSVG (the script still sets everything dirty every frame)
+  for (auto test : {6, 12})
+  {
+    mKindOfThing = test;
+
+    for (auto nThreads : {1, 2, 4, 8})
+    {
+      pGraphics->SetTileRendering(nThreads);
+      pGraphics->Run(nFrames);
+
+      int nDrawnFrames;
+      double meanMs, p95Ms, maxMs;
+      pGraphics->GetFrameTimingSummary(nDrawnFrames, meanMs, p95Ms, maxMs);
+      const IGraphicsAGG::TileStats stats = pGraphics->GetTileStats();
+      printf("%-20s %i threads: %8.3f ms mean %8.3f ms p95 (last frame: %i bands, %i commands, %i flushes, %.3f ms rasterizing)\n",
+             testNames[test], nThreads, meanMs, p95Ms, stats.mNBands, stats.mNCommands, stats.mNFlushes, stats.mRasterizeMs);
+    }
+  }
+
+  pGraphics->SetTileRendering(1);
+#endif
+
+  RunParamFanOutBenchmark();
+  printf("%s\n", mBenchmarkResult.Get());
+
+  pGraphics->ClearScript();
+  mKindOfThing = 0;
+  RunDamageRegionBenchmark();
+  pGraphics->SetAllControlsDirty();
+}
+
+void IGraphicsStressTest::RunDamageRegionBenchmark()
+{
+  IGraphicsHeadless* pGraphics = dynamic_cast<IGraphicsHeadless*>(GetUI());
+
+  if (!pGraphics)
+    return;
+
+  const int firstIdx = pGraphics->NControls();
+  const IRECT bounds = pGraphics->GetBounds().GetReducedFromBottom(50.f);
+  auto* pSliders = new IVMultiSliderControl<kNumBenchmarkSliders>(bounds.FracRectVertical(0.5f, true), "");
+  const int minNote = 24;
+  const int maxNote = 108;
+  auto* pKeyboard = new IVKeyboardControl(bounds.FracRectVertical(0.5f, false), minNote, maxNote);
+  pGraphics->AttachControl(pSliders);
+  pGraphics->AttachControl(pKeyboard);
+  pGraphics->SetAllControlsDirty();
+  pGraphics->RenderFrame();
+
+  const int nFrames = 200;
+
+  // the mean time to draw a frame, after changing one slider or key with func(frame)
+  auto timeFrames = [&](auto&& func) {
+    double totalMs = 0.;
+    float totalArea = 0.f;
+
+    for (int frame = 0; frame < nFrames; frame++)
+    {
+      func(frame);
+      const IHeadlessFrameTiming timing = pGraphics->RenderFrame();
+      totalMs += timing.mDrawMs;
+      totalArea += timing.mDirtyArea;
+    }
+
+    printf("%8.3f ms mean, %5.1f%% of the UI redrawn\n", totalMs / nFrames, 100.f * totalArea / nFrames);
+  };
+
+  auto setSlider = [&](int frame) {
+    const int idx = (frame * 7) % kNumBenchmarkSliders;
+    pSliders->SetValue(0.5 + 0.5 * std::sin(frame * 0.1), idx);
+    return idx;
+  };
+
+  const int nKeys = maxNote - minNote + 1;
+
+  printf("IVMultiSliderControl, %i sliders, whole control dirty:  ", kNumBenchmarkSliders);
+  timeFrames([&](int frame) { setSlider(frame); pSliders->SetDirty(false); });
+  printf("IVMultiSliderControl, %i sliders, changed slider dirty: ", kNumBenchmarkSliders);
+  timeFrames([&](int frame) { const int idx = setSlider(frame); pSliders->SetTracksDirty(idx, idx); });
+
+  printf("IVKeyboardControl, %i keys, whole control dirty:         ", nKeys);
+  timeFrames([&](int frame) { pKeyboard->SetKeyIsPressed((frame * 5) % nKeys, frame & 1); pKeyboard->SetDirty(false); });
+  printf("IVKeyboardControl, %i keys, changed key dirty:           ", nKeys);
+  timeFrames([&](int frame) { pKeyboard->SetKeyIsPressed((frame * 5) % nKeys, frame & 1); });
+
+  pGraphics->RemoveControls(firstIdx);
+}
+#endif
+
 void IGraphicsStressTest::LayoutUI(IGraphics* pGraphics)
 {
   IRECT bounds = pGraphics->GetBounds();
@@ -54,7 +262,10 @@ void IGraphicsStressTest::LayoutUI(IGraphics* pGraphics)
     }
     
     dynamic_cast<ITextControl*>(GetUI()->GetControlWithTag(kCtrlTagNumThings))->SetStrFmt(64, "Number of things = %i", mNumberOfThings);
-    dynamic_cast<ITextControl*>(GetUI()->GetControlWithTag(kCtrlTagTestNum))->SetStrFmt(64, "Test %i/%i", this->mKindOfThing, 32);
+    dynamic_cast<ITextControl*>(GetUI()->GetControlWithTag(kCtrlTagTestNum))->SetStrFmt(64, "Test %i/%i", this->mKindOfThing, kNumTests - 1);
+    if (this->mKindOfThing == kTestParamFanOut)
+      RunParamFanOutBenchmark();
+
     GetUI()->SetAllControlsDirty();
   };
   
@@ -82,6 +293,8 @@ void IGraphicsStressTest::LayoutUI(IGraphics* pGraphics)
     
     if(this->mKindOfThing == 0)
       g.DrawText(IText(40), "Press tab to go to next test, up/down to change the # of things", r);
+    else if(this->mKindOfThing == kTestParamFanOut)
+      g.DrawText(IText(30), mBenchmarkResult.Get(), r);
     else
     //      if (!g.CheckLayer(pCaller->mLayer))
     {
@@ -136,7 +349,7 @@ void IGraphicsStressTest::LayoutUI(IGraphics* pGraphics)
       switch (button){
         case 0:
         {
-          static IPopupMenu menu {"Test", {"Start", "DrawRect", "FillRect", "DrawRoundRect", "FillRoundRect", "DrawEllipse", "FillEllipse", "DrawArc", "FillArc", "DrawLine", "DrawDottedLine", "DrawFittedBitmap", "DrawSVG"},
+          static IPopupMenu menu {"Test", {"Start", "DrawRect", "FillRect", "DrawRoundRect", "FillRoundRect", "DrawEllipse", "FillEllipse", "DrawArc", "FillArc", "DrawLine", "DrawDottedLine", "DrawFittedBitmap", "DrawSVG", "ParamFanOut"},
             [DoFunc](IPopupMenu* pMenu) {
               DoFunc(EFunc::Set, pMenu->GetChosenItemIdx());
             }};
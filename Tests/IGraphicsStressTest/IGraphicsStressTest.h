@@ -2,10 +2,21 @@
 
 #include "IPlug_include_in_plug_hdr.h"
 
+const int kNumBenchmarkParams = 200;
+const int kNumBenchmarkControls = 1500;
+const int kNumBenchmarkSliders = 128;
+
 enum EParam
 {
   kParamDummy = 0,
-  kNumParams
+  kParamBenchmarkFirst,
+  kNumParams = kParamBenchmarkFirst + kNumBenchmarkParams
+};
+
+enum ETest
+{
+  kTestParamFanOut = 13,
+  kNumTests
 };
 
 enum EControlTags
@@ -30,8 +41,19 @@ public:
 #if IPLUG_EDITOR
   void LayoutUI(IGraphics* pGraphics) override;
   void OnParentWindowResize(int width, int height) override;
+  /** Attach kNumBenchmarkControls controls linked to kNumBenchmarkParams parameters, and time sending parameter values to them
+   * as IGEditorDelegate does when a host plays back automation, compared with a search of all the controls */
+  void RunParamFanOutBenchmark();
+#ifdef IGRAPHICS_HEADLESS
+  void OnUIOpen() override;
+  /** Draw every test for a number of frames with IGraphicsHeadless, printing the frame timings and writing them to a .csv file per test */
+  void RunHeadlessBenchmark();
+  /** Time redrawing a large IVMultiSliderControl and IVKeyboardControl when one slider or key changes, marking the whole control dirty compared with only the changed slider or key */
+  void RunDamageRegionBenchmark();
+#endif
 public:
   int mNumberOfThings = 16;
   int mKindOfThing = 0;
+  WDL_String mBenchmarkResult;
 #endif
 };
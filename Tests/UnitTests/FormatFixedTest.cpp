@@ -0,0 +1,80 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+// Checks FormatFixed(), which IParam::GetDisplay() uses to format parameter values, against the rounding of the "%d", round(v) formatting it replaced:
+// half way values round away from zero and "-0" is never displayed. See README.md for build instructions
+
+#include <cstdio>
+#include <cstring>
+
+#include "IPlugPlatform.h"
+#include "IPlugUtilities.h"
+
+using namespace iplug;
+
+static int sNFailures = 0;
+
+static void Check(double value, int precision, const char* expected, bool forceSign = false)
+{
+  char buf[32];
+  FormatFixed(buf, sizeof(buf), value, precision, forceSign);
+
+  if (strcmp(buf, expected))
+  {
+    printf("FAILED: FormatFixed(%.17g, %i%s) gave \"%s\", expected \"%s\"\n", value, precision, forceSign ? ", forceSign" : "", buf, expected);
+    sNFailures++;
+  }
+}
+
+int main()
+{
+  // ties at precision 0, as round() gave
+  Check(0.5, 0, "1");
+  Check(-0.5, 0, "-1");
+  Check(2.5, 0, "3");
+  Check(-2.5, 0, "-3");
+  Check(1.4999, 0, "1");
+  Check(-1.5001, 0, "-2");
+
+  // decimal ties that aren't exact in binary
+  Check(0.05, 1, "0.1");
+  Check(-0.05, 1, "-0.1");
+  Check(0.15, 1, "0.2");
+  Check(1.005, 2, "1.01");
+  Check(0.125, 2, "0.13");
+
+  // never "-0"
+  Check(-0.4, 0, "0");
+  Check(-0.04, 1, "0.0");
+  Check(-0., 2, "0.00");
+  Check(-1e-13, 12, "0.000000000000");
+  Check(-5e-21, 20, "0.00000000000000000000");
+
+  // ties beyond 9 decimal places
+  Check(5e-12, 11, "0.00000000001");
+  Check(-2.5e-16, 16, "-0.0000000000000003");
+
+  // everything else as printf
+  Check(0., 0, "0");
+  Check(123.456, 2, "123.46");
+  Check(-123.456, 1, "-123.5");
+  Check(1.5, 1, "1.5");
+  Check(3., 1, "+3.0", true);
+  Check(-3., 1, "-3.0", true);
+  Check(1e20, 2, "100000000000000000000.00");
+  Check(20000., 0, "20000");
+
+  if (sNFailures)
+    printf("FormatFixedTest: %i failures\n", sNFailures);
+  else
+    printf("FormatFixedTest: passed\n");
+
+  return sNFailures ? 1 : 0;
+}